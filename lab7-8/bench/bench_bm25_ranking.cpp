@@ -0,0 +1,131 @@
+#include "../include/ranking.h"
+#include "../include/query_planner.h"
+#include "../include/simd_kernels.h"
+#include "../include/tokenizer.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+#define QUERY_COUNT 200
+#define TOP_K 10
+
+static int check_score_kernels(int rounds) {
+    int failures = 0;
+    const SimdKernels* reference = get_simd_kernels_for_level(SIMD_LEVEL_SCALAR);
+    float tf[SCORE_BLOCK], norms[SCORE_BLOCK], expected[SCORE_BLOCK], actual[SCORE_BLOCK];
+    
+    for (int level = SIMD_LEVEL_SSE42; get_simd_kernels_for_level(level); level++) {
+        const SimdKernels* kernels = get_simd_kernels_for_level(level);
+        for (int r = 0; r < rounds; r++) {
+            int count = rand() % (SCORE_BLOCK + 1);
+            for (int i = 0; i < count; i++) {
+                tf[i] = (float)(rand() % 4);
+                norms[i] = 0.3f + (float)(rand() % 1000) / 500.0f;
+                expected[i] = actual[i] = (float)(rand() % 10);
+            }
+            
+            reference->score(tf, norms, count, 2.5f, expected);
+            kernels->score(tf, norms, count, 2.5f, actual);
+            for (int i = 0; i < count; i++) {
+                if (fabsf(expected[i] - actual[i]) > 1e-4f) {
+                    failures++;
+                    break;
+                }
+            }
+        }
+        printf("Score kernel %-8s %d random blocks: %s\n", kernels->name, rounds, failures ? "FAILED" : "ok");
+    }
+    
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    int doc_count = argc > 1 ? atoi(argv[1]) : 40000;
+    
+    srand(29);
+    int failures = check_score_kernels(500);
+    
+    init_vocabulary(false);
+    
+    BooleanIndex index;
+    init_index(&index, 1024);
+    for (int d = 1; d <= doc_count; d++) {
+        TokenArray tokens = make_document(80, 240);
+        add_document_to_index(&index, &tokens, d);
+        add_document_info(&index, d, "", "", tokens.count);
+        free_tokens(&tokens);
+    }
+    finalize_index(&index);
+    
+    printf("BM25 top-%d over %d synthetic docs, %d two-term OR queries\n", TOP_K, doc_count, QUERY_COUNT);
+    
+    double score_us = 0.0, heap_us = 0.0, sort_us = 0.0;
+    long results = 0;
+    BooleanIndex* indexes[1] = {&index};
+    char query[64];
+    
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        snprintf(query, sizeof(query), "%s OR %s", vocabulary[rand() % 100], vocabulary[rand() % 400]);
+        QueryNode* tree = parse_query(query);
+        int count = 0;
+        int* docs = evaluate_query(&index, tree, &count);
+        float* scores = (float*)malloc((count + 1) * sizeof(float));
+        
+        RankingStats stats;
+        init_ranking_stats(&stats, tree, indexes, 1);
+        auto start = std::chrono::steady_clock::now();
+        score_documents(&index, &stats, docs, count, scores);
+        score_us += elapsed_us(start);
+        
+        start = std::chrono::steady_clock::now();
+        TopKHeap heap;
+        init_top_k(&heap, TOP_K);
+        for (int i = 0; i < count; i++) {
+            offer_top_k(&heap, docs[i], scores[i]);
+        }
+        int top_count = 0;
+        ScoredDocument* top = finish_top_k(&heap, &top_count);
+        heap_us += elapsed_us(start);
+        
+        start = std::chrono::steady_clock::now();
+        ScoredDocument* all = (ScoredDocument*)malloc((count + 1) * sizeof(ScoredDocument));
+        for (int i = 0; i < count; i++) {
+            all[i].doc_id = docs[i];
+            all[i].score = scores[i];
+        }
+        std::sort(all, all + count, [](const ScoredDocument& a, const ScoredDocument& b) {
+            return a.score != b.score ? a.score > b.score : a.doc_id < b.doc_id;
+        });
+        sort_us += elapsed_us(start);
+        
+        for (int i = 0; i < top_count; i++) {
+            if (top[i].doc_id != all[i].doc_id) {
+                failures++;
+                break;
+            }
+        }
+        
+        results += count;
+        free(all);
+        free(top);
+        free(scores);
+        free(docs);
+        free_ranking_stats(&stats);
+        free_query(tree);
+    }
+    
+    printf("%-28s %12.1f\n", "matches per query", (double)results / QUERY_COUNT);
+    printf("%-28s %12.1f us (%.1f ns/doc, %s)\n", "block scoring", score_us / QUERY_COUNT,
+           score_us * 1000.0 / (results ? results : 1), get_simd_kernels()->name);
+    printf("%-28s %12.1f us\n", "bounded top-k heap", heap_us / QUERY_COUNT);
+    printf("%-28s %12.1f us\n", "full sort", sort_us / QUERY_COUNT);
+    
+    if (failures) printf("MISMATCH: %d checks failed\n", failures);
+    
+    clear_index(&index);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,81 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include "../include/tokenizer.h"
+#include "../include/utils.h"
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#define VOCABULARY_SIZE 3000
+
+static char vocabulary[VOCABULARY_SIZE][16] __attribute__((unused));
+
+static inline double elapsed_s(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static inline double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static inline double elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+static inline void init_vocabulary(bool unique) {
+    for (int w = 0; w < VOCABULARY_SIZE; w++) {
+        int length = 2 + rand() % 6;
+        for (int c = 0; c < length; c++) {
+            vocabulary[w][c] = 'a' + rand() % 26;
+        }
+        vocabulary[w][length] = '\0';
+        
+        for (int other = 0; unique && other < w; other++) {
+            if (strcmp(vocabulary[other], vocabulary[w]) == 0) {
+                w--;
+                break;
+            }
+        }
+    }
+}
+
+static inline int pick_word() {
+    double r = (double)rand() / RAND_MAX;
+    return (int)(r * r * r * (VOCABULARY_SIZE - 1));
+}
+
+static inline TokenArray make_document(int min_length, int length_range) {
+    TokenArray tokens;
+    tokens.count = min_length + rand() % length_range;
+    tokens.tokens = (char**)malloc(tokens.count * sizeof(char*));
+    for (int t = 0; t < tokens.count; t++) {
+        tokens.tokens[t] = strdup(vocabulary[pick_word()]);
+    }
+    return tokens;
+}
+
+static inline TokenArray make_lyrics(int** word_ids) {
+    TokenArray tokens;
+    int chorus[8];
+    for (int w = 0; w < 8; w++) {
+        chorus[w] = pick_word();
+    }
+    
+    int lines = 10 + rand() % 30;
+    tokens.tokens = (char**)malloc(lines * 8 * sizeof(char*));
+    tokens.count = 0;
+    if (word_ids) *word_ids = (int*)malloc(lines * 8 * sizeof(int));
+    
+    for (int l = 0; l < lines; l++) {
+        for (int w = 0; w < 8; w++) {
+            int word = l % 4 == 3 ? chorus[w] : pick_word();
+            if (word_ids) (*word_ids)[tokens.count] = word;
+            tokens.tokens[tokens.count++] = strdup(vocabulary[word]);
+        }
+    }
+    
+    return tokens;
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include "../include/boolean_index.h"
+#include "../include/tokenizer.h"
+#include "../include/utils.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+static TokenArray* make_corpus(int doc_count, int doc_length, int vocabulary) {
+    double* cdf = (double*)malloc(vocabulary * sizeof(double));
+    double total = 0.0;
+    for (int i = 0; i < vocabulary; i++) {
+        total += 1.0 / (i + 1);
+        cdf[i] = total;
+    }
+    
+    srand(42);
+    TokenArray* docs = (TokenArray*)malloc(doc_count * sizeof(TokenArray));
+    char term[32];
+    
+    for (int d = 0; d < doc_count; d++) {
+        docs[d].count = doc_length;
+        docs[d].tokens = (char**)malloc(doc_length * sizeof(char*));
+        
+        for (int t = 0; t < doc_length; t++) {
+            double r = (double)rand() / RAND_MAX * total;
+            int lo = 0, hi = vocabulary - 1;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (cdf[mid] < r) lo = mid + 1; else hi = mid;
+            }
+            snprintf(term, sizeof(term), "w%d", lo);
+            docs[d].tokens[t] = strdup(term);
+        }
+    }
+    
+    free(cdf);
+    return docs;
+}
+
+int main(int argc, char* argv[]) {
+    int doc_count = argc > 1 ? atoi(argv[1]) : 15000;
+    int doc_length = argc > 2 ? atoi(argv[2]) : 250;
+    int vocabulary = 50000;
+    
+    TokenArray* docs = make_corpus(doc_count, doc_length, vocabulary);
+    printf("Synthetic Zipf corpus: %d docs x %d tokens, vocabulary %d\n", doc_count, doc_length, vocabulary);
+    
+    BooleanIndex per_token;
+    init_index(&per_token, 100);
+    auto start = std::chrono::steady_clock::now();
+    for (int d = 0; d < doc_count; d++) {
+        for (int t = 0; t < docs[d].count; t++) {
+            add_to_index(&per_token, docs[d].tokens[t], d + 1, t);
+        }
+    }
+    double per_token_ms = elapsed_ms(start);
+    
+    BooleanIndex per_document;
+    init_index(&per_document, 100);
+    start = std::chrono::steady_clock::now();
+    for (int d = 0; d < doc_count; d++) {
+        add_document_to_index(&per_document, &docs[d], d + 1);
+    }
+    double per_document_ms = elapsed_ms(start);
+    
+    printf("add_to_index:          %10.2f ms (%d terms)\n", per_token_ms, per_token.count);
+    printf("add_document_to_index: %10.2f ms (%d terms)\n", per_document_ms, per_document.count);
+    printf("Speedup: %.2fx\n", per_token_ms / per_document_ms);
+    
+    clear_index(&per_token);
+    clear_index(&per_document);
+    for (int d = 0; d < doc_count; d++) {
+        free_tokens(&docs[d]);
+    }
+    free(docs);
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "../include/document_store.h"
+#include "../include/document_parser.h"
+#include "../include/utils.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+#define PAGE_SIZE 10
+
+static char* make_lyrics(int doc) {
+    static const char* words[] = {
+        "love", "baby", "night", "heart", "dance", "fire", "rain", "road", "home", "dream",
+        "light", "tonight", "forever", "again", "never", "sky", "blue", "world", "time", "feel"
+    };
+    
+    size_t capacity = 4096;
+    char* text = (char*)malloc(capacity);
+    size_t length = snprintf(text, capacity, "Song %d ", doc);
+    
+    
+    char chorus[256];
+    size_t chorus_length = 0;
+    for (int w = 0; w < 8; w++) {
+        chorus_length += snprintf(chorus + chorus_length, sizeof(chorus) - chorus_length, "%s ", words[rand() % 20]);
+    }
+    
+    int lines = 10 + rand() % 30;
+    for (int l = 0; l < lines; l++) {
+        if (length + 512 > capacity) {
+            capacity *= 2;
+            text = (char*)realloc(text, capacity);
+        }
+        
+        if (l % 4 == 3) {
+            memcpy(text + length, chorus, chorus_length);
+            length += chorus_length;
+            continue;
+        }
+        for (int w = 0; w < 6; w++) {
+            length += snprintf(text + length, capacity - length, "%s ", words[rand() % 20]);
+        }
+    }
+    
+    text[length] = '\0';
+    return text;
+}
+
+int main(int argc, char* argv[]) {
+    int doc_count = 20000;
+    char** files = nullptr;
+    
+    if (argc > 1) {
+        files = list_html_files(argv[1], &doc_count);
+        if (doc_count == 0) {
+            printf("No HTML documents found in directory: %s\n", argv[1]);
+            return 1;
+        }
+    }
+    
+    srand(5);
+    char** texts = (char**)malloc(doc_count * sizeof(char*));
+    size_t raw_bytes = 0;
+    for (int i = 0; i < doc_count; i++) {
+        if (files) {
+            Document doc = parse_html_document(files[i], i + 1);
+            texts[i] = doc.content;
+            free(doc.title);
+            free(doc.original_html);
+            free(doc.filepath);
+        } else {
+            texts[i] = make_lyrics(i + 1);
+        }
+        raw_bytes += strlen(texts[i]);
+    }
+    
+    
+    const char* store_file = "bench_document_store.docs";
+    DocumentStoreWriter writer;
+    if (open_document_store_writer(&writer, store_file) != 0) return 1;
+    for (int i = 0; i < doc_count; i++) {
+        add_stored_document(&writer, i + 1, texts[i]);
+    }
+    if (close_document_store_writer(&writer) != 0) return 1;
+    
+    DocumentStore* store = open_document_store(store_file);
+    if (!store) return 1;
+    
+    printf("%s: %d docs, %.1f MB text -> %.1f MB in %d blocks (%.2fx)\n",
+           files ? argv[1] : "synthetic lyrics", doc_count, raw_bytes / 1e6, store->size / 1e6,
+           store->block_count, (double)raw_bytes / store->size);
+    
+    
+    int mismatches = 0;
+    for (int i = 0; i < doc_count; i++) {
+        char* text = fetch_document_text(store, i + 1);
+        if (!text || strcmp(text, texts[i]) != 0) mismatches++;
+        free(text);
+    }
+    
+    
+    const int pages = 2000;
+    int page[PAGE_SIZE];
+    double store_us = 0.0;
+    long blocks_before = store->blocks_decompressed;
+    
+    for (int p = 0; p < pages; p++) {
+        for (int k = 0; k < PAGE_SIZE; k++) {
+            page[k] = 1 + rand() % doc_count;
+        }
+        std::sort(page, page + PAGE_SIZE);
+        store->cached_block = -1;
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < PAGE_SIZE; k++) {
+            free(fetch_document_text(store, page[k]));
+        }
+        store_us += elapsed_us(start);
+    }
+    
+    printf("  store fetch:   %8.1f us per %d results, %.1f blocks decompressed%s\n",
+           store_us / pages, PAGE_SIZE, (double)(store->blocks_decompressed - blocks_before) / pages,
+           mismatches ? "  MISMATCH" : "");
+    
+    
+    if (files) {
+        double parse_us = 0.0;
+        int parse_pages = pages / 10;
+        for (int p = 0; p < parse_pages; p++) {
+            auto start = std::chrono::steady_clock::now();
+            for (int k = 0; k < PAGE_SIZE; k++) {
+                int id = 1 + rand() % doc_count;
+                Document doc = parse_html_document(files[id - 1], id);
+                free(doc.title);
+                free(doc.content);
+                free(doc.original_html);
+                free(doc.filepath);
+            }
+            parse_us += elapsed_us(start);
+        }
+        printf("  html re-parse: %8.1f us per %d results\n", parse_us / parse_pages, PAGE_SIZE);
+    }
+    
+    close_document_store(store);
+    remove(store_file);
+    free_string_array(texts, doc_count);
+    free_string_array(files, doc_count);
+    return mismatches ? 1 : 0;
+}
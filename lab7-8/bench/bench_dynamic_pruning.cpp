@@ -0,0 +1,130 @@
+#include "../include/ranking.h"
+#include "../include/query_planner.h"
+#include "../include/tokenizer.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+#define COMMON_WORDS 60
+#define QUERIES_PER_LENGTH 200
+#define TOP_K 10
+
+static double percentile(double* values, int count, double p) {
+    std::sort(values, values + count);
+    int i = (int)(p * (count - 1) + 0.5);
+    return values[i];
+}
+
+static ScoredDocument* rank_exhaustive(BooleanIndex* index, QueryNode* tree, const RankingStats* stats, int* count) {
+    TopKHeap heap;
+    init_top_k(&heap, TOP_K);
+    
+    int match_count = 0;
+    int* docs = evaluate_query(index, tree, &match_count);
+    float* scores = (float*)malloc((match_count + 1) * sizeof(float));
+    score_documents(index, stats, docs, match_count, scores);
+    for (int i = 0; i < match_count; i++) {
+        offer_top_k(&heap, docs[i], scores[i]);
+    }
+    
+    free(scores);
+    free(docs);
+    return finish_top_k(&heap, count);
+}
+
+int main(int argc, char* argv[]) {
+    int doc_count = argc > 1 ? atoi(argv[1]) : 40000;
+    
+    srand(31);
+    init_vocabulary(false);
+    
+    BooleanIndex index;
+    init_index(&index, 1024);
+    for (int d = 1; d <= doc_count; d++) {
+        TokenArray tokens = make_document(40, 400);
+        add_document_to_index(&index, &tokens, d);
+        add_document_info(&index, d, "", "", tokens.count);
+        free_tokens(&tokens);
+    }
+    finalize_index(&index);
+    
+    printf("Top-%d OR queries of common terms over %d synthetic docs, %d queries per length\n", 
+           TOP_K, doc_count, QUERIES_PER_LENGTH);
+    printf("%-6s %10s %10s %10s %11s %11s %10s %10s %8s\n", "terms", "matches", "full p50", "full p99", 
+           "pruned p50", "pruned p99", "gated p50", "gated p99", "scored");
+    
+    double full_us[QUERIES_PER_LENGTH];
+    double pruned_us[QUERIES_PER_LENGTH];
+    double gated_us[QUERIES_PER_LENGTH];
+    BooleanIndex* indexes[1] = {&index};
+    int mismatches = 0;
+    char query[512];
+    
+    for (int length = 2; length <= 8; length++) {
+        long matches = 0;
+        long scored = 0;
+        
+        for (int q = 0; q < QUERIES_PER_LENGTH; q++) {
+            size_t used = 0;
+            for (int w = 0; w < length; w++) {
+                used += snprintf(query + used, sizeof(query) - used, "%s%s", w ? " OR " : "", vocabulary[rand() % COMMON_WORDS]);
+            }
+            QueryNode* tree = parse_query(query);
+            RankingStats stats;
+            init_ranking_stats(&stats, tree, indexes, 1);
+            
+            auto start = std::chrono::steady_clock::now();
+            int full_count = 0;
+            ScoredDocument* full = rank_exhaustive(&index, tree, &stats, &full_count);
+            full_us[q] = elapsed_us(start);
+            
+            start = std::chrono::steady_clock::now();
+            TopKHeap heap;
+            init_top_k(&heap, TOP_K);
+            scored += rank_term_disjunction(&index, &stats, nullptr, 0, &heap);
+            int pruned_count = 0;
+            ScoredDocument* pruned = finish_top_k(&heap, &pruned_count);
+            pruned_us[q] = elapsed_us(start);
+            
+            start = std::chrono::steady_clock::now();
+            if (prefers_pruning(&index, &stats, TOP_K)) {
+                init_top_k(&heap, TOP_K);
+                rank_term_disjunction(&index, &stats, nullptr, 0, &heap);
+                free_top_k(&heap);
+            } else {
+                int gated_count = 0;
+                free(rank_exhaustive(&index, tree, &stats, &gated_count));
+            }
+            gated_us[q] = elapsed_us(start);
+            
+            bool same = full_count == pruned_count;
+            for (int i = 0; same && i < full_count; i++) {
+                same = full[i].doc_id == pruned[i].doc_id && full[i].score == pruned[i].score;
+            }
+            if (!same) mismatches++;
+            
+            int match_count = 0;
+            free(evaluate_query(&index, tree, &match_count));
+            matches += match_count;
+            
+            free(full);
+            free(pruned);
+            free_ranking_stats(&stats);
+            free_query(tree);
+        }
+        
+        printf("%-6d %10.1f %10.1f %10.1f %11.1f %11.1f %10.1f %10.1f %7.1f%%\n", length, (double)matches / QUERIES_PER_LENGTH,
+               percentile(full_us, QUERIES_PER_LENGTH, 0.5), percentile(full_us, QUERIES_PER_LENGTH, 0.99),
+               percentile(pruned_us, QUERIES_PER_LENGTH, 0.5), percentile(pruned_us, QUERIES_PER_LENGTH, 0.99),
+               percentile(gated_us, QUERIES_PER_LENGTH, 0.5), percentile(gated_us, QUERIES_PER_LENGTH, 0.99),
+               matches ? 100.0 * scored / matches : 0.0);
+    }
+    
+    if (mismatches) printf("MISMATCH: %d queries ranked differently with pruning\n", mismatches);
+    
+    clear_index(&index);
+    return mismatches ? 1 : 0;
+}
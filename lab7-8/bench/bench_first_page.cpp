@@ -0,0 +1,74 @@
+#include "../include/query_cursor.h"
+#include "../include/tokenizer.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#define QUERIES_PER_SHAPE 200
+#define PAGE_SIZE 10
+
+int main(int argc, char* argv[]) {
+    int doc_count = argc > 1 ? atoi(argv[1]) : 40000;
+    const char* shapes[] = {"a OR b OR c OR d", "a AND b", "a AND NOT b", "\"a b\"", "(a OR b) AND NOT c"};
+    const char* formats[] = {"%s OR %s OR %s OR %s", "%s AND %s", "%s AND NOT %s", "\"%s %s\"", "(%s OR %s) AND NOT %s"};
+    int shape_count = 5;
+    
+    srand(23);
+    init_vocabulary(false);
+    
+    BooleanIndex index;
+    init_index(&index, 1024);
+    for (int d = 1; d <= doc_count; d++) {
+        TokenArray tokens = make_document(80, 240);
+        add_document_to_index(&index, &tokens, d);
+        free_tokens(&tokens);
+    }
+    finalize_index(&index);
+    
+    printf("First page of %d results over %d synthetic docs, %d queries per shape\n", PAGE_SIZE, doc_count, QUERIES_PER_SHAPE);
+    printf("%-24s %12s %12s %12s %10s\n", "shape", "results", "full us", "cursor us", "speedup");
+    
+    int mismatches = 0;
+    char query[512];
+    for (int shape = 0; shape < shape_count; shape++) {
+        double full_us = 0.0, cursor_us = 0.0;
+        long results = 0;
+        
+        for (int q = 0; q < QUERIES_PER_SHAPE; q++) {
+            snprintf(query, sizeof(query), formats[shape], vocabulary[rand() % 20], vocabulary[rand() % 20],
+                     vocabulary[rand() % 40], vocabulary[rand() % 40]);
+            QueryNode* tree = parse_query(query);
+            
+            auto start = std::chrono::steady_clock::now();
+            int count = 0;
+            int* docs = evaluate_query(&index, tree, &count);
+            full_us += elapsed_us(start);
+            
+            start = std::chrono::steady_clock::now();
+            QueryPlan* plan = plan_query(&index, tree);
+            QueryCursor* cursor = open_cursor(&index, plan);
+            int page_count = 0;
+            int* page = collect_cursor(cursor, PAGE_SIZE, &page_count);
+            close_cursor(cursor);
+            free_plan(plan);
+            cursor_us += elapsed_us(start);
+            
+            int expected = count < PAGE_SIZE ? count : PAGE_SIZE;
+            if (page_count != expected || (expected > 0 && memcmp(page, docs, expected * sizeof(int)) != 0)) mismatches++;
+            results += count;
+            free(page);
+            free(docs);
+            free_query(tree);
+        }
+        
+        printf("%-24s %12.1f %12.1f %12.1f %9.2fx\n", shapes[shape], (double)results / QUERIES_PER_SHAPE,
+               full_us / QUERIES_PER_SHAPE, cursor_us / QUERIES_PER_SHAPE, full_us / cursor_us);
+    }
+    
+    if (mismatches) printf("MISMATCH: %d first pages differ from full evaluation\n", mismatches);
+    
+    clear_index(&index);
+    return mismatches ? 1 : 0;
+}
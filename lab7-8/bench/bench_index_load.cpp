@@ -0,0 +1,81 @@
+#include "../include/boolean_index.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+static void build_synthetic_index(BooleanIndex* index, int doc_count) {
+    init_index(index, 1024);
+    
+    srand(11);
+    char words[64][16];
+    char* tokens_data[64];
+    for (int i = 0; i < 64; i++) {
+        tokens_data[i] = words[i];
+    }
+    
+    for (int doc = 1; doc <= doc_count; doc++) {
+        for (int i = 0; i < 64; i++) {
+            int rank = rand() % 50000;
+            rank = rank * (rank % 7 + 1) / 8;
+            
+            int length = 0;
+            for (int r = rank + 1; r > 0 && length < 15; r /= 26) {
+                words[i][length++] = 'a' + r % 26;
+            }
+            words[i][length] = '\0';
+        }
+        
+        TokenArray tokens = {tokens_data, 64};
+        add_document_to_index(index, &tokens, doc);
+    }
+}
+
+static void bench_load(const char* label, const char* filename, const char* probe) {
+    const int rounds = 5;
+    double load_ms = 0.0;
+    double first_ms = 0.0;
+    int doc_count = 0;
+    
+    for (int r = 0; r < rounds; r++) {
+        auto start = std::chrono::steady_clock::now();
+        BooleanIndex* index = load_index(filename);
+        load_ms += elapsed_ms(start);
+        if (!index) {
+            printf("  %-8s cannot load %s\n", label, filename);
+            return;
+        }
+        
+        start = std::chrono::steady_clock::now();
+        IndexEntry* entry = find_term(index, probe);
+        first_ms += elapsed_ms(start);
+        doc_count = entry ? entry->doc_count : 0;
+        
+        free_index(index);
+    }
+    
+    printf("  %-8s load %8.2f ms   first lookup %7.3f ms   ('%s' in %d docs)\n",
+           label, load_ms / rounds, first_ms / rounds, probe, doc_count);
+}
+
+int main() {
+    const int sizes[] = {2000, 10000, 40000};
+    
+    for (int s = 0; s < 3; s++) {
+        BooleanIndex index;
+        build_synthetic_index(&index, sizes[s]);
+        
+        save_index_sorted(&index, "bench_index_load.stream.idx");
+        save_index(&index, "bench_index_load.mapped.idx");
+        printf("%d docs, %d terms\n", sizes[s], index.count);
+        clear_index(&index);
+        
+        bench_load("stream", "bench_index_load.stream.idx", "b");
+        bench_load("mapped", "bench_index_load.mapped.idx", "b");
+    }
+    
+    remove("bench_index_load.stream.idx");
+    remove("bench_index_load.mapped.idx");
+    return 0;
+}
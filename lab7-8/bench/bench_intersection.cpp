@@ -0,0 +1,97 @@
+#include "../include/boolean_index.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+static int linear_intersect(const int* arr1, int count1, const int* arr2, int count2, int* result) {
+    int i = 0, j = 0, k = 0;
+    while (i < count1 && j < count2) {
+        if (arr1[i] < arr2[j]) {
+            i++;
+        } else if (arr1[i] > arr2[j]) {
+            j++;
+        } else {
+            result[k++] = arr1[i];
+            i++;
+            j++;
+        }
+    }
+    return k;
+}
+
+static void fill_entry(IndexEntry* entry, int count, int universe) {
+    memset(entry, 0, sizeof(IndexEntry));
+    entry->doc_ids = (int*)malloc(count * sizeof(int));
+    entry->doc_count = count;
+    entry->capacity = count;
+    
+    
+    int doc = 0;
+    for (int i = 0; i < count; i++) {
+        int remaining = count - i;
+        int gap_limit = (universe - doc) / remaining;
+        doc += 1 + (gap_limit > 1 ? rand() % (2 * gap_limit - 1) : 0);
+        if (doc > universe - remaining + 1) doc = universe - remaining + 1;
+        entry->doc_ids[i] = doc;
+    }
+    
+    build_skip_pointers(entry);
+}
+
+int main(int argc, char* argv[]) {
+    int long_count = argc > 1 ? atoi(argv[1]) : 1000000;
+    int universe = long_count * 4;
+    int ratios[] = {1, 4, 16, 64, 256, 1024, 4096};
+    
+    srand(3);
+    IndexEntry large;
+    fill_entry(&large, long_count, universe);
+    int* scratch = (int*)malloc(long_count * sizeof(int));
+    
+    printf("Intersection latency, long list %d docs (universe %d)\n", long_count, universe);
+    printf("%8s %10s %14s %14s %14s %10s\n", "ratio", "short", "linear us", "adaptive us", "skips us", "speedup");
+    
+    for (size_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++) {
+        IndexEntry small;
+        fill_entry(&small, long_count / ratios[r], universe);
+        
+        int rounds = 0;
+        double linear_us = 0.0, adaptive_us = 0.0, skip_us = 0.0;
+        int expected = 0, adaptive_count = 0, skip_count = 0;
+        
+        while (linear_us < 200000.0 && rounds < 1000) {
+            auto start = std::chrono::steady_clock::now();
+            expected = linear_intersect(small.doc_ids, small.doc_count, large.doc_ids, large.doc_count, scratch);
+            linear_us += elapsed_us(start);
+            
+            start = std::chrono::steady_clock::now();
+            int* adaptive = intersect_sorted_arrays(small.doc_ids, small.doc_count, large.doc_ids, large.doc_count, &adaptive_count);
+            adaptive_us += elapsed_us(start);
+            free(adaptive);
+            
+            start = std::chrono::steady_clock::now();
+            int* skipped = intersect_entries(&small, &large, &skip_count);
+            skip_us += elapsed_us(start);
+            free(skipped);
+            
+            rounds++;
+        }
+        
+        printf("%8d %10d %14.1f %14.1f %14.1f %9.1fx%s\n", ratios[r], small.doc_count,
+               linear_us / rounds, adaptive_us / rounds, skip_us / rounds,
+               linear_us / (skip_us < adaptive_us ? skip_us : adaptive_us),
+               expected == adaptive_count && expected == skip_count ? "" : "  MISMATCH");
+        
+        free(small.doc_ids);
+        free(small.skip_doc_ids);
+        free(small.skip_max_tf);
+    }
+    
+    free(large.doc_ids);
+    free(large.skip_doc_ids);
+    free(large.skip_max_tf);
+    free(scratch);
+    return 0;
+}
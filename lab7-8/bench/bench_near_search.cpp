@@ -0,0 +1,123 @@
+#include "../include/boolean_index.h"
+#include "../include/tokenizer.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#define COMMON_WORDS 40
+#define QUERIES_PER_CASE 100
+
+static int contains_window(const int* doc, int length, const int* words, int word_count, int distance) {
+    for (int i = 0; i < length; i++) {
+        int found = 0;
+        for (int w = 0; w < word_count; w++) {
+            int j = i;
+            while (j <= i + distance && j < length && doc[j] != words[w]) j++;
+            if (j <= i + distance && j < length) found++;
+        }
+        if (found == word_count) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int doc_count = argc > 1 ? atoi(argv[1]) : 40000;
+    int distances[] = {1, 3, 8};
+    
+    srand(13);
+    init_vocabulary(true);
+    
+    TokenArray* docs = (TokenArray*)malloc((doc_count + 1) * sizeof(TokenArray));
+    int** word_ids = (int**)malloc((doc_count + 1) * sizeof(int*));
+    BooleanIndex index;
+    init_index(&index, 1024);
+    for (int d = 1; d <= doc_count; d++) {
+        docs[d] = make_lyrics(&word_ids[d]);
+        add_document_to_index(&index, &docs[d], d);
+    }
+    finalize_index(&index);
+    
+    const char* index_file = "bench_near_search.idx";
+    save_index(&index, index_file);
+    BooleanIndex* mapped = load_index(index_file);
+    if (!mapped) return 1;
+    
+    printf("NEAR/k over %d synthetic lyric docs, common words, %d queries per case\n", doc_count, QUERIES_PER_CASE);
+    printf("%6s %4s %12s %10s %12s %12s %14s\n", "terms", "k", "candidates", "matches", 
+           "heap us", "mapped us", "ns/candidate");
+    
+    int mismatches = 0;
+    char text[256];
+    for (int word_count = 2; word_count <= 3; word_count++) {
+        for (size_t d = 0; d < sizeof(distances) / sizeof(distances[0]); d++) {
+            double heap_us = 0.0, mapped_us = 0.0;
+            long candidates = 0, matches = 0;
+            
+            for (int q = 0; q < QUERIES_PER_CASE; q++) {
+                int words[3];
+                size_t used = 0;
+                for (int w = 0; w < word_count; w++) {
+                    words[w] = (w + q * word_count) % COMMON_WORDS;
+                    used += snprintf(text + used, sizeof(text) - used, "%s ", vocabulary[words[w]]);
+                }
+                
+                int and_count = 0;
+                int* and_result = intersect_entries(find_term(&index, vocabulary[words[0]]), 
+                                                    find_term(&index, vocabulary[words[1]]), &and_count);
+                if (word_count == 3) {
+                    IndexEntry* third = find_term(&index, vocabulary[words[2]]);
+                    int* narrowed = intersect_sorted_arrays(and_result, and_count, third->doc_ids, third->doc_count, &and_count);
+                    free(and_result);
+                    and_result = narrowed;
+                }
+                
+                auto start = std::chrono::steady_clock::now();
+                int heap_count = 0;
+                int* heap_result = near_search(&index, text, distances[d], &heap_count);
+                heap_us += elapsed_us(start);
+                
+                start = std::chrono::steady_clock::now();
+                int near_count = 0;
+                int* near_result = near_search(mapped, text, distances[d], &near_count);
+                mapped_us += elapsed_us(start);
+                
+                
+                int k = 0;
+                int expected = 0;
+                for (int i = 0; i < and_count; i++) {
+                    if (!contains_window(word_ids[and_result[i]], docs[and_result[i]].count, words, word_count, distances[d])) continue;
+                    expected++;
+                    if (k >= near_count || near_result[k] != and_result[i] || heap_result[k] != and_result[i]) mismatches++;
+                    k++;
+                }
+                if (expected != near_count || expected != heap_count) mismatches++;
+                
+                candidates += and_count;
+                matches += near_count;
+                free(and_result);
+                free(heap_result);
+                free(near_result);
+            }
+            
+            printf("%6d %4d %12.1f %10.1f %12.1f %12.1f %14.1f\n", word_count, distances[d],
+                   (double)candidates / QUERIES_PER_CASE, (double)matches / QUERIES_PER_CASE,
+                   heap_us / QUERIES_PER_CASE, mapped_us / QUERIES_PER_CASE, 
+                   candidates ? mapped_us * 1000.0 / candidates : 0.0);
+        }
+    }
+    
+    if (mismatches) printf("MISMATCH: %d NEAR results differ from a token scan\n", mismatches);
+    
+    for (int d = 1; d <= doc_count; d++) {
+        free_tokens(&docs[d]);
+        free(word_ids[d]);
+    }
+    free(docs);
+    free(word_ids);
+    clear_index(&index);
+    free_index(mapped);
+    remove(index_file);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,127 @@
+#include "../include/boolean_index.h"
+#include "../include/tokenizer.h"
+#include "../include/utils.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#define QUERIES_PER_LENGTH 400
+
+static int* and_only_search(BooleanIndex* index, TokenArray* phrase, int* result_count) {
+    *result_count = 0;
+    int* result = nullptr;
+    
+    for (int i = 0; i < phrase->count; i++) {
+        IndexEntry* entry = find_term(index, phrase->tokens[i]);
+        if (!entry) {
+            free(result);
+            *result_count = 0;
+            return nullptr;
+        }
+        
+        if (i == 0) {
+            result = (int*)malloc(entry->doc_count * sizeof(int));
+            memcpy(result, entry->doc_ids, entry->doc_count * sizeof(int));
+            *result_count = entry->doc_count;
+        } else {
+            int* narrowed = intersect_sorted_arrays(result, *result_count, entry->doc_ids, entry->doc_count, result_count);
+            free(result);
+            result = narrowed;
+        }
+        if (!result) return nullptr;
+    }
+    
+    return result;
+}
+
+static int contains_phrase(TokenArray* doc, TokenArray* phrase) {
+    for (int i = 0; i + phrase->count <= doc->count; i++) {
+        int k = 0;
+        while (k < phrase->count && strcmp(doc->tokens[i + k], phrase->tokens[k]) == 0) k++;
+        if (k == phrase->count) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int doc_count = argc > 1 ? atoi(argv[1]) : 20000;
+    
+    srand(11);
+    init_vocabulary(false);
+    
+    TokenArray* docs = (TokenArray*)malloc((doc_count + 1) * sizeof(TokenArray));
+    BooleanIndex index;
+    init_index(&index, 1024);
+    for (int d = 1; d <= doc_count; d++) {
+        docs[d] = make_lyrics(nullptr);
+        add_document_to_index(&index, &docs[d], d);
+    }
+    finalize_index(&index);
+    
+    printf("Phrase search over %d synthetic lyric docs, %d queries per length\n", doc_count, QUERIES_PER_LENGTH);
+    printf("%6s %14s %14s %12s %12s\n", "words", "and-only us", "phrase us", "and docs", "phrase docs");
+    
+    int mismatches = 0;
+    char phrase_text[256];
+    for (int length = 2; length <= 6; length++) {
+        double and_us = 0.0, phrase_us = 0.0;
+        long and_docs = 0, phrase_docs = 0;
+        
+        for (int q = 0; q < QUERIES_PER_LENGTH; q++) {
+            TokenArray phrase;
+            phrase.tokens = (char**)malloc(length * sizeof(char*));
+            phrase.count = length;
+            
+            
+            TokenArray* source = &docs[1 + rand() % doc_count];
+            int start = rand() % (source->count - length + 1);
+            size_t used = 0;
+            for (int k = 0; k < length; k++) {
+                const char* word = q % 2 == 0 ? source->tokens[start + k] : vocabulary[pick_word()];
+                phrase.tokens[k] = strdup(word);
+                used += snprintf(phrase_text + used, sizeof(phrase_text) - used, "%s ", word);
+            }
+            
+            auto begin = std::chrono::steady_clock::now();
+            int and_count = 0;
+            int* and_result = and_only_search(&index, &phrase, &and_count);
+            and_us += elapsed_us(begin);
+            
+            begin = std::chrono::steady_clock::now();
+            int phrase_count = 0;
+            int* phrase_result = phrase_search(&index, phrase_text, &phrase_count);
+            phrase_us += elapsed_us(begin);
+            
+            
+            int expected = 0;
+            int k = 0;
+            for (int i = 0; i < and_count; i++) {
+                if (!contains_phrase(&docs[and_result[i]], &phrase)) continue;
+                expected++;
+                if (k >= phrase_count || phrase_result[k++] != and_result[i]) mismatches++;
+            }
+            if (expected != phrase_count) mismatches++;
+            
+            and_docs += and_count;
+            phrase_docs += phrase_count;
+            free(and_result);
+            free(phrase_result);
+            free_tokens(&phrase);
+        }
+        
+        printf("%6d %14.2f %14.2f %12.1f %12.1f\n", length, and_us / QUERIES_PER_LENGTH, 
+               phrase_us / QUERIES_PER_LENGTH, (double)and_docs / QUERIES_PER_LENGTH, 
+               (double)phrase_docs / QUERIES_PER_LENGTH);
+    }
+    
+    if (mismatches) printf("MISMATCH: %d phrase results differ from a token scan\n", mismatches);
+    
+    for (int d = 1; d <= doc_count; d++) {
+        free_tokens(&docs[d]);
+    }
+    free(docs);
+    clear_index(&index);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#include "../include/boolean_index.h"
+#include "../include/posting_codec.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+static BooleanIndex* make_synthetic_index() {
+    BooleanIndex* index = (BooleanIndex*)malloc(sizeof(BooleanIndex));
+    init_index(index, 64);
+    
+    srand(7);
+    char term[16];
+    char* token = term;
+    TokenArray tokens = {&token, 1};
+    
+    for (int t = 0; t < 200; t++) {
+        snprintf(term, sizeof(term), "term%d", t);
+        int step = 1 + t % 40;
+        for (int doc = 1 + rand() % step; doc < 200000; doc += 1 + rand() % step) {
+            add_document_to_index(index, &tokens, doc);
+        }
+    }
+    
+    return index;
+}
+
+static void bench_codec(BooleanIndex* index, const PostingCodec* fixed, int min_length) {
+    size_t total_bytes = 0;
+    long total_ints = 0;
+    long mismatches = 0;
+    int codec_usage[CODEC_COUNT] = {0};
+    
+    unsigned char** encoded = (unsigned char**)calloc(index->count, sizeof(unsigned char*));
+    size_t* sizes = (size_t*)calloc(index->count, sizeof(size_t));
+    const PostingCodec** codecs = (const PostingCodec**)calloc(index->count, sizeof(PostingCodec*));
+    int* decoded = (int*)malloc(sizeof(int) * 1);
+    int decoded_capacity = 1;
+    
+    for (int i = 0; i < index->count; i++) {
+        IndexEntry* entry = index_entry_at(index, i);
+        if (!entry || entry->doc_count < min_length) continue;
+        
+        codecs[i] = fixed ? fixed : choose_posting_codec(entry->doc_ids, entry->doc_count);
+        codec_usage[codecs[i]->id]++;
+        
+        encoded[i] = (unsigned char*)malloc(codecs[i]->max_encoded_size(entry->doc_count, entry->doc_ids[entry->doc_count - 1]) + 16);
+        sizes[i] = codecs[i]->encode(entry->doc_ids, entry->doc_count, encoded[i]);
+        total_bytes += sizes[i];
+        total_ints += entry->doc_count;
+        
+        if (entry->doc_count > decoded_capacity) {
+            decoded_capacity = entry->doc_count;
+            decoded = (int*)realloc(decoded, decoded_capacity * sizeof(int));
+        }
+    }
+    
+    
+    int rounds = 0;
+    auto start = std::chrono::steady_clock::now();
+    do {
+        for (int i = 0; i < index->count; i++) {
+            if (!encoded[i]) continue;
+            codecs[i]->decode(encoded[i], encoded[i] + sizes[i], index->entries[i].doc_count, decoded);
+            
+            if (rounds == 0 && memcmp(decoded, index->entries[i].doc_ids, index->entries[i].doc_count * sizeof(int)) != 0) {
+                mismatches++;
+            }
+        }
+        rounds++;
+    } while (elapsed_s(start) < 0.5);
+    double seconds = elapsed_s(start);
+    
+    printf("%-12s %10ld ints %8.2f bits/int %10.1f M ints/s", 
+           fixed ? fixed->name : "auto", total_ints,
+           total_ints ? total_bytes * 8.0 / total_ints : 0.0,
+           total_ints * (double)rounds / seconds / 1e6);
+    if (!fixed) {
+        printf("  [vbyte %d, elias-fano %d, bp128 %d]", 
+               codec_usage[CODEC_VBYTE], codec_usage[CODEC_ELIAS_FANO], codec_usage[CODEC_BP128]);
+    }
+    printf("%s\n", mismatches ? "  ROUND-TRIP MISMATCH" : "");
+    
+    for (int i = 0; i < index->count; i++) {
+        free(encoded[i]);
+    }
+    free(encoded);
+    free(codecs);
+    free(sizes);
+    free(decoded);
+}
+
+static void bench_next_geq(BooleanIndex* index, int min_length) {
+    long probes = 0;
+    long errors = 0;
+    double seconds = 0.0;
+    
+    for (int i = 0; i < index->count; i++) {
+        IndexEntry* entry = index_entry_at(index, i);
+        if (!entry || entry->doc_count < min_length) continue;
+        
+        const PostingCodec* codec = get_posting_codec(CODEC_ELIAS_FANO);
+        unsigned char* data = (unsigned char*)malloc(codec->max_encoded_size(entry->doc_count, entry->doc_ids[entry->doc_count - 1]) + 16);
+        codec->encode(entry->doc_ids, entry->doc_count, data);
+        
+        EliasFanoCursor cursor;
+        elias_fano_init(&cursor, data, entry->doc_count);
+        
+        int j = 0;
+        int last = entry->doc_ids[entry->doc_count - 1];
+        auto start = std::chrono::steady_clock::now();
+        for (int target = 1; target <= last; target += 1 + last / 1000) {
+            while (entry->doc_ids[j] < target) j++;
+            if (elias_fano_next_geq(&cursor, target) != entry->doc_ids[j]) errors++;
+            probes++;
+        }
+        seconds += elapsed_s(start);
+        
+        free(data);
+    }
+    
+    printf("elias-fano NextGEQ: %ld probes, %.1f M probes/s%s\n", 
+           probes, probes / seconds / 1e6, errors ? "  MISMATCH" : "");
+}
+
+int main(int argc, char* argv[]) {
+    BooleanIndex* index = argc > 1 ? load_index(argv[1]) : make_synthetic_index();
+    if (!index) {
+        printf("Cannot load index from: %s\n", argv[1]);
+        return 1;
+    }
+    
+    int min_length = argc > 2 ? atoi(argv[2]) : 1;
+    printf("Postings from %s (%d terms, lists with >= %d docs)\n", 
+           argc > 1 ? argv[1] : "synthetic index", index->count, min_length);
+    
+    for (int id = 0; id < CODEC_COUNT; id++) {
+        bench_codec(index, get_posting_codec(id), min_length);
+    }
+    bench_codec(index, nullptr, min_length);
+    bench_next_geq(index, min_length);
+    
+    free_index(index);
+    return 0;
+}
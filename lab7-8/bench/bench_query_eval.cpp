@@ -0,0 +1,106 @@
+#include "../include/query_planner.h"
+#include "../include/tokenizer.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#define QUERIES_PER_SHAPE 200
+
+static int* pairwise(BooleanIndex* index, const int* words, int word_count, int shape, int* result_count) {
+    IndexEntry* first = find_term(index, vocabulary[words[0]]);
+    *result_count = first ? first->doc_count : 0;
+    int* result = (int*)malloc((*result_count + 1) * sizeof(int));
+    if (first) memcpy(result, first->doc_ids, first->doc_count * sizeof(int));
+    
+    for (int w = 1; w < word_count; w++) {
+        int count = 0;
+        int* next = nullptr;
+        if (shape == 0) {
+            IndexEntry* entry = find_term(index, vocabulary[words[w]]);
+            next = entry ? intersect_sorted_arrays(result, *result_count, entry->doc_ids, entry->doc_count, &count) : nullptr;
+        } else if (shape == 1) {
+            IndexEntry* entry = find_term(index, vocabulary[words[w]]);
+            next = entry ? union_sorted_arrays(result, *result_count, entry->doc_ids, entry->doc_count, &count)
+                         : (int*)malloc(*result_count * sizeof(int));
+            if (!entry) {
+                memcpy(next, result, *result_count * sizeof(int));
+                count = *result_count;
+            }
+        } else {
+            int not_count = 0;
+            int* excluded = boolean_not(index, vocabulary[words[w]], nullptr, &not_count);
+            next = intersect_sorted_arrays(result, *result_count, excluded, not_count, &count);
+            free(excluded);
+        }
+        free(result);
+        result = next;
+        *result_count = result ? count : 0;
+    }
+    
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    int doc_count = argc > 1 ? atoi(argv[1]) : 40000;
+    const char* shapes[] = {"a AND b AND c AND d", "a OR b OR c OR d OR e OR f", "a AND NOT b AND NOT c"};
+    const char* separators[] = {" AND ", " OR ", " AND NOT "};
+    int word_counts[] = {4, 6, 3};
+    
+    srand(17);
+    init_vocabulary(false);
+    
+    BooleanIndex index;
+    init_index(&index, 1024);
+    for (int d = 1; d <= doc_count; d++) {
+        TokenArray tokens = make_document(80, 240);
+        add_document_to_index(&index, &tokens, d);
+        free_tokens(&tokens);
+    }
+    finalize_index(&index);
+    
+    printf("Query evaluation over %d synthetic docs, %d queries per shape\n", doc_count, QUERIES_PER_SHAPE);
+    printf("%-28s %12s %12s %12s %10s\n", "shape", "results", "pairwise us", "tree us", "speedup");
+    
+    int mismatches = 0;
+    char query[512];
+    for (int shape = 0; shape < 3; shape++) {
+        double pairwise_us = 0.0, tree_us = 0.0;
+        long results = 0;
+        
+        for (int q = 0; q < QUERIES_PER_SHAPE; q++) {
+            int words[8];
+            size_t used = 0;
+            for (int w = 0; w < word_counts[shape]; w++) {
+                words[w] = w == 0 || shape != 0 ? rand() % 200 : rand() % 40;
+                used += snprintf(query + used, sizeof(query) - used, "%s%s", w ? separators[shape] : "", vocabulary[words[w]]);
+            }
+            
+            auto start = std::chrono::steady_clock::now();
+            int expected = 0;
+            int* expected_docs = pairwise(&index, words, word_counts[shape], shape, &expected);
+            pairwise_us += elapsed_us(start);
+            
+            QueryNode* tree = parse_query(query);
+            start = std::chrono::steady_clock::now();
+            int count = 0;
+            int* docs = evaluate_query(&index, tree, &count);
+            tree_us += elapsed_us(start);
+            free_query(tree);
+            
+            if (count != expected || (count > 0 && memcmp(docs, expected_docs, count * sizeof(int)) != 0)) mismatches++;
+            results += count;
+            free(docs);
+            free(expected_docs);
+        }
+        
+        printf("%-28s %12.1f %12.1f %12.1f %9.2fx\n", shapes[shape], (double)results / QUERIES_PER_SHAPE,
+               pairwise_us / QUERIES_PER_SHAPE, tree_us / QUERIES_PER_SHAPE, pairwise_us / tree_us);
+    }
+    
+    if (mismatches) printf("MISMATCH: %d queries differ from pairwise evaluation\n", mismatches);
+    
+    clear_index(&index);
+    return mismatches ? 1 : 0;
+}
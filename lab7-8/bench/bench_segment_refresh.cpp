@@ -0,0 +1,125 @@
+#include "../include/segments.h"
+#include "../include/search.h"
+#include "../include/query_parser.h"
+#include "bench_common.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#define CORPUS_DIR "bench_segment_refresh.d"
+#define MANIFEST "bench_segment_refresh.idx"
+
+static void write_song(int doc, const char* marker) {
+    static const char* words[] = {
+        "love", "baby", "night", "heart", "dance", "fire", "rain", "road", "home", "dream",
+        "light", "tonight", "forever", "again", "never", "sky", "blue", "world", "time", "feel"
+    };
+    
+    char path[256];
+    snprintf(path, sizeof(path), "%s/song%05d.html", CORPUS_DIR, doc);
+    FILE* file = fopen(path, "w");
+    if (!file) return;
+    
+    fprintf(file, "<html><head><title>Song %d</title></head><body><div class='lyrics'>%s", doc, marker);
+    for (int w = 0; w < 200; w++) {
+        fprintf(file, " %s", words[rand() % 20]);
+    }
+    fprintf(file, "</div></body></html>\n");
+    fclose(file);
+}
+
+static int add_quietly(const char* path) {
+    fflush(stdout);
+    int saved = dup(1);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) dup2(null_fd, 1);
+    
+    int status = add_segment(MANIFEST, &path, 1, 1, 0);
+    
+    fflush(stdout);
+    if (saved >= 0) dup2(saved, 1);
+    if (saved >= 0) close(saved);
+    if (null_fd >= 0) close(null_fd);
+    return status;
+}
+
+static int count_matches(SegmentedIndex* segmented, const char* query) {
+    SearchContext context;
+    memset(&context, 0, sizeof(SearchContext));
+    context.tree = parse_query(query);
+    
+    int count = 0;
+    free(search_segments(segmented, query_tree_query, &context, &count));
+    free_query(context.tree);
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    int doc_count = argc > 1 ? atoi(argv[1]) : 2000;
+    const int rounds = 10;
+    
+    srand(9);
+    mkdir(CORPUS_DIR, 0755);
+    for (int d = 1; d <= doc_count; d++) {
+        write_song(d, "original");
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    if (add_quietly(CORPUS_DIR) != 0) return 1;
+    double full_ms = elapsed_ms(start);
+    
+    
+    int failures = 0;
+    double refresh_ms = 0.0;
+    char marker[32];
+    char previous[32] = "original";
+    int doc = 1 + rand() % doc_count;
+    
+    for (int r = 0; r < rounds; r++) {
+        snprintf(marker, sizeof(marker), "refresh%c", 'a' + r);
+        write_song(doc, marker);
+        
+        char path[256];
+        snprintf(path, sizeof(path), "%s/song%05d.html", CORPUS_DIR, doc);
+        start = std::chrono::steady_clock::now();
+        if (add_quietly(path) != 0) return 1;
+        refresh_ms += elapsed_ms(start);
+        
+        SegmentedIndex* segmented = open_segmented_index(MANIFEST);
+        if (!segmented) return 1;
+        int live = live_document_count(segmented);
+        int fresh = count_matches(segmented, marker);
+        int stale = strcmp(previous, "original") == 0 ? 0 : count_matches(segmented, previous);
+        if (live != doc_count || fresh != 1 || stale != 0) {
+            printf("  round %d: %d live, %d copies of '%s', %d of '%s'  MISMATCH\n",
+                   r, live, fresh, marker, stale, previous);
+            failures++;
+        }
+        close_segmented_index(segmented);
+        strcpy(previous, marker);
+    }
+    
+    printf("%d docs: full add %.1f ms, single file refresh %.2f ms (%d rounds), one live copy%s\n",
+           doc_count, full_ms, refresh_ms / rounds, rounds, failures ? "  MISMATCH" : "");
+    
+    
+    char path[256];
+    for (int n = 0; n <= rounds + 1; n++) {
+        const char* suffixes[] = {"", ".docs", ".live"};
+        for (int s = 0; s < 3; s++) {
+            snprintf(path, sizeof(path), "%s.seg%d%s", MANIFEST, n, suffixes[s]);
+            remove(path);
+        }
+    }
+    remove(MANIFEST);
+    for (int d = 1; d <= doc_count; d++) {
+        snprintf(path, sizeof(path), "%s/song%05d.html", CORPUS_DIR, d);
+        remove(path);
+    }
+    rmdir(CORPUS_DIR);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,103 @@
+#include "../include/simd_kernels.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+static int fill_sorted(int* arr, int count, int universe) {
+    int k = 0;
+    for (int value = 1; value <= universe && k < count; value++) {
+        if (rand() % universe < count) arr[k++] = value;
+    }
+    return k;
+}
+
+static int run_differential_tests(int rounds) {
+    int failures = 0;
+    const SimdKernels* reference = get_simd_kernels_for_level(SIMD_LEVEL_SCALAR);
+    int* arr1 = (int*)malloc(5000 * sizeof(int));
+    int* arr2 = (int*)malloc(5000 * sizeof(int));
+    int* expected = (int*)malloc((10000 + SIMD_OUTPUT_SLACK) * sizeof(int));
+    int* actual = (int*)malloc((10000 + SIMD_OUTPUT_SLACK) * sizeof(int));
+    
+    for (int level = SIMD_LEVEL_SSE42; get_simd_kernels_for_level(level); level++) {
+        const SimdKernels* kernels = get_simd_kernels_for_level(level);
+        
+        for (int r = 0; r < rounds; r++) {
+            int universe = 1 + rand() % 6000;
+            int count1 = fill_sorted(arr1, rand() % 5000, universe);
+            int count2 = fill_sorted(arr2, rand() % 5000, universe);
+            
+            int n = reference->intersect(arr1, count1, arr2, count2, expected);
+            int m = kernels->intersect(arr1, count1, arr2, count2, actual);
+            if (n != m || memcmp(expected, actual, n * sizeof(int)) != 0) {
+                printf("  %s intersect mismatch (%d vs %d elements)\n", kernels->name, n, m);
+                failures++;
+            }
+            
+            n = reference->merge(arr1, count1, arr2, count2, expected);
+            m = kernels->merge(arr1, count1, arr2, count2, actual);
+            if (n != m || memcmp(expected, actual, n * sizeof(int)) != 0) {
+                printf("  %s union mismatch (%d vs %d elements)\n", kernels->name, n, m);
+                failures++;
+            }
+        }
+        printf("Differential test %-8s %d random pairs: %s\n", kernels->name, rounds, failures ? "FAILED" : "ok");
+    }
+    
+    free(arr1);
+    free(arr2);
+    free(expected);
+    free(actual);
+    return failures;
+}
+
+static void bench_throughput(int count, int universe) {
+    int* arr1 = (int*)malloc(count * sizeof(int));
+    int* arr2 = (int*)malloc(count * sizeof(int));
+    int* out = (int*)malloc((2 * count + SIMD_OUTPUT_SLACK) * sizeof(int));
+    int count1 = fill_sorted(arr1, count, universe);
+    int count2 = fill_sorted(arr2, count, universe);
+    
+    printf("\n%d + %d ids in universe %d\n", count1, count2, universe);
+    
+    for (int level = SIMD_LEVEL_SCALAR; get_simd_kernels_for_level(level); level++) {
+        const SimdKernels* kernels = get_simd_kernels_for_level(level);
+        
+        int rounds = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (elapsed_s(start) < 0.3) {
+            kernels->intersect(arr1, count1, arr2, count2, out);
+            rounds++;
+        }
+        double intersect_rate = (double)(count1 + count2) * rounds / elapsed_s(start) / 1e6;
+        
+        rounds = 0;
+        start = std::chrono::steady_clock::now();
+        while (elapsed_s(start) < 0.3) {
+            kernels->merge(arr1, count1, arr2, count2, out);
+            rounds++;
+        }
+        double union_rate = (double)(count1 + count2) * rounds / elapsed_s(start) / 1e6;
+        
+        printf("  %-8s intersect %8.1f M ids/s   union %8.1f M ids/s\n", kernels->name, intersect_rate, union_rate);
+    }
+    
+    free(arr1);
+    free(arr2);
+    free(out);
+}
+
+int main(int argc, char* argv[]) {
+    srand(11);
+    printf("Dispatched kernels: %s\n", get_simd_kernels()->name);
+    
+    int failures = run_differential_tests(argc > 1 ? atoi(argv[1]) : 2000);
+    
+    bench_throughput(1000000, 4000000);
+    bench_throughput(1000000, 1200000);
+    bench_throughput(100000, 10000000);
+    
+    return failures ? 1 : 0;
+}
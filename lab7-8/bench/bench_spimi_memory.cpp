@@ -0,0 +1,123 @@
+#include "../include/index_builder.h"
+#include "../include/document_parser.h"
+#include "../include/utils.h"
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define CORPUS_DIR "bench_spimi_memory.d"
+#define INDEX_FILE "bench_spimi_memory.idx"
+#define RUNTIME_SLACK_MB 1.0
+
+static void make_word(int rank, char* word) {
+    int length = 0;
+    do {
+        word[length++] = (char)('a' + rank % 26);
+        rank /= 26;
+    } while (rank > 0 && length < 8);
+    word[length++] = 'q';
+    word[length] = '\0';
+}
+
+static void write_corpus(int doc_count, int doc_length, int vocabulary) {
+    double* cdf = (double*)malloc(vocabulary * sizeof(double));
+    double total = 0.0;
+    for (int i = 0; i < vocabulary; i++) {
+        total += 1.0 / (i + 1);
+        cdf[i] = total;
+    }
+    
+    srand(42);
+    mkdir(CORPUS_DIR, 0755);
+    char path[256];
+    char word[16];
+    
+    for (int d = 1; d <= doc_count; d++) {
+        snprintf(path, sizeof(path), "%s/doc%05d.html", CORPUS_DIR, d);
+        FILE* file = fopen(path, "w");
+        if (!file) continue;
+        
+        fprintf(file, "<html><head><title>Doc %d</title></head><body><div class='lyrics'>", d);
+        for (int t = 0; t < doc_length; t++) {
+            double r = (double)rand() / RAND_MAX * total;
+            int lo = 0, hi = vocabulary - 1;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (cdf[mid] < r) lo = mid + 1; else hi = mid;
+            }
+            make_word(lo, word);
+            fprintf(file, "%s ", word);
+        }
+        fprintf(file, "</div></body></html>\n");
+        fclose(file);
+    }
+    
+    free(cdf);
+}
+
+static long child_peak_kb(char** files, int file_count, size_t memory_budget, int* term_count) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) dup2(null_fd, 1);
+        int terms = memory_budget > 0 ? build_index_spimi_files(files, file_count, INDEX_FILE, memory_budget) : 0;
+        _exit(terms < 0 ? 255 : terms % 255);
+    }
+    
+    int status = 0;
+    struct rusage usage;
+    if (pid < 0 || wait4(pid, &status, 0, &usage) != pid) return -1;
+    *term_count = WIFEXITED(status) ? WEXITSTATUS(status) : 255;
+    return usage.ru_maxrss;
+}
+
+int main(int argc, char* argv[]) {
+    int doc_count = argc > 1 ? atoi(argv[1]) : 4000;
+    int doc_length = 400;
+    int vocabulary = 30000;
+    
+    write_corpus(doc_count, doc_length, vocabulary);
+    int file_count = 0;
+    char** files = list_html_files(CORPUS_DIR, &file_count);
+    
+    int terms = 0;
+    long baseline_kb = child_peak_kb(files, file_count, 0, &terms);
+    printf("Synthetic corpus: %d docs x %d tokens, vocabulary %d, baseline RSS %.1f MB\n",
+           file_count, doc_length, vocabulary, baseline_kb / 1024.0);
+    
+    
+    const int budgets_mb[] = {8, 16, 32};
+    int failures = 0;
+    int expected_terms = -1;
+    
+    for (int b = 0; b < 3; b++) {
+        size_t budget = (size_t)budgets_mb[b] * 1024 * 1024;
+        long peak_kb = child_peak_kb(files, file_count, budget, &terms);
+        double growth_mb = (peak_kb - baseline_kb) / 1024.0;
+        
+        if (expected_terms < 0) expected_terms = terms;
+        double allowed_mb = budgets_mb[b] + RUNTIME_SLACK_MB + budgets_mb[b] / 16.0;
+        int over = growth_mb > allowed_mb || terms == 255 || terms != expected_terms;
+        failures += over;
+        printf("  budget %3d MB: peak RSS %6.1f MB above baseline (limit %.1f MB)%s\n",
+               budgets_mb[b], growth_mb, allowed_mb, over ? "  OVER BUDGET" : "");
+    }
+    
+    
+    char path[256];
+    remove(INDEX_FILE);
+    snprintf(path, sizeof(path), "%s.docs", INDEX_FILE);
+    remove(path);
+    for (int i = 0; i < file_count; i++) {
+        remove(files[i]);
+    }
+    rmdir(CORPUS_DIR);
+    free_string_array(files, file_count);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+#include "../include/boolean_index.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+static void make_term(int n, char* buf) {
+    int len = 0;
+    buf[len++] = 't';
+    do {
+        buf[len++] = 'a' + n % 26;
+        n /= 26;
+    } while (n > 0);
+    buf[len] = '\0';
+}
+
+static double bench_hash_build(int term_count) {
+    char term[32];
+    BooleanIndex index;
+    init_index(&index, 100);
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < term_count; i++) {
+        make_term(i, term);
+        add_to_index(&index, term, 1, i);
+    }
+    
+    
+    for (int i = 0; i < term_count; i++) {
+        make_term(i, term);
+        add_to_index(&index, term, 2, i);
+    }
+    double ms = elapsed_ms(start);
+    
+    clear_index(&index);
+    return ms;
+}
+
+static double bench_linear_build(int term_count) {
+    char term[32];
+    char** terms = (char**)malloc(term_count * sizeof(char*));
+    int count = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < term_count; i++) {
+            make_term(i, term);
+            int found = -1;
+            for (int j = 0; j < count; j++) {
+                if (strcmp(terms[j], term) == 0) {
+                    found = j;
+                    break;
+                }
+            }
+            if (found == -1) {
+                terms[count++] = strdup(term);
+            }
+        }
+    }
+    double ms = elapsed_ms(start);
+    
+    for (int i = 0; i < count; i++) {
+        free(terms[i]);
+    }
+    free(terms);
+    return ms;
+}
+
+int main(int argc, char* argv[]) {
+    int sizes[] = {10000, 100000, 1000000};
+    int linear_limit = argc > 1 ? atoi(argv[1]) : 10000;
+    
+    printf("Term dictionary build (2 postings per term)\n");
+    printf("%10s %14s %14s\n", "terms", "hash ms", "linear ms");
+    
+    for (int i = 0; i < 3; i++) {
+        double hash_ms = bench_hash_build(sizes[i]);
+        
+        if (sizes[i] <= linear_limit) {
+            printf("%10d %14.2f %14.2f\n", sizes[i], hash_ms, bench_linear_build(sizes[i]));
+        } else {
+            printf("%10d %14.2f %14s\n", sizes[i], hash_ms, "skipped");
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "../include/boolean_index.h"
+#include "../include/term_dictionary.h"
+#include "../include/query_planner.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+#define DOCS_PER_TERM 3
+#define REPEATS 20
+
+static const char* SYLLABLES[] = {"me", "tal", "li", "ca", "rhap", "so", "dy", "queen", "ro", "ck",
+                                  "ja", "son", "bo", "hem", "ian", "star", "way", "night", "ra", "in"};
+
+static void make_term(int n, char* buf) {
+    int len = 0;
+    do {
+        const char* syllable = SYLLABLES[n % 20];
+        memcpy(buf + len, syllable, strlen(syllable));
+        len += strlen(syllable);
+        n /= 20;
+    } while (n > 0);
+    buf[len] = '\0';
+}
+
+static int* linear_expand(BooleanIndex* index, const char* pattern, int* count) {
+    int* result = (int*)malloc(index->count * sizeof(int));
+    *count = 0;
+    for (int i = 0; i < index->count; i++) {
+        if (match_wildcard(pattern, index->entries[i].term)) result[(*count)++] = i;
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    int term_count = argc > 1 ? atoi(argv[1]) : 400000;
+    int doc_count = term_count / 8;
+    
+    char term[64];
+    BooleanIndex index;
+    init_index(&index, term_count);
+    srand(11);
+    for (int i = 0; i < term_count; i++) {
+        make_term(i, term);
+        for (int d = 0; d < DOCS_PER_TERM; d++) {
+            add_to_index(&index, term, 1 + (i * 7 + d * 997 + rand() % 13) % doc_count, d);
+        }
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    TermDictionary* dictionary = get_term_dictionary(&index);
+    printf("Wildcard expansion over %d terms, %d documents\n", index.count, index.max_doc_id);
+    printf("dictionary build %.1f ms, %zu KB (%d front-coded blocks, %d 3-grams)\n\n", elapsed_ms(start),
+           dictionary->memory_bytes / 1024, dictionary->block_count, dictionary->gram_count);
+    
+    
+    const char* patterns[] = {"metal*", "rhap*", "*dy", "*queen", "*sonbo*", "me*ca", "ro*ck*in", "*tal*li*"};
+    printf("%-10s %8s %12s %12s %12s %12s %8s\n", "pattern", "terms", "linear ms", "expand ms", "query ms", "matches", "check");
+    
+    for (int p = 0; p < 8; p++) {
+        int linear_count = 0;
+        int expanded_count = 0;
+        int* linear = nullptr;
+        int* expanded = nullptr;
+        
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEATS; r++) {
+            free(linear);
+            linear = linear_expand(&index, patterns[p], &linear_count);
+        }
+        double linear_ms = elapsed_ms(start) / REPEATS;
+        
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEATS; r++) {
+            free(expanded);
+            expanded = expand_wildcard(dictionary, patterns[p], &expanded_count);
+        }
+        double expand_ms = elapsed_ms(start) / REPEATS;
+        
+        
+        std::sort(expanded, expanded + expanded_count);
+        bool same = linear_count == expanded_count && memcmp(linear, expanded, linear_count * sizeof(int)) == 0;
+        
+        QueryNode node = {QUERY_WILDCARD, (char*)patterns[p], 0, nullptr, 0, 0};
+        int match_count = 0;
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEATS; r++) {
+            free(evaluate_query(&index, &node, &match_count));
+        }
+        double query_ms = elapsed_ms(start) / REPEATS;
+        
+        printf("%-10s %8d %12.3f %12.3f %12.3f %12d %8s\n", patterns[p], expanded_count, linear_ms, expand_ms, 
+               query_ms, match_count, same ? "ok" : "MISMATCH");
+        free(linear);
+        free(expanded);
+    }
+    
+    clear_index(&index);
+    return 0;
+}
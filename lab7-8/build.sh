@@ -3,12 +3,29 @@ echo "Building HTML Boolean Search System..."
 mkdir -p obj bin data/html_documents
 
 g++ -std=c++11 -I./include -c src/utils.cpp -o obj/utils.o
+g++ -std=c++11 -I./include -c src/byte_io.cpp -o obj/byte_io.o
+g++ -std=c++11 -I./include -c src/posting_codec.cpp -o obj/posting_codec.o
+g++ -std=c++11 -I./include -c src/simd_kernels.cpp -o obj/simd_kernels.o
+g++ -std=c++11 -I./include -c src/roaring.cpp -o obj/roaring.o
 g++ -std=c++11 -I./include -c src/tokenizer.cpp -o obj/tokenizer.o
 g++ -std=c++11 -I./include -c src/document_parser.cpp -o obj/document_parser.o
+g++ -std=c++11 -I./include -c src/document_store.cpp -o obj/document_store.o
+g++ -std=c++11 -I./include -c src/term_dictionary.cpp -o obj/term_dictionary.o
 g++ -std=c++11 -I./include -c src/boolean_index.cpp -o obj/boolean_index.o
+g++ -std=c++11 -I./include -c src/index_builder.cpp -o obj/index_builder.o
+g++ -std=c++11 -I./include -c src/segments.cpp -o obj/segments.o
+g++ -std=c++11 -I./include -c src/query_parser.cpp -o obj/query_parser.o
+g++ -std=c++11 -I./include -pthread -c src/query_cache.cpp -o obj/query_cache.o
+g++ -std=c++11 -I./include -c src/query_planner.cpp -o obj/query_planner.o
+g++ -std=c++11 -I./include -c src/query_cursor.cpp -o obj/query_cursor.o
+g++ -std=c++11 -I./include -c src/ranking.cpp -o obj/ranking.o
+g++ -std=c++11 -I./include -c src/search.cpp -o obj/search.o
+g++ -std=c++11 -I./include -pthread -c src/server.cpp -o obj/server.o
+g++ -std=c++11 -I./include -c src/latency.cpp -o obj/latency.o
+g++ -std=c++11 -I./include -pthread -c src/batch.cpp -o obj/batch.o
 g++ -std=c++11 -I./include -c src/main.cpp -o obj/main.o
 
-g++ obj/utils.o obj/tokenizer.o obj/document_parser.o \ obj/boolean_index.o obj/main.o -o bin/html_bool_search
+g++ obj/utils.o obj/byte_io.o obj/posting_codec.o obj/simd_kernels.o obj/roaring.o obj/tokenizer.o obj/document_parser.o obj/document_store.o \ obj/term_dictionary.o obj/boolean_index.o obj/index_builder.o obj/segments.o obj/query_parser.o obj/query_cache.o obj/query_planner.o obj/query_cursor.o obj/ranking.o obj/search.o obj/server.o obj/latency.o obj/batch.o obj/main.o -o bin/html_bool_search -pthread
 
 echo "Build completed!"
 echo "Executable: bin/html_bool_search"
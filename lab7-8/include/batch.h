@@ -0,0 +1,8 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstddef>
+
+int run_batch(const char* index_file, const char* queries_file, const char* output_file, int thread_count, size_t cache_bytes);
+
+#endif
@@ -1,6 +1,17 @@
 #ifndef BOOLEAN_INDEX_H
 #define BOOLEAN_INDEX_H
+#include <cstddef>
 #include "document_parser.h"
+#include "tokenizer.h"
+#include "roaring.h"
+#include "byte_io.h"
+
+#define SKIP_INTERVAL 64
+#define GALLOP_RATIO 32
+#define DENSE_POSTING_RATIO 32
+#define BITMAP_PROBE_RATIO 4
+#define POSITIONAL_MAX_TERMS 32
+#define CURSOR_END 0x7fffffff
 
 typedef struct {
     int* positions;
@@ -15,23 +26,138 @@ typedef struct {
     PositionList* positions; 
     int doc_count;
     int capacity;
+    int* skip_doc_ids;
+    int* skip_max_tf;
+    int skip_count;
+    RoaringBitmap* bitmap;
+    const unsigned char* encoded_positions;
 } IndexEntry;
 
 
+typedef struct {
+    unsigned int hash;
+    int entry;
+} TermSlot;
+
+
+typedef struct {
+    int doc_id;
+    int word_count;
+    char* title;
+    char* path;
+} DocumentInfo;
+
+
+typedef struct {
+    unsigned int doc_id;
+    unsigned int word_count;
+    unsigned int title_offset;
+    unsigned int path_offset;
+} MappedDocument;
+
+
+typedef struct {
+    unsigned int term_offset;
+    unsigned int doc_count;
+    unsigned int position_count;
+    unsigned int codec;
+    unsigned long long postings_offset;
+    unsigned int doc_bytes;
+    unsigned int tf_bytes;
+    unsigned int position_bytes;
+    unsigned int reserved;
+} MappedTerm;
+
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    const MappedTerm* terms;
+    const char* strings;
+    size_t strings_size;
+    const MappedDocument* documents;
+    int document_count;
+    unsigned char** arena_chunks;
+    int arena_chunk_count;
+    size_t arena_used;
+    size_t arena_capacity;
+} MappedIndex;
+
+
 typedef struct {
     IndexEntry* entries;
     int count;
     int capacity;
+    TermSlot* slots;
+    int slot_capacity;
+    size_t memory_bytes;
+    int max_doc_id;
+    DocumentInfo* documents;
+    int document_count;
+    int document_capacity;
+    MappedIndex* mapped;
+    int* document_lengths;
+    long long total_length;
+    int min_length;
+    struct QueryCache* intersection_cache;
+    struct TermDictionary* dictionary;
 } BooleanIndex;
 
 
+typedef struct {
+    BooleanIndex* index;
+    const int* doc_map;
+} MergeSource;
+
+
+typedef struct PositionalCursor PositionalCursor;
+
+
 
 void init_index(BooleanIndex* index, int initial_capacity);
 
+size_t allocation_bytes(size_t bytes);
+
 void add_to_index(BooleanIndex* index, const char* term, int doc_id, int position);
 
+void add_document_to_index(BooleanIndex* index, TokenArray* tokens, int doc_id);
+
+void add_document_info(BooleanIndex* index, int doc_id, const char* title, const char* path, int word_count);
+
+int get_document_info(BooleanIndex* index, int doc_id, DocumentInfo* info);
+
+const int* get_document_lengths(BooleanIndex* index);
+
 IndexEntry* find_term(BooleanIndex* index, const char* term);
 
+int document_frequency(BooleanIndex* index, const char* term);
+
+int document_frequency_at(BooleanIndex* index, int i);
+
+IndexEntry* find_or_add_term(BooleanIndex* index, const char* term);
+
+IndexEntry* index_entry_at(BooleanIndex* index, int i);
+
+struct TermDictionary* get_term_dictionary(BooleanIndex* index);
+
+void build_skip_pointers(IndexEntry* entry);
+
+void build_posting_bitmap(BooleanIndex* index, IndexEntry* entry);
+
+void finalize_index(BooleanIndex* index);
+
+int gallop_to(const int* arr, int lo, int count, int target);
+
+int intersect_into(const int* arr1, int count1, const int* arr2, int count2, int* out);
+
+int intersect_list_with_entry(const int* doc_ids, int count, IndexEntry* entry, int* out);
+
+int* intersect_sorted_arrays(int* arr1, int count1, int* arr2, int count2, int* result_count);
+
+int* intersect_entries(IndexEntry* entry1, IndexEntry* entry2, int* result_count);
+
+int* union_sorted_arrays(int* arr1, int count1, int* arr2, int count2, int* result_count);
+
 int* boolean_and(BooleanIndex* index, const char* term1, const char* term2, int* result_count);
 
 int* boolean_or(BooleanIndex* index, const char* term1, const char* term2, int* result_count);
@@ -40,10 +166,35 @@ int* boolean_not(BooleanIndex* index, const char* term, DocumentCollection* docs
 
 int* phrase_search(BooleanIndex* index, const char* phrase, int* result_count);
 
-void save_index(BooleanIndex* index, const char* filename);
+int* near_search(BooleanIndex* index, const char* terms_text, int distance, int* result_count);
+
+PositionalCursor* open_phrase_cursor(BooleanIndex* index, const char* phrase);
+
+PositionalCursor* open_near_cursor(BooleanIndex* index, const char* terms_text, int distance);
+
+int positional_cursor_advance(PositionalCursor* cursor, int target);
+
+void close_positional_cursor(PositionalCursor* cursor);
+
+int save_index(BooleanIndex* index, const char* filename);
+
+int save_index_sorted(BooleanIndex* index, const char* filename);
+
+void put_document_record(ByteWriter* writer, const DocumentInfo* info);
+
+int merge_index_runs(const char** run_files, int run_count, const char* documents_file, 
+                     int document_count, const char* filename, size_t memory_budget);
+
+int is_stream_index(const char* filename);
+
+int convert_stream_index(const char* input, const char* filename, size_t memory_budget);
+
+int merge_mapped_indexes(const MergeSource* sources, int source_count, const char* filename);
 
 BooleanIndex* load_index(const char* filename);
 
+void clear_index(BooleanIndex* index);
+
 void free_index(BooleanIndex* index);
 
 #endif
\ No newline at end of file
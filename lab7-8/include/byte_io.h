@@ -0,0 +1,62 @@
+#ifndef BYTE_IO_H
+#define BYTE_IO_H
+
+#include <cstdio>
+#include <cstddef>
+
+#define BYTE_IO_BUFFER_SIZE (1 << 20)
+
+typedef struct {
+    FILE* file;
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+    int error;
+} ByteWriter;
+
+
+typedef struct {
+    FILE* file;
+    unsigned char* data;
+    size_t length;
+    size_t offset;
+    size_t capacity;
+    int error;
+} ByteReader;
+
+
+int init_byte_writer(ByteWriter* writer, FILE* file);
+
+int init_byte_writer_sized(ByteWriter* writer, FILE* file, size_t capacity);
+
+void put_bytes(ByteWriter* writer, const void* bytes, size_t count);
+
+void put_uint32(ByteWriter* writer, unsigned int value);
+
+void put_vbyte(ByteWriter* writer, unsigned int value);
+
+int flush_byte_writer(ByteWriter* writer);
+
+void free_byte_writer(ByteWriter* writer);
+
+int init_byte_reader(ByteReader* reader, FILE* file);
+
+int init_byte_reader_sized(ByteReader* reader, FILE* file, size_t capacity);
+
+int get_bytes(ByteReader* reader, void* bytes, size_t count);
+
+int get_uint32(ByteReader* reader, unsigned int* value);
+
+int get_vbyte(ByteReader* reader, unsigned int* value);
+
+void free_byte_reader(ByteReader* reader);
+
+unsigned int read_le32(const unsigned char* bytes);
+
+unsigned long long read_le64(const unsigned char* bytes);
+
+unsigned char* map_file(const char* filename, size_t* size);
+
+void unmap_file(unsigned char* data, size_t size);
+
+#endif
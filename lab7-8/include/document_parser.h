@@ -25,6 +25,8 @@ void add_document(DocumentCollection* collection, Document doc);
 
 DocumentCollection load_documents_from_dir(const char* dir_path);
 
+char** list_html_files(const char* dir_path, int* count);
+
 void free_document_collection(DocumentCollection* collection);
 
 Document parse_html_document(const char* filepath, int doc_id);
@@ -0,0 +1,70 @@
+#ifndef DOCUMENT_STORE_H
+#define DOCUMENT_STORE_H
+
+#include <cstddef>
+#include "byte_io.h"
+
+#define DOC_STORE_BLOCK_SIZE (16 * 1024)
+
+typedef struct {
+    unsigned long long offset;
+    unsigned int compressed_size;
+    unsigned int raw_size;
+} StoredBlock;
+
+
+typedef struct {
+    unsigned int doc_id;
+    unsigned int block;
+    unsigned int offset;
+    unsigned int length;
+} StoredDocument;
+
+
+typedef struct {
+    FILE* file;
+    ByteWriter writer;
+    unsigned char* block;
+    size_t block_length;
+    size_t block_capacity;
+    StoredBlock* blocks;
+    int block_count;
+    int block_table_capacity;
+    StoredDocument* documents;
+    int document_count;
+    int document_capacity;
+    unsigned long long offset;
+    int error;
+} DocumentStoreWriter;
+
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    const StoredBlock* blocks;
+    int block_count;
+    const StoredDocument* documents;
+    int document_count;
+    unsigned char* cache;
+    size_t cache_capacity;
+    int cached_block;
+    long blocks_decompressed;
+} DocumentStore;
+
+
+
+char* document_store_path(const char* index_file);
+
+int open_document_store_writer(DocumentStoreWriter* writer, const char* filename);
+
+int add_stored_document(DocumentStoreWriter* writer, int doc_id, const char* text);
+
+int close_document_store_writer(DocumentStoreWriter* writer);
+
+DocumentStore* open_document_store(const char* filename);
+
+char* fetch_document_text(DocumentStore* store, int doc_id);
+
+void close_document_store(DocumentStore* store);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef INDEX_BUILDER_H
+#define INDEX_BUILDER_H
+
+#include <cstddef>
+
+int build_index_spimi(const char* docs_dir, const char* index_file, size_t memory_budget);
+
+int build_index_parallel(const char* docs_dir, const char* index_file, int thread_count);
+
+int build_index_spimi_files(char** files, int file_count, const char* index_file, size_t memory_budget);
+
+int build_index_parallel_files(char** files, int file_count, const char* index_file, int thread_count);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#define LATENCY_BUCKETS 32
+#define LATENCY_BAR_WIDTH 40
+
+double latency_percentile(const double* sorted, int count, double p);
+
+void print_latency_report(double* latencies_us, int count, double elapsed_seconds);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef POSTING_CODEC_H
+#define POSTING_CODEC_H
+
+#include <cstddef>
+
+#define CODEC_VBYTE 0
+#define CODEC_ELIAS_FANO 1
+#define CODEC_BP128 2
+#define CODEC_COUNT 3
+
+#define BP128_BLOCK_SIZE 128
+
+typedef struct {
+    int id;
+    const char* name;
+    size_t (*max_encoded_size)(int count, int max_value);
+    size_t (*encode)(const int* doc_ids, int count, unsigned char* out);
+    size_t (*decode)(const unsigned char* in, const unsigned char* end, int count, int* doc_ids);
+} PostingCodec;
+
+
+typedef struct {
+    const unsigned char* low;
+    const unsigned char* high;
+    int count;
+    int low_bits;
+    int index;
+    long high_pos;
+    int value;
+} EliasFanoCursor;
+
+
+const PostingCodec* get_posting_codec(int id);
+
+const PostingCodec* choose_posting_codec(const int* doc_ids, int count);
+
+void elias_fano_init(EliasFanoCursor* cursor, const unsigned char* data, int count);
+
+int elias_fano_next_geq(EliasFanoCursor* cursor, int target);
+
+#endif
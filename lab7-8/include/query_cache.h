@@ -0,0 +1,50 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include <cstddef>
+
+#define CACHE_SHARDS 16
+#define CACHE_INITIAL_BUCKETS 64
+#define CACHE_DOORKEEPER_BITS 65536
+
+typedef struct QueryCache QueryCache;
+
+
+typedef struct {
+    int* doc_ids;
+    float* scores;
+    int count;
+    int match_count;
+    int scored_count;
+    int pruned;
+} ResultSet;
+
+
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long inserts;
+    unsigned long long evictions;
+    unsigned long long rejected;
+    int entries;
+    size_t bytes;
+    size_t budget;
+} CacheStats;
+
+
+
+QueryCache* create_query_cache(size_t budget_bytes, int admit_on_second_miss);
+
+void free_query_cache(QueryCache* cache);
+
+int cache_lookup(QueryCache* cache, const char* key, ResultSet* result);
+
+void cache_store(QueryCache* cache, const char* key, const ResultSet* result);
+
+void get_cache_stats(QueryCache* cache, CacheStats* stats);
+
+int format_cache_stats(QueryCache* cache, const char* name, char* buffer, size_t capacity);
+
+void free_result_set(ResultSet* result);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef QUERY_CURSOR_H
+#define QUERY_CURSOR_H
+
+#include "boolean_index.h"
+#include "query_planner.h"
+
+typedef struct QueryCursor QueryCursor;
+
+
+
+QueryCursor* open_cursor(BooleanIndex* index, QueryPlan* plan);
+
+int cursor_next(QueryCursor* cursor);
+
+int cursor_advance(QueryCursor* cursor, int target);
+
+int* collect_cursor(QueryCursor* cursor, int limit, int* result_count);
+
+void close_cursor(QueryCursor* cursor);
+
+#endif
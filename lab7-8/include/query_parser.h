@@ -0,0 +1,32 @@
+#ifndef QUERY_PARSER_H
+#define QUERY_PARSER_H
+
+typedef enum {
+    QUERY_TERM,
+    QUERY_PHRASE,
+    QUERY_NEAR,
+    QUERY_AND,
+    QUERY_OR,
+    QUERY_NOT,
+    QUERY_WILDCARD
+} QueryNodeType;
+
+
+typedef struct QueryNode {
+    QueryNodeType type;
+    char* text;
+    int distance;
+    struct QueryNode** children;
+    int child_count;
+    int child_capacity;
+} QueryNode;
+
+
+
+QueryNode* parse_query(const char* query);
+
+void free_query(QueryNode* node);
+
+char* normalize_query(const QueryNode* node);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef QUERY_PLANNER_H
+#define QUERY_PLANNER_H
+
+#include "boolean_index.h"
+#include "query_parser.h"
+
+#define UNION_PAIR 0
+#define UNION_HEAP 1
+#define UNION_BITMAP 2
+
+typedef enum {
+    PLAN_EMPTY,
+    PLAN_TERM,
+    PLAN_PHRASE,
+    PLAN_NEAR,
+    PLAN_INTERSECT,
+    PLAN_UNION,
+    PLAN_COMPLEMENT,
+    PLAN_WILDCARD
+} PlanOperator;
+
+
+typedef struct QueryPlan {
+    PlanOperator op;
+    QueryNode* node;
+    int negated;
+    int strategy;
+    double estimate;
+    int actual;
+    struct QueryPlan** children;
+    int child_count;
+    int* terms;
+    int term_count;
+} QueryPlan;
+
+
+
+QueryPlan* plan_query(BooleanIndex* index, QueryNode* node);
+
+int* execute_plan(BooleanIndex* index, QueryPlan* plan, int* result_count);
+
+void print_plan(QueryPlan* plan, int depth);
+
+void free_plan(QueryPlan* plan);
+
+int* evaluate_query(BooleanIndex* index, QueryNode* node, int* result_count);
+
+#endif
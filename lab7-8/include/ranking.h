@@ -0,0 +1,59 @@
+#ifndef RANKING_H
+#define RANKING_H
+
+#include "boolean_index.h"
+#include "query_parser.h"
+
+#define BM25_K1 1.2f
+#define BM25_B 0.75f
+#define SCORE_BLOCK 256
+#define SCORE_BOUND_SLACK 1.0001f
+#define WILDCARD_RANKED_TERMS 64
+#define PRUNE_MIN_TERMS 3
+#define PRUNE_MIN_POSTINGS_PER_RESULT 64
+
+typedef struct {
+    int doc_id;
+    float score;
+} ScoredDocument;
+
+
+typedef struct {
+    char** terms;
+    float* idf;
+    int term_count;
+    long long document_count;
+    double average_length;
+} RankingStats;
+
+
+typedef struct {
+    ScoredDocument* items;
+    int count;
+    int capacity;
+} TopKHeap;
+
+
+
+int init_ranking_stats(RankingStats* stats, QueryNode* tree, BooleanIndex** indexes, int index_count);
+
+void free_ranking_stats(RankingStats* stats);
+
+void score_documents(BooleanIndex* index, const RankingStats* stats, const int* doc_ids, int count, float* scores);
+
+int is_term_disjunction(QueryNode* tree);
+
+int prefers_pruning(BooleanIndex* index, const RankingStats* stats, int k);
+
+int rank_term_disjunction(BooleanIndex* index, const RankingStats* stats, const unsigned long long* live, 
+                          int doc_base, TopKHeap* heap);
+
+int init_top_k(TopKHeap* heap, int k);
+
+void offer_top_k(TopKHeap* heap, int doc_id, float score);
+
+ScoredDocument* finish_top_k(TopKHeap* heap, int* count);
+
+void free_top_k(TopKHeap* heap);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef ROARING_H
+#define ROARING_H
+
+#include <cstddef>
+
+#define ROARING_ARRAY_LIMIT 4096
+#define ROARING_BITMAP_WORDS 1024
+
+#define CONTAINER_ARRAY 0
+#define CONTAINER_BITMAP 1
+
+typedef struct {
+    int key;
+    int type;
+    int cardinality;
+    unsigned short* values;
+    unsigned long long* words;
+} RoaringContainer;
+
+
+typedef struct {
+    RoaringContainer* containers;
+    int count;
+    int cardinality;
+} RoaringBitmap;
+
+
+RoaringBitmap* roaring_from_sorted(const int* ids, int count);
+
+size_t roaring_size_for(const int* ids, int count);
+
+RoaringBitmap* roaring_from_sorted_in(const int* ids, int count, void* memory);
+
+void free_roaring(RoaringBitmap* bitmap);
+
+int roaring_contains(const RoaringBitmap* bitmap, int id);
+
+int roaring_to_array(const RoaringBitmap* bitmap, int* out);
+
+int roaring_and_to_array(const RoaringBitmap* a, const RoaringBitmap* b, int* out);
+
+int roaring_or_to_array(const RoaringBitmap* a, const RoaringBitmap* b, int* out);
+
+int roaring_filter_array(const RoaringBitmap* bitmap, const int* ids, int count, int* out);
+
+int roaring_complement_to_array(const RoaringBitmap* bitmap, int universe, int* out);
+
+#endif
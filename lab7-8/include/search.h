@@ -0,0 +1,39 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "boolean_index.h"
+#include "query_cache.h"
+#include "query_parser.h"
+#include "ranking.h"
+#include "segments.h"
+
+typedef struct {
+    QueryNode* tree;
+    int explain;
+    int segment;
+    int limit;
+    int top;
+} SearchContext;
+
+
+typedef struct {
+    int match_count;
+    int scored_count;
+    int pruned;
+} RankingSummary;
+
+
+
+int* query_tree_query(BooleanIndex* index, void* context, int* result_count);
+
+int* search_first_documents(SegmentedIndex* segmented, SearchContext* search, int* result_count);
+
+ScoredDocument* search_top_documents(SegmentedIndex* segmented, SearchContext* search, RankingSummary* summary, int* result_count);
+
+const char* parse_search_options(const char* line, SearchContext* search);
+
+int run_search(SegmentedIndex* segmented, SearchContext* search, QueryCache* cache, ResultSet* result);
+
+void attach_intersection_cache(SegmentedIndex* segmented, QueryCache* cache);
+
+#endif
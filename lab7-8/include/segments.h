@@ -0,0 +1,55 @@
+#ifndef SEGMENTS_H
+#define SEGMENTS_H
+
+#include <cstddef>
+#include "boolean_index.h"
+#include "document_store.h"
+
+typedef struct {
+    int number;
+    int doc_base;
+    int doc_count;
+    int live_count;
+    unsigned long long* live;
+    int live_dirty;
+    BooleanIndex* index;
+    DocumentStore* store;
+} Segment;
+
+
+typedef struct {
+    char* manifest;
+    Segment* segments;
+    int count;
+    int capacity;
+    int next_segment;
+} SegmentedIndex;
+
+
+typedef int* (*SegmentQuery)(BooleanIndex* index, void* context, int* result_count);
+
+
+
+SegmentedIndex* open_segmented_index(const char* path);
+
+void close_segmented_index(SegmentedIndex* segmented);
+
+int is_segment_doc_live(Segment* segment, int local_id);
+
+Segment* find_segment(SegmentedIndex* segmented, int doc_id);
+
+int* search_segments(SegmentedIndex* segmented, SegmentQuery query, void* context, int* result_count);
+
+int get_segment_document_info(SegmentedIndex* segmented, int doc_id, DocumentInfo* info);
+
+char* fetch_segment_document_text(SegmentedIndex* segmented, int doc_id);
+
+int live_document_count(SegmentedIndex* segmented);
+
+int add_segment(const char* manifest, const char** paths, int path_count, int thread_count, size_t memory_budget);
+
+int delete_documents(const char* manifest, const char** paths, int path_count);
+
+int merge_indexes(const char* output, const char** inputs, int input_count);
+
+#endif
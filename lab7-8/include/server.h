@@ -0,0 +1,15 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <cstddef>
+
+#define SERVER_MAX_LINE 4096
+#define SERVER_RESULT_IDS 10
+#define SERVER_RESULT_WIDTH 32
+#define SERVER_BACKLOG 64
+
+int run_server(const char* index_file, const char* address, int thread_count, size_t cache_bytes);
+
+int run_load_generator(const char* address, const char* queries_file, int connections, double seconds);
+
+#endif
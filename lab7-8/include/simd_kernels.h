@@ -0,0 +1,34 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#define SIMD_OUTPUT_SLACK 8
+
+#define SIMD_LEVEL_SCALAR 0
+#define SIMD_LEVEL_SSE42 1
+#define SIMD_LEVEL_AVX2 2
+
+typedef int (*SetKernel)(const int* arr1, int count1, const int* arr2, int count2, int* out);
+
+typedef void (*ScoreKernel)(const float* tf, const float* norms, int count, float weight, float* scores);
+
+
+typedef struct {
+    int level;
+    const char* name;
+    SetKernel intersect;
+    SetKernel merge;
+    ScoreKernel score;
+} SimdKernels;
+
+
+const SimdKernels* get_simd_kernels();
+
+const SimdKernels* get_simd_kernels_for_level(int level);
+
+int intersect_kernel(const int* arr1, int count1, const int* arr2, int count2, int* out);
+
+int union_kernel(const int* arr1, int count1, const int* arr2, int count2, int* out);
+
+void score_kernel(const float* tf, const float* norms, int count, float weight, float* scores);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TERM_DICTIONARY_H
+#define TERM_DICTIONARY_H
+
+#include <cstddef>
+
+#define DICTIONARY_BLOCK_SIZE 16
+#define KGRAM_SIZE 3
+#define KGRAM_BOUNDARY '\1'
+
+typedef struct TermDictionary {
+    int term_count;
+    int block_count;
+    int max_length;
+    unsigned char* data;
+    size_t data_size;
+    unsigned int* block_offsets;
+    int* entries;
+    unsigned int* grams;
+    unsigned int* gram_offsets;
+    int* gram_terms;
+    int gram_count;
+    size_t memory_bytes;
+} TermDictionary;
+
+
+
+TermDictionary* build_term_dictionary(const char** sorted_terms, const int* entries, int count);
+
+void free_term_dictionary(TermDictionary* dictionary);
+
+int find_prefix_range(TermDictionary* dictionary, const char* prefix, int* first, int* last);
+
+int* expand_wildcard(TermDictionary* dictionary, const char* pattern, int* result_count);
+
+int match_wildcard(const char* pattern, const char* term);
+
+#endif
@@ -14,6 +14,8 @@ char** split_string(const char* str, const char* delimiters, int* count);
 
 void free_string_array(char** arr, int count);
 
+char** read_lines(const char* filename, int* count);
+
 char* strdup(const char* src);
 
 #endif
\ No newline at end of file
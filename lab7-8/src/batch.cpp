@@ -0,0 +1,195 @@
+#include "../include/batch.h"
+#include "../include/latency.h"
+#include "../include/search.h"
+#include "../include/utils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} JsonBuffer;
+
+
+typedef struct {
+    SegmentedIndex* segmented;
+    char** queries;
+    int query_count;
+    int next_query;
+    int invalid_count;
+    char** lines;
+    double* latencies;
+    QueryCache* results;
+    QueryCache* intersections;
+} BatchState;
+
+static void append_json(JsonBuffer* buffer, const char* format, ...) {
+    va_list args;
+    while (true) {
+        size_t available = buffer->capacity - buffer->length;
+        va_start(args, format);
+        int written = buffer->data ? vsnprintf(buffer->data + buffer->length, available, format, args) : -1;
+        va_end(args);
+        
+        if (written >= 0 && (size_t)written < available) {
+            buffer->length += written;
+            return;
+        }
+        
+        size_t capacity = buffer->capacity == 0 ? 256 : buffer->capacity * 2;
+        if (written >= 0 && buffer->length + written + 1 > capacity) capacity = buffer->length + written + 1;
+        char* grown = (char*)realloc(buffer->data, capacity);
+        if (!grown) return;
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+}
+
+static void append_json_string(JsonBuffer* buffer, const char* text) {
+    append_json(buffer, "\"");
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            append_json(buffer, "\\%c", *p);
+        } else if (*p < 0x20) {
+            append_json(buffer, "\\u%04x", *p);
+        } else {
+            append_json(buffer, "%c", *p);
+        }
+    }
+    append_json(buffer, "\"");
+}
+
+static char* run_batch_query(BatchState* state, int number, const char* line, double* latency_us, int* invalid) {
+    JsonBuffer buffer = {nullptr, 0, 0};
+    append_json(&buffer, "{\"number\": %d, \"query\": ", number);
+    append_json_string(&buffer, line);
+    
+    auto start = std::chrono::steady_clock::now();
+    SearchContext context;
+    memset(&context, 0, sizeof(SearchContext));
+    const char* query = parse_search_options(line, &context);
+    context.tree = query ? parse_query(query) : nullptr;
+    
+    ResultSet result;
+    int cached = context.tree ? run_search(state->segmented, &context, state->results, &result) : 0;
+    *latency_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    
+    
+    if (!context.tree) {
+        append_json(&buffer, ", \"error\": \"invalid query\"");
+        *invalid = 1;
+    } else if (cached < 0) {
+        append_json(&buffer, ", \"error\": \"search failed\"");
+    } else if (context.top > 0) {
+        if (result.pruned) {
+            append_json(&buffer, ", \"count\": %d, \"scored\": %d, \"results\": [", result.count, result.scored_count);
+        } else {
+            append_json(&buffer, ", \"count\": %d, \"matches\": %d, \"results\": [", result.count, result.match_count);
+        }
+        for (int i = 0; i < result.count; i++) {
+            append_json(&buffer, i == 0 ? "{\"id\": %d, \"score\": %.4f}" : ", {\"id\": %d, \"score\": %.4f}", 
+                        result.doc_ids[i], result.scores[i]);
+        }
+        append_json(&buffer, "]");
+    } else {
+        append_json(&buffer, ", \"count\": %d, \"ids\": [", result.count);
+        for (int i = 0; i < result.count; i++) {
+            append_json(&buffer, i == 0 ? "%d" : ", %d", result.doc_ids[i]);
+        }
+        append_json(&buffer, "]");
+    }
+    if (state->results) append_json(&buffer, ", \"cached\": %s", cached ? "true" : "false");
+    append_json(&buffer, ", \"latency_us\": %.1f}\n", *latency_us);
+    
+    if (context.tree) free_result_set(&result);
+    free_query(context.tree);
+    return buffer.data;
+}
+
+static void batch_worker(BatchState* state) {
+    while (true) {
+        int q = __atomic_fetch_add(&state->next_query, 1, __ATOMIC_RELAXED);
+        if (q >= state->query_count) break;
+        
+        int invalid = 0;
+        state->lines[q] = run_batch_query(state, q + 1, state->queries[q], &state->latencies[q], &invalid);
+        if (invalid) __atomic_fetch_add(&state->invalid_count, 1, __ATOMIC_RELAXED);
+    }
+}
+
+int run_batch(const char* index_file, const char* queries_file, const char* output_file, int thread_count, size_t cache_bytes) {
+    if (thread_count < 1) thread_count = 1;
+    
+    BatchState state;
+    memset(&state, 0, sizeof(BatchState));
+    state.queries = read_lines(queries_file, &state.query_count);
+    if (state.query_count == 0) {
+        printf("No queries in: %s\n", queries_file);
+        free_string_array(state.queries, state.query_count);
+        return -1;
+    }
+    
+    state.segmented = open_segmented_index(index_file);
+    FILE* output = state.segmented ? fopen(output_file, "w") : nullptr;
+    state.lines = (char**)calloc(state.query_count, sizeof(char*));
+    state.latencies = (double*)calloc(state.query_count, sizeof(double));
+    if (!output || !state.lines || !state.latencies) {
+        printf(state.segmented ? "Cannot write results to: %s\n" : "Cannot load index from: %s\n",
+               state.segmented ? output_file : index_file);
+        if (output) fclose(output);
+        free(state.lines);
+        free(state.latencies);
+        close_segmented_index(state.segmented);
+        free_string_array(state.queries, state.query_count);
+        return -1;
+    }
+    
+    if (cache_bytes > 0) {
+        state.results = create_query_cache(cache_bytes - cache_bytes / 4, 0);
+        state.intersections = create_query_cache(cache_bytes / 4, 1);
+        attach_intersection_cache(state.segmented, state.intersections);
+    }
+    
+    printf("Running %d queries from %s on %d threads\n", state.query_count, queries_file, thread_count);
+    
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < thread_count; t++) {
+        workers.push_back(std::thread(batch_worker, &state));
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    for (int q = 0; q < state.query_count; q++) {
+        if (state.lines[q]) fputs(state.lines[q], output);
+        free(state.lines[q]);
+    }
+    fclose(output);
+    
+    printf("Results written to: %s\n", output_file);
+    print_latency_report(state.latencies, state.query_count, elapsed);
+    if (state.invalid_count > 0) printf("Invalid queries: %d\n", state.invalid_count);
+    
+    char summary[256];
+    for (int c = 0; c < 2 && cache_bytes > 0; c++) {
+        format_cache_stats(c == 0 ? state.results : state.intersections, c == 0 ? "Result" : "Intersection", summary, sizeof(summary));
+        printf("%s\n", summary);
+    }
+    
+    free_query_cache(state.results);
+    free_query_cache(state.intersections);
+    free(state.lines);
+    free(state.latencies);
+    close_segmented_index(state.segmented);
+    free_string_array(state.queries, state.query_count);
+    return 0;
+}
@@ -1,9 +1,41 @@
 #include "../include/boolean_index.h"
 #include "../include/utils.h"
+#include "../include/byte_io.h"
+#include "../include/posting_codec.h"
+#include "../include/simd_kernels.h"
+#include "../include/roaring.h"
+#include "../include/term_dictionary.h"
 #include "../include/document_parser.h"
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <climits>
+#include <algorithm>
+#include <mutex>
+
+#define INDEX_MAGIC "BIDX"
+#define INDEX_STREAM_VERSION 3
+#define INDEX_MAPPED_VERSION 6
+#define INDEX_MAPPED_MIN_VERSION 4
+#define INDEX_MAPPED_HEADER_SIZE 56
+#define MAPPED_ARENA_CHUNK (1 << 20)
+#define MERGE_MIN_BUFFER (4 * 1024)
+#define MERGE_MAX_FAN_IN 64
+#define MERGE_CHUNK_POSTINGS (16 * 1024)
+#define MERGE_CHUNK_BYTES (256 * 1024)
+#define SPOOL_BUFFER (64 * 1024)
+#define SPOOL_TERMS 0
+#define SPOOL_STRINGS 1
+#define SPOOL_SKIP_IDS 2
+#define SPOOL_SKIP_TFS 3
+#define SPOOL_DOCS 4
+#define SPOOL_TFS 5
+#define SPOOL_POSITIONS 6
+#define SPOOL_COUNT 7
+#define ALLOCATION_HEADER 8
+#define ALLOCATION_MIN 32
+
+static std::mutex lazy_state_lock;
 
 
 unsigned int hash_string(const char* str) {
@@ -17,28 +49,114 @@ unsigned int hash_string(const char* str) {
     return hash;
 }
 
+static int slot_capacity_for(int entry_capacity) {
+    int capacity = 16;
+    while (capacity < entry_capacity * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+static void init_slots(BooleanIndex* index, int slot_capacity) {
+    index->slots = (TermSlot*)malloc(slot_capacity * sizeof(TermSlot));
+    index->slot_capacity = index->slots ? slot_capacity : 0;
+    
+    for (int i = 0; i < index->slot_capacity; i++) {
+        index->slots[i].hash = 0;
+        index->slots[i].entry = -1;
+    }
+}
+
+static void insert_slot(BooleanIndex* index, unsigned int hash, int entry) {
+    int mask = index->slot_capacity - 1;
+    int i = hash & mask;
+    
+    while (index->slots[i].entry != -1) {
+        i = (i + 1) & mask;
+    }
+    
+    index->slots[i].hash = hash;
+    index->slots[i].entry = entry;
+}
+
+static void grow_slots(BooleanIndex* index) {
+    TermSlot* old_slots = index->slots;
+    int old_capacity = index->slot_capacity;
+    
+    init_slots(index, old_capacity * 2);
+    if (!index->slots) {
+        index->slots = old_slots;
+        index->slot_capacity = old_capacity;
+        return;
+    }
+    index->memory_bytes += old_capacity * sizeof(TermSlot);
+    
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_slots[i].entry != -1) {
+            insert_slot(index, old_slots[i].hash, old_slots[i].entry);
+        }
+    }
+    
+    free(old_slots);
+}
+
+static void init_entry(IndexEntry* entry) {
+    entry->term = nullptr;
+    entry->doc_ids = nullptr;
+    entry->positions = nullptr;
+    entry->doc_count = 0;
+    entry->capacity = 0;
+    entry->skip_doc_ids = nullptr;
+    entry->skip_max_tf = nullptr;
+    entry->skip_count = 0;
+    entry->bitmap = nullptr;
+    entry->encoded_positions = nullptr;
+}
+
+static void invalidate_entry_extras(IndexEntry* entry) {
+    entry->skip_count = 0;
+    free_roaring(entry->bitmap);
+    entry->bitmap = nullptr;
+}
+
 void init_index(BooleanIndex* index, int initial_capacity) {
+    if (initial_capacity < 1) initial_capacity = 1;
+    
     index->entries = (IndexEntry*)malloc(initial_capacity * sizeof(IndexEntry));
     index->count = 0;
     index->capacity = initial_capacity;
     
     for (int i = 0; i < initial_capacity; i++) {
-        index->entries[i].term = nullptr;
-        index->entries[i].doc_ids = nullptr;
-        index->entries[i].positions = nullptr;
-        index->entries[i].doc_count = 0;
-        index->entries[i].capacity = 0;
+        init_entry(&index->entries[i]);
     }
+    
+    init_slots(index, slot_capacity_for(initial_capacity));
+    index->max_doc_id = 0;
+    index->documents = nullptr;
+    index->document_count = 0;
+    index->document_capacity = 0;
+    index->mapped = nullptr;
+    index->document_lengths = nullptr;
+    index->total_length = 0;
+    index->min_length = 0;
+    index->intersection_cache = nullptr;
+    index->dictionary = nullptr;
+    index->memory_bytes = initial_capacity * sizeof(IndexEntry) + index->slot_capacity * sizeof(TermSlot);
 }
 
-void expand_entry_capacity(IndexEntry* entry) {
-    if (!entry) return;
+size_t allocation_bytes(size_t bytes) {
+    size_t chunk = (bytes + ALLOCATION_HEADER + 15) & ~(size_t)15;
+    return chunk < ALLOCATION_MIN ? ALLOCATION_MIN : chunk;
+}
+
+size_t expand_entry_capacity(IndexEntry* entry) {
+    if (!entry) return 0;
     
     int new_capacity = entry->capacity == 0 ? 4 : entry->capacity * 2;
     
     
     int* new_doc_ids = (int*)realloc(entry->doc_ids, new_capacity * sizeof(int));
-    if (!new_doc_ids) return;
+    if (!new_doc_ids) return 0;
     entry->doc_ids = new_doc_ids;
     
     
@@ -46,7 +164,7 @@ void expand_entry_capacity(IndexEntry* entry) {
     if (!new_positions) {
         
         entry->doc_ids = (int*)realloc(entry->doc_ids, entry->capacity * sizeof(int));
-        return;
+        return 0;
     }
     entry->positions = new_positions;
     
@@ -57,51 +175,68 @@ void expand_entry_capacity(IndexEntry* entry) {
         entry->positions[i].capacity = 0;
     }
     
+    size_t grown = (new_capacity - entry->capacity) * (sizeof(int) + sizeof(PositionList));
     entry->capacity = new_capacity;
+    return grown;
 }
 
-void add_to_index(BooleanIndex* index, const char* term, int doc_id, int position) {
-    if (!index || !term) return;
+IndexEntry* find_or_add_term(BooleanIndex* index, const char* term) {
+    if (!index || !term || index->mapped) return nullptr;
     
+    unsigned int hash = hash_string(term);
+    int mask = index->slot_capacity - 1;
+    int i = hash & mask;
     
-    IndexEntry* entry = nullptr;
-    for (int i = 0; i < index->count; i++) {
-        if (strcmp(index->entries[i].term, term) == 0) {
-            entry = &index->entries[i];
-            break;
+    while (index->slots[i].entry != -1) {
+        if (index->slots[i].hash == hash && 
+            strcmp(index->entries[index->slots[i].entry].term, term) == 0) {
+            return &index->entries[index->slots[i].entry];
         }
+        i = (i + 1) & mask;
     }
     
     
-    if (!entry) {
+    if (index->count >= index->capacity) {
+        int new_capacity = index->capacity * 2;
+        IndexEntry* new_entries = (IndexEntry*)realloc(index->entries, new_capacity * sizeof(IndexEntry));
+        if (!new_entries) return nullptr;
+        
+        index->memory_bytes += (new_capacity - index->capacity) * sizeof(IndexEntry);
+        index->entries = new_entries;
+        index->capacity = new_capacity;
         
-        if (index->count >= index->capacity) {
-            int new_capacity = index->capacity * 2;
-            IndexEntry* new_entries = (IndexEntry*)realloc(index->entries, new_capacity * sizeof(IndexEntry));
-            if (!new_entries) return;
-            
-            index->entries = new_entries;
-            index->capacity = new_capacity;
-            
-            
-            for (int i = index->count; i < new_capacity; i++) {
-                index->entries[i].term = nullptr;
-                index->entries[i].doc_ids = nullptr;
-                index->entries[i].positions = nullptr;
-                index->entries[i].doc_count = 0;
-                index->entries[i].capacity = 0;
-            }
-        }
         
-        entry = &index->entries[index->count];
-        entry->term = strdup(term);
-        entry->doc_ids = nullptr;
-        entry->positions = nullptr;
-        entry->doc_count = 0;
-        entry->capacity = 0;
-        index->count++;
+        for (int j = index->count; j < new_capacity; j++) {
+            init_entry(&index->entries[j]);
+        }
+    }
+    
+    IndexEntry* entry = &index->entries[index->count];
+    init_entry(entry);
+    entry->term = strdup(term);
+    index->memory_bytes += allocation_bytes(strlen(term) + 1);
+    
+    index->slots[i].hash = hash;
+    index->slots[i].entry = index->count;
+    index->count++;
+    
+    free_term_dictionary(index->dictionary);
+    index->dictionary = nullptr;
+    
+    
+    if (index->count * 2 > index->slot_capacity) {
+        grow_slots(index);
     }
     
+    return entry;
+}
+
+void add_to_index(BooleanIndex* index, const char* term, int doc_id, int position) {
+    if (!index || !term) return;
+    
+    IndexEntry* entry = find_or_add_term(index, term);
+    if (!entry) return;
+    
     
     int doc_index = -1;
     for (int i = 0; i < entry->doc_count; i++) {
@@ -115,16 +250,19 @@ void add_to_index(BooleanIndex* index, const char* term, int doc_id, int positio
     if (doc_index == -1) {
         
         if (entry->doc_count >= entry->capacity) {
-            expand_entry_capacity(entry);
+            index->memory_bytes += expand_entry_capacity(entry);
         }
         
         doc_index = entry->doc_count;
         entry->doc_ids[doc_index] = doc_id;
+        invalidate_entry_extras(entry);
+        if (doc_id > index->max_doc_id) index->max_doc_id = doc_id;
         
         
         entry->positions[doc_index].positions = (int*)malloc(4 * sizeof(int));
         entry->positions[doc_index].count = 0;
         entry->positions[doc_index].capacity = 4;
+        index->memory_bytes += allocation_bytes(4 * sizeof(int));
         
         entry->doc_count++;
     }
@@ -137,6 +275,7 @@ void add_to_index(BooleanIndex* index, const char* term, int doc_id, int positio
         int* new_positions = (int*)realloc(pos_list->positions, new_capacity * sizeof(int));
         if (!new_positions) return;
         
+        index->memory_bytes += allocation_bytes(new_capacity * sizeof(int)) - allocation_bytes(pos_list->capacity * sizeof(int));
         pos_list->positions = new_positions;
         pos_list->capacity = new_capacity;
     }
@@ -145,212 +284,473 @@ void add_to_index(BooleanIndex* index, const char* term, int doc_id, int positio
     pos_list->count++;
 }
 
-IndexEntry* find_term(BooleanIndex* index, const char* term) {
-    if (!index || !term) return nullptr;
+void add_document_to_index(BooleanIndex* index, TokenArray* tokens, int doc_id) {
+    if (!index || !tokens || tokens->count == 0) return;
     
-    for (int i = 0; i < index->count; i++) {
-        if (strcmp(index->entries[i].term, term) == 0) {
-            return &index->entries[i];
+    
+    unsigned long long* keys = (unsigned long long*)malloc(tokens->count * sizeof(unsigned long long));
+    if (!keys) return;
+    
+    for (int i = 0; i < tokens->count; i++) {
+        IndexEntry* entry = find_or_add_term(index, tokens->tokens[i]);
+        if (!entry) {
+            free(keys);
+            return;
         }
+        keys[i] = ((unsigned long long)(entry - index->entries) << 32) | (unsigned int)i;
     }
     
-    return nullptr;
+    std::sort(keys, keys + tokens->count);
+    if (doc_id > index->max_doc_id) index->max_doc_id = doc_id;
+    
+    
+    int run_start = 0;
+    while (run_start < tokens->count) {
+        int entry_index = (int)(keys[run_start] >> 32);
+        int run_end = run_start + 1;
+        while (run_end < tokens->count && (int)(keys[run_end] >> 32) == entry_index) {
+            run_end++;
+        }
+        int run_length = run_end - run_start;
+        
+        IndexEntry* entry = &index->entries[entry_index];
+        PositionList* pos_list = nullptr;
+        
+        if (entry->doc_count > 0 && entry->doc_ids[entry->doc_count - 1] == doc_id) {
+            pos_list = &entry->positions[entry->doc_count - 1];
+            int needed = pos_list->count + run_length;
+            if (needed > pos_list->capacity) {
+                int* new_positions = (int*)realloc(pos_list->positions, needed * sizeof(int));
+                if (!new_positions) break;
+                index->memory_bytes += allocation_bytes(needed * sizeof(int)) - allocation_bytes(pos_list->capacity * sizeof(int));
+                pos_list->positions = new_positions;
+                pos_list->capacity = needed;
+            }
+        } else {
+            if (entry->doc_count >= entry->capacity) {
+                index->memory_bytes += expand_entry_capacity(entry);
+                if (entry->doc_count >= entry->capacity) break;
+            }
+            
+            entry->doc_ids[entry->doc_count] = doc_id;
+            invalidate_entry_extras(entry);
+            pos_list = &entry->positions[entry->doc_count];
+            pos_list->positions = (int*)malloc(run_length * sizeof(int));
+            pos_list->count = 0;
+            pos_list->capacity = pos_list->positions ? run_length : 0;
+            index->memory_bytes += pos_list->positions ? allocation_bytes(run_length * sizeof(int)) : 0;
+            entry->doc_count++;
+            
+            if (!pos_list->positions) break;
+        }
+        
+        for (int i = run_start; i < run_end; i++) {
+            pos_list->positions[pos_list->count++] = (int)(keys[i] & 0xffffffffu);
+        }
+        
+        run_start = run_end;
+    }
+    
+    free(keys);
+}
+
+static const char* mapped_term_string(MappedIndex* mapped, int i) {
+    unsigned int offset = mapped->terms[i].term_offset;
+    return offset < mapped->strings_size ? mapped->strings + offset : nullptr;
 }
 
+static int skip_count_for(int doc_count) {
+    return (doc_count + SKIP_INTERVAL - 1) / SKIP_INTERVAL;
+}
 
-int* intersect_sorted_arrays(int* arr1, int count1, int* arr2, int count2, int* result_count) {
-    if (!arr1 || !arr2 || count1 == 0 || count2 == 0) {
-        *result_count = 0;
+static const unsigned char* read_mapped_vbyte(const unsigned char* in, const unsigned char* end, unsigned int* value) {
+    unsigned int result = 0;
+    for (int shift = 0; in < end && shift < 35; shift += 7) {
+        unsigned char byte = *in++;
+        result |= (unsigned int)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+static const unsigned char* mapped_postings(MappedIndex* mapped, int i) {
+    const MappedTerm* info = &mapped->terms[i];
+    unsigned long long bytes = (unsigned long long)skip_count_for(info->doc_count) * 2 * sizeof(int) + 
+                               info->doc_bytes + info->tf_bytes + info->position_bytes;
+    
+    if (info->doc_count == 0 || info->doc_count > INT_MAX || !get_posting_codec(info->codec) || 
+        info->postings_offset % sizeof(int) != 0 || info->postings_offset > mapped->size || 
+        bytes > mapped->size - info->postings_offset) {
         return nullptr;
     }
     
-    int max_result = count1 < count2 ? count1 : count2;
-    int* result = (int*)malloc(max_result * sizeof(int));
-    if (!result) {
-        *result_count = 0;
+    return mapped->data + info->postings_offset;
+}
+
+static const unsigned char* decode_mapped_postings(MappedIndex* mapped, int i, int* doc_ids, PositionList* tfs) {
+    const MappedTerm* info = &mapped->terms[i];
+    const unsigned char* postings = mapped_postings(mapped, i);
+    if (!postings) return nullptr;
+    
+    
+    const unsigned char* in = postings + skip_count_for(info->doc_count) * 2 * sizeof(int);
+    if (get_posting_codec(info->codec)->decode(in, in + info->doc_bytes, info->doc_count, doc_ids) != info->doc_bytes) {
         return nullptr;
     }
+    in += info->doc_bytes;
+    
+    const unsigned char* end = in + info->tf_bytes;
+    unsigned long long position_count = 0;
+    for (unsigned int j = 0; j < info->doc_count && in; j++) {
+        unsigned int tf = 0;
+        in = read_mapped_vbyte(in, end, &tf);
+        tfs[j].positions = nullptr;
+        tfs[j].count = (int)tf;
+        tfs[j].capacity = (int)tf;
+        position_count += tf;
+    }
     
-    int i = 0, j = 0, k = 0;
-    while (i < count1 && j < count2) {
-        if (arr1[i] < arr2[j]) {
-            i++;
-        } else if (arr1[i] > arr2[j]) {
-            j++;
-        } else {
-            result[k++] = arr1[i];
-            i++;
-            j++;
-        }
+    return in == end && position_count == info->position_count ? end : nullptr;
+}
+
+static void* arena_alloc(MappedIndex* mapped, size_t bytes) {
+    bytes = (bytes + 7) & ~(size_t)7;
+    
+    if (mapped->arena_chunk_count == 0 || mapped->arena_used + bytes > mapped->arena_capacity) {
+        size_t capacity = bytes > MAPPED_ARENA_CHUNK ? bytes : MAPPED_ARENA_CHUNK;
+        unsigned char** chunks = (unsigned char**)realloc(mapped->arena_chunks, 
+                                                          (mapped->arena_chunk_count + 1) * sizeof(unsigned char*));
+        if (!chunks) return nullptr;
+        mapped->arena_chunks = chunks;
+        
+        chunks[mapped->arena_chunk_count] = (unsigned char*)malloc(capacity);
+        if (!chunks[mapped->arena_chunk_count]) return nullptr;
+        mapped->arena_chunk_count++;
+        mapped->arena_used = 0;
+        mapped->arena_capacity = capacity;
     }
     
-    *result_count = k;
+    void* memory = mapped->arena_chunks[mapped->arena_chunk_count - 1] + mapped->arena_used;
+    mapped->arena_used += bytes;
+    return memory;
+}
+
+static IndexEntry* materialize_entry(BooleanIndex* index, int i) {
+    IndexEntry* entry = &index->entries[i];
+    if (__atomic_load_n(&entry->term, __ATOMIC_ACQUIRE)) return entry;
+    
+    std::lock_guard<std::mutex> guard(lazy_state_lock);
+    if (entry->term) return entry;
+    
+    MappedIndex* mapped = index->mapped;
+    const MappedTerm* info = &mapped->terms[i];
+    const char* term = mapped_term_string(mapped, i);
+    if (!term || !mapped_postings(mapped, i)) return nullptr;
+    
+    
+    int doc_count = (int)info->doc_count;
+    int* doc_ids = (int*)arena_alloc(mapped, doc_count * sizeof(int));
+    PositionList* positions = (PositionList*)arena_alloc(mapped, doc_count * sizeof(PositionList));
+    const unsigned char* encoded_positions = doc_ids && positions ? decode_mapped_postings(mapped, i, doc_ids, positions) : nullptr;
+    if (!encoded_positions) return nullptr;
+    
+    entry->doc_ids = doc_ids;
+    entry->positions = positions;
+    entry->doc_count = doc_count;
+    entry->capacity = doc_count;
+    entry->skip_doc_ids = (int*)(mapped->data + info->postings_offset);
+    entry->skip_count = skip_count_for(doc_count);
+    entry->skip_max_tf = entry->skip_doc_ids + entry->skip_count;
+    entry->encoded_positions = info->position_count > 0 ? encoded_positions : nullptr;
+    
+    if (doc_count >= SKIP_INTERVAL && (long)doc_count * DENSE_POSTING_RATIO >= index->max_doc_id) {
+        void* memory = arena_alloc(mapped, roaring_size_for(doc_ids, doc_count));
+        entry->bitmap = memory ? roaring_from_sorted_in(doc_ids, doc_count, memory) : nullptr;
+    }
     
+    __atomic_store_n(&entry->term, (char*)term, __ATOMIC_RELEASE);
+    return entry;
+}
+
+static int decode_entry_positions(BooleanIndex* index, IndexEntry* entry) {
+    if (!__atomic_load_n(&entry->encoded_positions, __ATOMIC_ACQUIRE)) return 1;
+    
+    std::lock_guard<std::mutex> guard(lazy_state_lock);
+    if (!entry->encoded_positions) return 1;
+    
+    MappedIndex* mapped = index->mapped;
+    const MappedTerm* info = &mapped->terms[entry - index->entries];
+    int* data = (int*)arena_alloc(mapped, info->position_count * sizeof(int));
+    if (!data) return 0;
+    
+    
+    const unsigned char* in = entry->encoded_positions;
+    const unsigned char* end = in + info->position_bytes;
+    for (int j = 0; j < entry->doc_count && in; j++) {
+        entry->positions[j].positions = data;
+        int position = 0;
+        for (int k = 0; k < entry->positions[j].count && in; k++) {
+            unsigned int delta = 0;
+            in = read_mapped_vbyte(in, end, &delta);
+            position += (int)delta;
+            *data++ = position;
+        }
+    }
+    if (in != end) return 0;
     
-    if (k < max_result) {
-        int* resized = (int*)realloc(result, k * sizeof(int));
-        if (resized) {
-            result = resized;
+    __atomic_store_n(&entry->encoded_positions, (const unsigned char*)nullptr, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static int find_mapped_term_index(BooleanIndex* index, const char* term) {
+    int lo = 0;
+    int hi = index->count - 1;
+    
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        const char* candidate = mapped_term_string(index->mapped, mid);
+        if (!candidate) return -1;
+        
+        int cmp = strcmp(candidate, term);
+        if (cmp == 0) return mid;
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
         }
     }
     
-    return result;
+    return -1;
 }
 
+static IndexEntry* find_mapped_term(BooleanIndex* index, const char* term) {
+    int i = find_mapped_term_index(index, term);
+    return i >= 0 ? materialize_entry(index, i) : nullptr;
+}
 
-int* union_sorted_arrays(int* arr1, int count1, int* arr2, int count2, int* result_count) {
-    int max_result = count1 + count2;
-    int* result = (int*)malloc(max_result * sizeof(int));
-    if (!result) {
-        *result_count = 0;
+IndexEntry* index_entry_at(BooleanIndex* index, int i) {
+    if (!index || i < 0 || i >= index->count) return nullptr;
+    
+    return index->mapped ? materialize_entry(index, i) : &index->entries[i];
+}
+
+typedef struct {
+    const char* term;
+    int entry;
+} TermOrder;
+
+TermDictionary* get_term_dictionary(BooleanIndex* index) {
+    if (!index) return nullptr;
+    
+    TermDictionary* cached = __atomic_load_n(&index->dictionary, __ATOMIC_ACQUIRE);
+    if (cached) return cached;
+    
+    std::lock_guard<std::mutex> guard(lazy_state_lock);
+    if (index->dictionary) return index->dictionary;
+    
+    const char** terms = (const char**)malloc((index->count + 1) * sizeof(char*));
+    int* entries = index->mapped ? nullptr : (int*)malloc((index->count + 1) * sizeof(int));
+    if (!terms || (!index->mapped && !entries)) {
+        free(terms);
+        free(entries);
         return nullptr;
     }
     
-    int i = 0, j = 0, k = 0;
-    while (i < count1 && j < count2) {
-        if (arr1[i] < arr2[j]) {
-            result[k++] = arr1[i++];
-        } else if (arr1[i] > arr2[j]) {
-            result[k++] = arr2[j++];
+    for (int i = 0; i < index->count; i++) {
+        if (index->mapped) {
+            terms[i] = mapped_term_string(index->mapped, i);
+            if (!terms[i]) terms[i] = "";
         } else {
-            result[k++] = arr1[i];
-            i++;
-            j++;
+            terms[i] = index->entries[i].term;
+            entries[i] = i;
         }
     }
     
-    while (i < count1) {
-        result[k++] = arr1[i++];
-    }
     
-    while (j < count2) {
-        result[k++] = arr2[j++];
+    TermOrder* order = entries ? (TermOrder*)malloc((index->count + 1) * sizeof(TermOrder)) : nullptr;
+    if (entries && !order) {
+        free(terms);
+        free(entries);
+        return nullptr;
     }
     
-    *result_count = k;
-    
-    
-    if (k < max_result) {
-        int* resized = (int*)realloc(result, k * sizeof(int));
-        if (resized) {
-            result = resized;
+    if (order) {
+        for (int i = 0; i < index->count; i++) {
+            order[i].term = terms[i];
+            order[i].entry = i;
+        }
+        std::sort(order, order + index->count, [](const TermOrder& a, const TermOrder& b) { return strcmp(a.term, b.term) < 0; });
+        for (int i = 0; i < index->count; i++) {
+            terms[i] = order[i].term;
+            entries[i] = order[i].entry;
         }
+        free(order);
     }
     
-    return result;
+    TermDictionary* dictionary = build_term_dictionary(terms, entries, index->count);
+    free(terms);
+    free(entries);
+    __atomic_store_n(&index->dictionary, dictionary, __ATOMIC_RELEASE);
+    return dictionary;
 }
 
-int* boolean_and(BooleanIndex* index, const char* term1, const char* term2, int* result_count) {
-    *result_count = 0;
-    
-    if (!index || !term1 || !term2) return nullptr;
-    
+void add_document_info(BooleanIndex* index, int doc_id, const char* title, const char* path, int word_count) {
+    if (!index || index->mapped) return;
     
-    IndexEntry* entry1 = find_term(index, term1);
-    IndexEntry* entry2 = find_term(index, term2);
+    if (index->document_count >= index->document_capacity) {
+        int new_capacity = index->document_capacity == 0 ? 64 : index->document_capacity * 2;
+        DocumentInfo* documents = (DocumentInfo*)realloc(index->documents, new_capacity * sizeof(DocumentInfo));
+        if (!documents) return;
+        
+        index->memory_bytes += (new_capacity - index->document_capacity) * sizeof(DocumentInfo);
+        index->documents = documents;
+        index->document_capacity = new_capacity;
+    }
     
-    if (!entry1 || !entry2) return nullptr;
+    DocumentInfo* info = &index->documents[index->document_count++];
+    info->doc_id = doc_id;
+    info->word_count = word_count;
+    info->title = strdup(title ? title : "");
+    info->path = strdup(path ? path : "");
+    index->memory_bytes += strlen(info->title) + strlen(info->path) + 2;
     
+    if (doc_id > index->max_doc_id) index->max_doc_id = doc_id;
     
-    return intersect_sorted_arrays(entry1->doc_ids, entry1->doc_count, 
-                                   entry2->doc_ids, entry2->doc_count, 
-                                   result_count);
+    free(index->document_lengths);
+    index->document_lengths = nullptr;
 }
 
-int* boolean_or(BooleanIndex* index, const char* term1, const char* term2, int* result_count) {
-    *result_count = 0;
-    
-    if (!index || !term1 || !term2) return nullptr;
-    
-    
-    IndexEntry* entry1 = find_term(index, term1);
-    IndexEntry* entry2 = find_term(index, term2);
-    
-    if (!entry1 && !entry2) return nullptr;
+static int find_document_slot(int doc_id, int count, int (*id_at)(const void*, int), const void* table) {
+    if (doc_id >= 1 && doc_id <= count && id_at(table, doc_id - 1) == doc_id) return doc_id - 1;
+    
+    
+    int lo = 0;
+    int hi = count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int id = id_at(table, mid);
+        if (id == doc_id) return mid;
+        if (id < doc_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
     
+    return -1;
+}
+
+static int document_id_at(const void* table, int i) {
+    return ((const DocumentInfo*)table)[i].doc_id;
+}
+
+static int mapped_document_id_at(const void* table, int i) {
+    return (int)((const MappedDocument*)table)[i].doc_id;
+}
+
+int get_document_info(BooleanIndex* index, int doc_id, DocumentInfo* info) {
+    if (!index || !info) return 0;
     
-    if (!entry1) {
-        int* result = (int*)malloc(entry2->doc_count * sizeof(int));
-        if (!result) return nullptr;
+    if (!index->mapped) {
+        int slot = find_document_slot(doc_id, index->document_count, document_id_at, index->documents);
+        if (slot < 0) return 0;
         
-        memcpy(result, entry2->doc_ids, entry2->doc_count * sizeof(int));
-        *result_count = entry2->doc_count;
-        return result;
+        *info = index->documents[slot];
+        return 1;
     }
     
-    if (!entry2) {
-        int* result = (int*)malloc(entry1->doc_count * sizeof(int));
-        if (!result) return nullptr;
-        
-        memcpy(result, entry1->doc_ids, entry1->doc_count * sizeof(int));
-        *result_count = entry1->doc_count;
-        return result;
-    }
+    MappedIndex* mapped = index->mapped;
+    int slot = find_document_slot(doc_id, mapped->document_count, mapped_document_id_at, mapped->documents);
+    if (slot < 0) return 0;
     
+    const MappedDocument* record = &mapped->documents[slot];
+    if (record->title_offset >= mapped->strings_size || record->path_offset >= mapped->strings_size) return 0;
     
-    return union_sorted_arrays(entry1->doc_ids, entry1->doc_count,
-                               entry2->doc_ids, entry2->doc_count,
-                               result_count);
+    info->doc_id = doc_id;
+    info->word_count = (int)record->word_count;
+    info->title = (char*)(mapped->strings + record->title_offset);
+    info->path = (char*)(mapped->strings + record->path_offset);
+    return 1;
 }
 
-int* boolean_not(BooleanIndex* index, const char* term, DocumentCollection* docs, int* result_count) {
-    *result_count = 0;
+const int* get_document_lengths(BooleanIndex* index) {
+    if (!index) return nullptr;
     
-    if (!index || !term || !docs) return nullptr;
+    int* cached = __atomic_load_n(&index->document_lengths, __ATOMIC_ACQUIRE);
+    if (cached) return cached;
     
+    std::lock_guard<std::mutex> guard(lazy_state_lock);
+    if (index->document_lengths) return index->document_lengths;
     
-    IndexEntry* entry = find_term(index, term);
+    int* lengths = (int*)calloc(index->max_doc_id + 1, sizeof(int));
+    if (!lengths) return nullptr;
     
-    if (!entry) {
+    long long total = 0;
+    int shortest = 0;
+    int count = index->mapped ? index->mapped->document_count : index->document_count;
+    for (int i = 0; i < count; i++) {
+        int doc_id = index->mapped ? (int)index->mapped->documents[i].doc_id : index->documents[i].doc_id;
+        int word_count = index->mapped ? (int)index->mapped->documents[i].word_count : index->documents[i].word_count;
+        if (doc_id < 1 || doc_id > index->max_doc_id) continue;
         
-        int* result = (int*)malloc(docs->count * sizeof(int));
-        if (!result) return nullptr;
-        
-        for (int i = 0; i < docs->count; i++) {
-            result[i] = docs->documents[i].id;
-        }
-        
-        *result_count = docs->count;
-        return result;
+        lengths[doc_id] = word_count;
+        total += word_count;
+        if (i == 0 || word_count < shortest) shortest = word_count;
     }
     
+    index->total_length = total;
+    index->min_length = shortest;
+    __atomic_store_n(&index->document_lengths, lengths, __ATOMIC_RELEASE);
+    return lengths;
+}
+
+int document_frequency_at(BooleanIndex* index, int i) {
+    if (!index || i < 0 || i >= index->count) return 0;
+    return index->mapped ? (int)index->mapped->terms[i].doc_count : index->entries[i].doc_count;
+}
+
+int document_frequency(BooleanIndex* index, const char* term) {
+    if (!index || !term) return 0;
     
-    int* all_docs = (int*)malloc(docs->count * sizeof(int));
-    if (!all_docs) return nullptr;
-    
-    for (int i = 0; i < docs->count; i++) {
-        all_docs[i] = docs->documents[i].id;
+    if (index->mapped) {
+        int i = find_mapped_term_index(index, term);
+        return i >= 0 ? (int)index->mapped->terms[i].doc_count : 0;
     }
     
+    IndexEntry* entry = find_term(index, term);
+    return entry ? entry->doc_count : 0;
+}
+
+IndexEntry* find_term(BooleanIndex* index, const char* term) {
+    if (!index || !term) return nullptr;
+    if (index->mapped) return find_mapped_term(index, term);
+    if (index->slot_capacity == 0) return nullptr;
     
-    int max_result = docs->count;
-    int* result = (int*)malloc(max_result * sizeof(int));
-    if (!result) {
-        free(all_docs);
-        return nullptr;
-    }
+    unsigned int hash = hash_string(term);
+    int mask = index->slot_capacity - 1;
     
-    int k = 0;
-    for (int i = 0; i < docs->count; i++) {
-        bool found = false;
-        for (int j = 0; j < entry->doc_count; j++) {
-            if (all_docs[i] == entry->doc_ids[j]) {
-                found = true;
-                break;
-            }
-        }
-        
-        if (!found) {
-            result[k++] = all_docs[i];
+    for (int i = hash & mask; index->slots[i].entry != -1; i = (i + 1) & mask) {
+        if (index->slots[i].hash == hash && 
+            strcmp(index->entries[index->slots[i].entry].term, term) == 0) {
+            return &index->entries[index->slots[i].entry];
         }
     }
     
-    free(all_docs);
-    *result_count = k;
-    
+    return nullptr;
+}
+
+
+static int* shrink_result(int* result, int count, int max_result) {
+    if (count == 0) {
+        free(result);
+        return nullptr;
+    }
     
-    if (k < max_result) {
-        int* resized = (int*)realloc(result, k * sizeof(int));
+    if (count < max_result) {
+        int* resized = (int*)realloc(result, count * sizeof(int));
         if (resized) {
             result = resized;
         }
@@ -359,244 +759,2220 @@ int* boolean_not(BooleanIndex* index, const char* term, DocumentCollection* docs
     return result;
 }
 
-int* phrase_search(BooleanIndex* index, const char* phrase, int* result_count) {
-    *result_count = 0;
+int gallop_to(const int* arr, int lo, int count, int target) {
+    int step = 1;
+    int hi = lo;
+    
+    while (hi < count && arr[hi] < target) {
+        lo = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    if (hi > count) hi = count;
     
-    if (!index || !phrase) return nullptr;
     
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (arr[mid] < target) lo = mid + 1; else hi = mid;
+    }
     
-    int token_count = 0;
-    char** tokens = split_string(phrase, " ", &token_count);
+    return lo;
+}
+
+static int gallop_intersect(const int* small, int small_count, const int* large, int large_count, int* result) {
+    int k = 0;
+    int j = 0;
     
-    if (!tokens || token_count < 2) {
-        if (tokens) free_string_array(tokens, token_count);
-        return nullptr;
+    for (int i = 0; i < small_count && j < large_count; i++) {
+        j = gallop_to(large, j, large_count, small[i]);
+        if (j < large_count && large[j] == small[i]) {
+            result[k++] = small[i];
+            j++;
+        }
     }
     
+    return k;
+}
+
+static int skip_intersect(const int* small, int small_count, IndexEntry* large, int* result) {
+    int k = 0;
+    int block = 0;
+    int j = 0;
     
-    int* current_result = nullptr;
-    int current_count = 0;
-    
-    for (int i = 0; i < token_count; i++) {
-        IndexEntry* entry = find_term(index, tokens[i]);
+    for (int i = 0; i < small_count; i++) {
         
-        if (!entry) {
-            
-            if (current_result) free(current_result);
-            free_string_array(tokens, token_count);
-            *result_count = 0;
-            return nullptr;
+        int next_block = gallop_to(large->skip_doc_ids, block, large->skip_count, small[i]);
+        if (next_block >= large->skip_count) break;
+        
+        if (next_block != block) {
+            block = next_block;
+            j = block * SKIP_INTERVAL;
         }
         
-        if (i == 0) {
-            
-            current_result = (int*)malloc(entry->doc_count * sizeof(int));
-            if (!current_result) {
-                free_string_array(tokens, token_count);
-                return nullptr;
-            }
-            
-            memcpy(current_result, entry->doc_ids, entry->doc_count * sizeof(int));
-            current_count = entry->doc_count;
-        } else {
-            
-            int* new_result = intersect_sorted_arrays(
-                current_result, current_count,
-                entry->doc_ids, entry->doc_count,
-                &current_count
-            );
-            
-            free(current_result);
-            current_result = new_result;
-            
-            if (!current_result || current_count == 0) {
-                break;
-            }
+        int block_end = (block + 1) * SKIP_INTERVAL;
+        if (block_end > large->doc_count) block_end = large->doc_count;
+        
+        j = gallop_to(large->doc_ids, j, block_end, small[i]);
+        if (j < block_end && large->doc_ids[j] == small[i]) {
+            result[k++] = small[i];
+            j++;
         }
     }
     
-    free_string_array(tokens, token_count);
-    
-    if (!current_result || current_count == 0) {
-        *result_count = 0;
+    return k;
+}
+
+void build_skip_pointers(IndexEntry* entry) {
+    if (!entry) return;
+    
+    int skip_count = (entry->doc_count + SKIP_INTERVAL - 1) / SKIP_INTERVAL;
+    int* skips = (int*)realloc(entry->skip_doc_ids, (skip_count + 1) * sizeof(int));
+    if (!skips) return;
+    entry->skip_doc_ids = skips;
+    
+    int* max_tf = (int*)realloc(entry->skip_max_tf, (skip_count + 1) * sizeof(int));
+    if (!max_tf) return;
+    entry->skip_max_tf = max_tf;
+    
+    for (int b = 0; b < skip_count; b++) {
+        int first = b * SKIP_INTERVAL;
+        int last = (b + 1) * SKIP_INTERVAL - 1;
+        if (last >= entry->doc_count) last = entry->doc_count - 1;
+        skips[b] = entry->doc_ids[last];
+        
+        max_tf[b] = 1;
+        for (int j = first; entry->positions && j <= last; j++) {
+            if (entry->positions[j].count > max_tf[b]) max_tf[b] = entry->positions[j].count;
+        }
+    }
+    
+    entry->skip_count = skip_count;
+}
+
+void build_posting_bitmap(BooleanIndex* index, IndexEntry* entry) {
+    if (!index || !entry) return;
+    
+    free_roaring(entry->bitmap);
+    entry->bitmap = nullptr;
+    
+    if (entry->doc_count >= SKIP_INTERVAL && 
+        (long)entry->doc_count * DENSE_POSTING_RATIO >= index->max_doc_id) {
+        entry->bitmap = roaring_from_sorted(entry->doc_ids, entry->doc_count);
+    }
+}
+
+void finalize_index(BooleanIndex* index) {
+    if (!index || index->mapped) return;
+    
+    for (int i = 0; i < index->count; i++) {
+        IndexEntry* entry = &index->entries[i];
+        if (entry->doc_count > 0 && entry->doc_ids[entry->doc_count - 1] > index->max_doc_id) {
+            index->max_doc_id = entry->doc_ids[entry->doc_count - 1];
+        }
+    }
+    
+    for (int i = 0; i < index->count; i++) {
+        build_skip_pointers(&index->entries[i]);
+        build_posting_bitmap(index, &index->entries[i]);
+    }
+}
+
+int intersect_into(const int* arr1, int count1, const int* arr2, int count2, int* out) {
+    if (count1 * (long)GALLOP_RATIO <= count2) {
+        return gallop_intersect(arr1, count1, arr2, count2, out);
+    }
+    if (count2 * (long)GALLOP_RATIO <= count1) {
+        return gallop_intersect(arr2, count2, arr1, count1, out);
+    }
+    return intersect_kernel(arr1, count1, arr2, count2, out);
+}
+
+int* intersect_sorted_arrays(int* arr1, int count1, int* arr2, int count2, int* result_count) {
+    if (!arr1 || !arr2 || count1 == 0 || count2 == 0) {
+        *result_count = 0;
+        return nullptr;
+    }
+    
+    int max_result = count1 < count2 ? count1 : count2;
+    int* result = (int*)malloc((max_result + SIMD_OUTPUT_SLACK) * sizeof(int));
+    if (!result) {
+        *result_count = 0;
+        return nullptr;
+    }
+    
+    int k = intersect_into(arr1, count1, arr2, count2, result);
+    
+    *result_count = k;
+    return shrink_result(result, k, max_result);
+}
+
+int intersect_list_with_entry(const int* doc_ids, int count, IndexEntry* entry, int* out) {
+    if (!doc_ids || !entry || count == 0 || entry->doc_count == 0) return 0;
+    
+    if (entry->bitmap && count * (long)BITMAP_PROBE_RATIO <= entry->doc_count) {
+        return roaring_filter_array(entry->bitmap, doc_ids, count, out);
+    }
+    
+    bool skips_valid = entry->skip_count == (entry->doc_count + SKIP_INTERVAL - 1) / SKIP_INTERVAL;
+    if (skips_valid && count * (long)GALLOP_RATIO <= entry->doc_count) {
+        return skip_intersect(doc_ids, count, entry, out);
+    }
+    
+    return intersect_into(doc_ids, count, entry->doc_ids, entry->doc_count, out);
+}
+
+int* intersect_entries(IndexEntry* entry1, IndexEntry* entry2, int* result_count) {
+    *result_count = 0;
+    if (!entry1 || !entry2 || entry1->doc_count == 0 || entry2->doc_count == 0) return nullptr;
+    
+    IndexEntry* small = entry1->doc_count <= entry2->doc_count ? entry1 : entry2;
+    IndexEntry* large = small == entry1 ? entry2 : entry1;
+    
+    
+    bool skips_valid = large->skip_count == (large->doc_count + SKIP_INTERVAL - 1) / SKIP_INTERVAL;
+    if (!skips_valid || small->doc_count * (long)GALLOP_RATIO > large->doc_count) {
+        return intersect_sorted_arrays(entry1->doc_ids, entry1->doc_count, 
+                                       entry2->doc_ids, entry2->doc_count, result_count);
+    }
+    
+    int* result = (int*)malloc(small->doc_count * sizeof(int));
+    if (!result) return nullptr;
+    
+    *result_count = skip_intersect(small->doc_ids, small->doc_count, large, result);
+    return shrink_result(result, *result_count, small->doc_count);
+}
+
+
+int* union_sorted_arrays(int* arr1, int count1, int* arr2, int count2, int* result_count) {
+    int max_result = count1 + count2;
+    int* result = (int*)malloc((max_result + SIMD_OUTPUT_SLACK) * sizeof(int));
+    if (!result) {
+        *result_count = 0;
         return nullptr;
     }
     
+    int k = union_kernel(arr1, count1, arr2, count2, result);
+    
+    *result_count = k;
+    return shrink_result(result, k, max_result);
+}
+
+int* boolean_and(BooleanIndex* index, const char* term1, const char* term2, int* result_count) {
+    *result_count = 0;
+    
+    if (!index || !term1 || !term2) return nullptr;
+    
+    
+    IndexEntry* entry1 = find_term(index, term1);
+    IndexEntry* entry2 = find_term(index, term2);
+    
+    if (!entry1 || !entry2) return nullptr;
+    
+    
+    if (entry1->bitmap || entry2->bitmap) {
+        IndexEntry* small = entry1->doc_count <= entry2->doc_count ? entry1 : entry2;
+        IndexEntry* large = small == entry1 ? entry2 : entry1;
+        
+        int* result = (int*)malloc((small->doc_count + 1) * sizeof(int));
+        if (!result) return nullptr;
+        
+        if (small->bitmap && large->bitmap) {
+            *result_count = roaring_and_to_array(small->bitmap, large->bitmap, result);
+        } else if (large->bitmap) {
+            *result_count = roaring_filter_array(large->bitmap, small->doc_ids, small->doc_count, result);
+        } else {
+            *result_count = roaring_filter_array(small->bitmap, large->doc_ids, large->doc_count, result);
+        }
+        return shrink_result(result, *result_count, small->doc_count);
+    }
+    
+    return intersect_entries(entry1, entry2, result_count);
+}
+
+int* boolean_or(BooleanIndex* index, const char* term1, const char* term2, int* result_count) {
+    *result_count = 0;
+    
+    if (!index || !term1 || !term2) return nullptr;
+    
+    
+    IndexEntry* entry1 = find_term(index, term1);
+    IndexEntry* entry2 = find_term(index, term2);
+    
+    if (!entry1 && !entry2) return nullptr;
+    
+    
+    if (!entry1) {
+        int* result = (int*)malloc(entry2->doc_count * sizeof(int));
+        if (!result) return nullptr;
+        
+        memcpy(result, entry2->doc_ids, entry2->doc_count * sizeof(int));
+        *result_count = entry2->doc_count;
+        return result;
+    }
+    
+    if (!entry2) {
+        int* result = (int*)malloc(entry1->doc_count * sizeof(int));
+        if (!result) return nullptr;
+        
+        memcpy(result, entry1->doc_ids, entry1->doc_count * sizeof(int));
+        *result_count = entry1->doc_count;
+        return result;
+    }
+    
+    
+    if (entry1->bitmap && entry2->bitmap) {
+        int max_result = entry1->doc_count + entry2->doc_count;
+        int* result = (int*)malloc(max_result * sizeof(int));
+        if (!result) return nullptr;
+        
+        *result_count = roaring_or_to_array(entry1->bitmap, entry2->bitmap, result);
+        return shrink_result(result, *result_count, max_result);
+    }
+    
+    return union_sorted_arrays(entry1->doc_ids, entry1->doc_count,
+                               entry2->doc_ids, entry2->doc_count,
+                               result_count);
+}
+
+int* boolean_not(BooleanIndex* index, const char* term, DocumentCollection* docs, int* result_count) {
+    *result_count = 0;
+    
+    if (!index || !term) return nullptr;
+    
+    
+    int universe = docs ? docs->count : index->max_doc_id;
+    if (universe <= 0) return nullptr;
+    
+    int* result = (int*)malloc(universe * sizeof(int));
+    if (!result) return nullptr;
+    
+    IndexEntry* entry = find_term(index, term);
+    int k = 0;
+    
+    if (entry && entry->bitmap) {
+        k = roaring_complement_to_array(entry->bitmap, universe, result);
+    } else {
+        int j = 0;
+        int doc_count = entry ? entry->doc_count : 0;
+        
+        for (int doc_id = 1; doc_id <= universe; doc_id++) {
+            if (j < doc_count && entry->doc_ids[j] == doc_id) {
+                j++;
+            } else {
+                result[k++] = doc_id;
+            }
+        }
+    }
+    
+    *result_count = k;
+    return shrink_result(result, k, universe);
+}
+
+typedef struct {
+    IndexEntry* entry;
+    int offset;
+    int doc_cursor;
+    const int* positions;
+    int position_count;
+} PositionalTerm;
+
+
+typedef bool (*PositionMatcher)(PositionalTerm* terms, int term_count, int distance);
+
+static bool positional_term_rarer(const PositionalTerm& a, const PositionalTerm& b) {
+    return a.entry->doc_count < b.entry->doc_count;
+}
+
+static bool match_phrase_positions(PositionalTerm* terms, int term_count, int distance) {
+    (void)distance;
+    
+    int anchor = 0;
+    int cursors[POSITIONAL_MAX_TERMS];
+    for (int t = 0; t < term_count; t++) {
+        cursors[t] = 0;
+        if (terms[t].position_count < terms[anchor].position_count) anchor = t;
+    }
+    
+    for (int i = 0; i < terms[anchor].position_count; i++) {
+        int start = terms[anchor].positions[i] - terms[anchor].offset;
+        bool matched = true;
+        
+        for (int t = 0; t < term_count && matched; t++) {
+            if (t == anchor) continue;
+            int target = start + terms[t].offset;
+            const int* positions = terms[t].positions;
+            while (cursors[t] < terms[t].position_count && positions[cursors[t]] < target) cursors[t]++;
+            if (cursors[t] == terms[t].position_count) return false;
+            matched = terms[t].positions[cursors[t]] == target;
+        }
+        
+        if (matched) return true;
+    }
+    
+    return false;
+}
+
+static bool match_near_positions(PositionalTerm* terms, int term_count, int distance) {
+    int cursors[POSITIONAL_MAX_TERMS];
+    for (int t = 0; t < term_count; t++) {
+        cursors[t] = 0;
+    }
+    
+    
+    while (true) {
+        int low = 0;
+        int high = 0;
+        for (int t = 1; t < term_count; t++) {
+            if (terms[t].positions[cursors[t]] < terms[low].positions[cursors[low]]) low = t;
+            if (terms[t].positions[cursors[t]] > terms[high].positions[cursors[high]]) high = t;
+        }
+        
+        int window_end = terms[high].positions[cursors[high]];
+        if (window_end - terms[low].positions[cursors[low]] <= distance) return true;
+        
+        const int* positions = terms[low].positions;
+        int target = window_end - distance;
+        while (cursors[low] < terms[low].position_count && positions[cursors[low]] < target) cursors[low]++;
+        if (cursors[low] == terms[low].position_count) return false;
+    }
+}
+
+static int lookup_positional_terms(BooleanIndex* index, const char* text, PositionalTerm* terms) {
+    TokenArray tokens = tokenize_text(text);
+    if (tokens.count == 0 || tokens.count > POSITIONAL_MAX_TERMS) {
+        free_tokens(&tokens);
+        return 0;
+    }
+    
+    int term_count = tokens.count;
+    for (int i = 0; i < term_count && term_count > 0; i++) {
+        terms[i].entry = find_term(index, tokens.tokens[i]);
+        terms[i].offset = i;
+        terms[i].doc_cursor = 0;
+        if (!terms[i].entry || !decode_entry_positions(index, terms[i].entry)) term_count = 0;
+    }
+    
+    free_tokens(&tokens);
+    return term_count;
+}
+
+static int unique_positional_terms(PositionalTerm* terms, int term_count) {
+    int unique_count = 0;
+    for (int i = 0; i < term_count; i++) {
+        bool repeated = false;
+        for (int j = 0; j < unique_count && !repeated; j++) {
+            repeated = terms[j].entry == terms[i].entry;
+        }
+        if (!repeated) terms[unique_count++] = terms[i];
+    }
+    return unique_count;
+}
+
+static int* match_positional_terms(PositionalTerm* terms, int term_count, int distance, 
+                                   PositionMatcher match, int* result_count) {
+    std::stable_sort(terms, terms + term_count, positional_term_rarer);
+    
+    int candidate_count = 0;
+    int* candidates = nullptr;
+    if (term_count == 1) {
+        candidates = (int*)malloc(terms[0].entry->doc_count * sizeof(int));
+        if (!candidates) return nullptr;
+        memcpy(candidates, terms[0].entry->doc_ids, terms[0].entry->doc_count * sizeof(int));
+        candidate_count = terms[0].entry->doc_count;
+    } else {
+        candidates = intersect_entries(terms[0].entry, terms[1].entry, &candidate_count);
+    }
+    
+    for (int t = 2; t < term_count && candidates; t++) {
+        int* narrowed = intersect_sorted_arrays(candidates, candidate_count, terms[t].entry->doc_ids, 
+                                                terms[t].entry->doc_count, &candidate_count);
+        free(candidates);
+        candidates = narrowed;
+    }
+    if (!candidates) return nullptr;
+    
+    
+    int count = 0;
+    for (int i = 0; i < candidate_count; i++) {
+        for (int t = 0; t < term_count; t++) {
+            IndexEntry* entry = terms[t].entry;
+            terms[t].doc_cursor = gallop_to(entry->doc_ids, terms[t].doc_cursor, entry->doc_count, candidates[i]);
+            terms[t].positions = entry->positions[terms[t].doc_cursor].positions;
+            terms[t].position_count = entry->positions[terms[t].doc_cursor].count;
+        }
+        
+        if (match(terms, term_count, distance)) {
+            candidates[count++] = candidates[i];
+        }
+    }
+    
+    *result_count = count;
+    return shrink_result(candidates, count, candidate_count);
+}
+
+int* phrase_search(BooleanIndex* index, const char* phrase, int* result_count) {
+    *result_count = 0;
+    
+    if (!index || !phrase) return nullptr;
+    
+    PositionalTerm terms[POSITIONAL_MAX_TERMS];
+    int term_count = lookup_positional_terms(index, phrase, terms);
+    if (term_count == 0) return nullptr;
+    
+    return match_positional_terms(terms, term_count, 0, match_phrase_positions, result_count);
+}
+
+int* near_search(BooleanIndex* index, const char* terms_text, int distance, int* result_count) {
+    *result_count = 0;
+    
+    if (!index || !terms_text || distance < 0) return nullptr;
+    
+    PositionalTerm terms[POSITIONAL_MAX_TERMS];
+    int term_count = unique_positional_terms(terms, lookup_positional_terms(index, terms_text, terms));
+    if (term_count == 0) return nullptr;
+    
+    return match_positional_terms(terms, term_count, distance, match_near_positions, result_count);
+}
+
+struct PositionalCursor {
+    PositionalTerm terms[POSITIONAL_MAX_TERMS];
+    int term_count;
+    int distance;
+    PositionMatcher match;
+};
+
+static PositionalCursor* open_positional_cursor(PositionalTerm* terms, int term_count, int distance, 
+                                                PositionMatcher match) {
+    if (term_count == 0) return nullptr;
+    
+    PositionalCursor* cursor = (PositionalCursor*)malloc(sizeof(PositionalCursor));
+    if (!cursor) return nullptr;
+    
+    memcpy(cursor->terms, terms, term_count * sizeof(PositionalTerm));
+    std::stable_sort(cursor->terms, cursor->terms + term_count, positional_term_rarer);
+    cursor->term_count = term_count;
+    cursor->distance = distance;
+    cursor->match = match;
+    return cursor;
+}
+
+PositionalCursor* open_phrase_cursor(BooleanIndex* index, const char* phrase) {
+    if (!index || !phrase) return nullptr;
+    
+    PositionalTerm terms[POSITIONAL_MAX_TERMS];
+    int term_count = lookup_positional_terms(index, phrase, terms);
+    return open_positional_cursor(terms, term_count, 0, match_phrase_positions);
+}
+
+PositionalCursor* open_near_cursor(BooleanIndex* index, const char* terms_text, int distance) {
+    if (!index || !terms_text || distance < 0) return nullptr;
+    
+    PositionalTerm terms[POSITIONAL_MAX_TERMS];
+    int term_count = unique_positional_terms(terms, lookup_positional_terms(index, terms_text, terms));
+    return open_positional_cursor(terms, term_count, distance, match_near_positions);
+}
+
+int positional_cursor_advance(PositionalCursor* cursor, int target) {
+    PositionalTerm* terms = cursor->terms;
+    int candidate = target;
+    
+    while (true) {
+        bool aligned = true;
+        for (int t = 0; t < cursor->term_count && aligned; t++) {
+            IndexEntry* entry = terms[t].entry;
+            terms[t].doc_cursor = gallop_to(entry->doc_ids, terms[t].doc_cursor, entry->doc_count, candidate);
+            if (terms[t].doc_cursor == entry->doc_count) return CURSOR_END;
+            
+            int doc_id = entry->doc_ids[terms[t].doc_cursor];
+            aligned = doc_id == candidate;
+            candidate = doc_id;
+        }
+        if (!aligned) continue;
+        
+        
+        for (int t = 0; t < cursor->term_count; t++) {
+            PositionList* list = &terms[t].entry->positions[terms[t].doc_cursor];
+            terms[t].positions = list->positions;
+            terms[t].position_count = list->count;
+        }
+        if (cursor->match(terms, cursor->term_count, cursor->distance)) return candidate;
+        candidate++;
+    }
+}
+
+void close_positional_cursor(PositionalCursor* cursor) {
+    free(cursor);
+}
+
+static void free_entry(IndexEntry* entry) {
+    free(entry->term);
+    
+    if (entry->positions) {
+        for (int j = 0; j < entry->doc_count; j++) {
+            free(entry->positions[j].positions);
+        }
+        free(entry->positions);
+    }
+    
+    free(entry->doc_ids);
+    free(entry->skip_doc_ids);
+    free(entry->skip_max_tf);
+    free_roaring(entry->bitmap);
+    
+    init_entry(entry);
+}
+
+static void write_index_header(ByteWriter* writer, int term_count) {
+    put_bytes(writer, INDEX_MAGIC, 4);
+    put_uint32(writer, INDEX_STREAM_VERSION);
+    put_uint32(writer, term_count);
+}
+
+static void write_term_header(ByteWriter* writer, const char* term, int doc_count) {
+    int term_len = strlen(term);
+    put_vbyte(writer, term_len);
+    put_bytes(writer, term, term_len);
+    put_vbyte(writer, doc_count);
+}
+
+static void write_doc_ids(ByteWriter* writer, const int* doc_ids, int doc_count) {
+    if (doc_count == 0) return;
+    
+    const PostingCodec* codec = choose_posting_codec(doc_ids, doc_count);
+    unsigned char* encoded = (unsigned char*)malloc(codec->max_encoded_size(doc_count, doc_ids[doc_count - 1]));
+    if (!encoded) {
+        writer->error = 1;
+        return;
+    }
+    
+    size_t length = codec->encode(doc_ids, doc_count, encoded);
+    put_vbyte(writer, codec->id);
+    put_vbyte(writer, (unsigned int)length);
+    put_bytes(writer, encoded, length);
+    
+    free(encoded);
+}
+
+static void write_positions(ByteWriter* writer, IndexEntry* entry) {
+    for (int j = 0; j < entry->doc_count; j++) {
+        PositionList* pos_list = &entry->positions[j];
+        put_vbyte(writer, pos_list->count);
+        
+        int prev_pos = 0;
+        for (int k = 0; k < pos_list->count; k++) {
+            put_vbyte(writer, pos_list->positions[k] - prev_pos);
+            prev_pos = pos_list->positions[k];
+        }
+    }
+}
+
+static void write_entry(ByteWriter* writer, IndexEntry* entry) {
+    write_term_header(writer, entry->term, entry->doc_count);
+    write_doc_ids(writer, entry->doc_ids, entry->doc_count);
+    write_positions(writer, entry);
+}
+
+typedef struct {
+    FILE* file;
+    ByteReader reader;
+    int version;
+    int remaining;
+} IndexStream;
+
+static int open_index_stream(const char* filename, IndexStream* stream, size_t buffer_size) {
+    stream->file = fopen(filename, "rb");
+    if (!stream->file) return 0;
+    
+    if (init_byte_reader_sized(&stream->reader, stream->file, buffer_size) != 0) {
+        fclose(stream->file);
+        return 0;
+    }
+    
+    
+    unsigned char magic[4];
+    unsigned int value = 0;
+    int ok = get_bytes(&stream->reader, magic, 4);
+    
+    if (ok && memcmp(magic, INDEX_MAGIC, 4) == 0) {
+        ok = get_uint32(&stream->reader, &value) && value >= 2 && value <= INDEX_STREAM_VERSION;
+        stream->version = value;
+        ok = ok && get_uint32(&stream->reader, &value);
+    } else {
+        stream->version = 1;
+        value = magic[0] | (magic[1] << 8) | (magic[2] << 16) | ((unsigned int)magic[3] << 24);
+    }
+    
+    stream->remaining = (int)value;
+    if (!ok || stream->remaining < 0) {
+        free_byte_reader(&stream->reader);
+        fclose(stream->file);
+        return 0;
+    }
+    
+    return 1;
+}
+
+static void close_index_stream(IndexStream* stream) {
+    free_byte_reader(&stream->reader);
+    fclose(stream->file);
+    stream->file = nullptr;
+}
+
+static int read_int(IndexStream* stream, int* value) {
+    unsigned int raw;
+    int ok = stream->version == 1 ? get_uint32(&stream->reader, &raw) 
+                                  : get_vbyte(&stream->reader, &raw);
+    *value = (int)raw;
+    return ok && *value >= 0;
+}
+
+static int read_doc_ids(IndexStream* stream, int* doc_ids, int doc_count) {
+    int codec_id, length;
+    if (!read_int(stream, &codec_id) || !read_int(stream, &length)) return 0;
+    
+    const PostingCodec* codec = get_posting_codec(codec_id);
+    if (!codec) return 0;
+    
+    
+    unsigned char* encoded = (unsigned char*)malloc(length + 16);
+    if (!encoded) return 0;
+    memset(encoded + length, 0, 16);
+    
+    int ok = get_bytes(&stream->reader, encoded, length) &&
+             codec->decode(encoded, encoded + length, doc_count, doc_ids) == (size_t)length;
+    
+    free(encoded);
+    return ok;
+}
+
+static int read_entry(IndexStream* stream, IndexEntry* entry) {
+    init_entry(entry);
+    
+    
+    int term_len;
+    if (!read_int(stream, &term_len)) return 0;
+    
+    entry->term = (char*)malloc(term_len + 1);
+    if (!entry->term) return 0;
+    
+    if (!get_bytes(&stream->reader, entry->term, term_len)) return 0;
+    entry->term[term_len] = '\0';
+    
+    
+    int doc_count;
+    if (!read_int(stream, &doc_count)) return 0;
+    
+    if (doc_count == 0) return 1;
+    
+    
+    entry->doc_ids = (int*)malloc(doc_count * sizeof(int));
+    entry->positions = (PositionList*)malloc(doc_count * sizeof(PositionList));
+    if (!entry->doc_ids || !entry->positions) return 0;
+    
+    entry->capacity = doc_count;
+    
+    if (stream->version >= 3 && !read_doc_ids(stream, entry->doc_ids, doc_count)) return 0;
+    
+    int delta = stream->version == 1 ? 0 : 1;
+    int prev_doc = 0;
+    
+    for (int j = 0; j < doc_count; j++) {
+        
+        int pos_count;
+        if (stream->version < 3) {
+            int doc_id;
+            if (!read_int(stream, &doc_id)) return 0;
+            
+            prev_doc = doc_id + prev_doc * delta;
+            entry->doc_ids[j] = prev_doc;
+        }
+        if (!read_int(stream, &pos_count)) return 0;
+        
+        entry->positions[j].positions = nullptr;
+        entry->positions[j].count = pos_count;
+        entry->positions[j].capacity = pos_count;
+        entry->doc_count = j + 1;
+        
+        if (pos_count == 0) continue;
+        
+        int* positions = (int*)malloc(pos_count * sizeof(int));
+        if (!positions) return 0;
+        entry->positions[j].positions = positions;
+        
+        int prev_pos = 0;
+        for (int k = 0; k < pos_count; k++) {
+            if (!read_int(stream, &positions[k])) return 0;
+            positions[k] += prev_pos * delta;
+            prev_pos = positions[k];
+        }
+    }
+    
+    return 1;
+}
+
+static int write_index_file(IndexEntry* entries, int count, const int* order, const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) return -1;
+    
+    ByteWriter writer;
+    if (init_byte_writer(&writer, file) != 0) {
+        fclose(file);
+        return -1;
+    }
+    
+    write_index_header(&writer, count);
+    
+    for (int i = 0; i < count; i++) {
+        write_entry(&writer, &entries[order ? order[i] : i]);
+    }
+    
+    int status = flush_byte_writer(&writer);
+    free_byte_writer(&writer);
+    if (fclose(file) != 0) status = -1;
+    return status;
+}
+
+static char* side_file_name(const char* filename, const char* suffix, int number) {
+    size_t len = strlen(filename) + strlen(suffix) + 16;
+    char* name = (char*)malloc(len);
+    if (name) {
+        snprintf(name, len, number >= 0 ? "%s%s%d" : "%s%s", filename, suffix, number);
+    }
+    return name;
+}
+
+typedef struct {
+    FILE* file;
+    ByteWriter writer;
+    const char* filename;
+    char* tmp_path;
+    ByteWriter spools[SPOOL_COUNT];
+    unsigned long long spooled[SPOOL_COUNT];
+    int count;
+    unsigned long long strings_length;
+    unsigned long long offset;
+    int max_doc_id;
+    char* term;
+    size_t term_capacity;
+    unsigned int doc_count;
+    unsigned int position_count;
+    int chunk_count;
+    int chunk_base;
+    int spooling;
+    int* doc_ids;
+    int* tfs;
+    int postings_capacity;
+    unsigned char* bytes;
+    size_t bytes_length;
+    size_t bytes_capacity;
+} MappedIndexWriter;
+
+static void put_offset(ByteWriter* writer, unsigned long long value) {
+    put_uint32(writer, (unsigned int)value);
+    put_uint32(writer, (unsigned int)(value >> 32));
+}
+
+static void write_mapped_header(ByteWriter* writer, int term_count, int max_doc_id, 
+                                unsigned long long terms_offset, unsigned long long strings_offset, 
+                                unsigned long long strings_size, int document_count, 
+                                unsigned long long documents_offset) {
+    put_bytes(writer, INDEX_MAGIC, 4);
+    put_uint32(writer, INDEX_MAPPED_VERSION);
+    put_uint32(writer, term_count);
+    put_uint32(writer, max_doc_id);
+    put_offset(writer, terms_offset);
+    put_offset(writer, strings_offset);
+    put_offset(writer, strings_size);
+    put_uint32(writer, document_count);
+    put_uint32(writer, 0);
+    put_offset(writer, documents_offset);
+}
+
+static int open_mapped_writer(MappedIndexWriter* mapped, const char* filename) {
+    memset(mapped, 0, sizeof(MappedIndexWriter));
+    mapped->filename = filename;
+    mapped->tmp_path = side_file_name(filename, ".tmp", -1);
+    
+    mapped->file = mapped->tmp_path ? fopen(mapped->tmp_path, "wb") : nullptr;
+    if (!mapped->file || init_byte_writer(&mapped->writer, mapped->file) != 0) {
+        if (mapped->file) {
+            fclose(mapped->file);
+            remove(mapped->tmp_path);
+        }
+        free(mapped->tmp_path);
+        return -1;
+    }
+    
+    write_mapped_header(&mapped->writer, 0, 0, 0, 0, 0, 0, 0);
+    mapped->offset = INDEX_MAPPED_HEADER_SIZE;
+    return 0;
+}
+
+static ByteWriter* mapped_spool(MappedIndexWriter* mapped, int spool) {
+    ByteWriter* writer = &mapped->spools[spool];
+    if (writer->file || writer->error) return writer;
+    
+    char* name = side_file_name(mapped->filename, ".spool", spool);
+    FILE* file = name ? fopen(name, "w+b") : nullptr;
+    free(name);
+    if (!file || init_byte_writer_sized(writer, file, SPOOL_BUFFER) != 0) {
+        if (file) fclose(file);
+        writer->file = nullptr;
+        writer->error = 1;
+    }
+    return writer;
+}
+
+static void spool_bytes(MappedIndexWriter* mapped, int spool, const void* bytes, size_t count) {
+    put_bytes(mapped_spool(mapped, spool), bytes, count);
+    mapped->spooled[spool] += count;
+}
+
+static void spool_uint32(MappedIndexWriter* mapped, int spool, unsigned int value) {
+    put_uint32(mapped_spool(mapped, spool), value);
+    mapped->spooled[spool] += 4;
+}
+
+static int copy_spool(MappedIndexWriter* mapped, int spool) {
+    ByteWriter* writer = &mapped->spools[spool];
+    unsigned long long remaining = mapped->spooled[spool];
+    mapped->spooled[spool] = 0;
+    if (remaining == 0) return 0;
+    if (flush_byte_writer(writer) != 0 || fseek(writer->file, 0, SEEK_SET) != 0) return -1;
+    
+    
+    while (remaining > 0) {
+        size_t chunk = remaining < writer->capacity ? (size_t)remaining : writer->capacity;
+        if (fread(writer->data, 1, chunk, writer->file) != chunk) return -1;
+        put_bytes(&mapped->writer, writer->data, chunk);
+        remaining -= chunk;
+    }
+    
+    return fseek(writer->file, 0, SEEK_SET) == 0 && !mapped->writer.error ? 0 : -1;
+}
+
+static int add_mapped_term(MappedIndexWriter* mapped, const char* term, MappedTerm* info) {
+    size_t size = strlen(term) + 1;
+    if (mapped->count == INT_MAX || mapped->strings_length + size > UINT_MAX) return -1;
+    
+    info->term_offset = (unsigned int)mapped->strings_length;
+    info->postings_offset = mapped->offset;
+    spool_bytes(mapped, SPOOL_STRINGS, term, size);
+    mapped->strings_length += size;
+    
+    spool_uint32(mapped, SPOOL_TERMS, info->term_offset);
+    spool_uint32(mapped, SPOOL_TERMS, info->doc_count);
+    spool_uint32(mapped, SPOOL_TERMS, info->position_count);
+    spool_uint32(mapped, SPOOL_TERMS, info->codec);
+    spool_uint32(mapped, SPOOL_TERMS, (unsigned int)info->postings_offset);
+    spool_uint32(mapped, SPOOL_TERMS, (unsigned int)(info->postings_offset >> 32));
+    spool_uint32(mapped, SPOOL_TERMS, info->doc_bytes);
+    spool_uint32(mapped, SPOOL_TERMS, info->tf_bytes);
+    spool_uint32(mapped, SPOOL_TERMS, info->position_bytes);
+    spool_uint32(mapped, SPOOL_TERMS, info->reserved);
+    mapped->count++;
+    
+    return mapped->spools[SPOOL_STRINGS].error || mapped->spools[SPOOL_TERMS].error ? -1 : 0;
+}
+
+static int reserve_postings(MappedIndexWriter* mapped, unsigned int doc_count) {
+    if (doc_count <= (unsigned int)mapped->postings_capacity) return 0;
+    if (doc_count > INT_MAX / 2) return -1;
+    
+    int capacity = mapped->postings_capacity == 0 ? 1024 : mapped->postings_capacity;
+    while ((unsigned int)capacity < doc_count) capacity *= 2;
+    
+    int* doc_ids = (int*)realloc(mapped->doc_ids, capacity * sizeof(int));
+    if (doc_ids) mapped->doc_ids = doc_ids;
+    int* tfs = (int*)realloc(mapped->tfs, capacity * sizeof(int));
+    if (tfs) mapped->tfs = tfs;
+    if (!doc_ids || !tfs) return -1;
+    
+    mapped->postings_capacity = capacity;
+    return 0;
+}
+
+static int reserve_bytes(MappedIndexWriter* mapped, size_t extra) {
+    if (mapped->bytes_length + extra <= mapped->bytes_capacity) return 0;
+    
+    size_t capacity = mapped->bytes_capacity == 0 ? 4096 : mapped->bytes_capacity;
+    while (capacity < mapped->bytes_length + extra) capacity *= 2;
+    
+    unsigned char* bytes = (unsigned char*)realloc(mapped->bytes, capacity);
+    if (!bytes) return -1;
+    mapped->bytes = bytes;
+    mapped->bytes_capacity = capacity;
+    return 0;
+}
+
+static unsigned int append_vbyte(unsigned char* out, unsigned int value) {
+    unsigned int length = 0;
+    while (value >= 0x80) {
+        out[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+    return length;
+}
+
+static int write_mapped_postings(MappedIndexWriter* mapped, const char* term, unsigned int doc_count, 
+                                 unsigned int position_count) {
+    const int* doc_ids = mapped->doc_ids;
+    const int* tfs = mapped->tfs;
+    size_t position_bytes = mapped->bytes_length;
+    if (doc_count == 0) return 0;
+    if (doc_ids[doc_count - 1] > mapped->max_doc_id) mapped->max_doc_id = doc_ids[doc_count - 1];
+    
+    
+    const PostingCodec* codec = choose_posting_codec(doc_ids, doc_count);
+    size_t doc_limit = codec->max_encoded_size(doc_count, doc_ids[doc_count - 1]);
+    if (reserve_bytes(mapped, doc_limit + (size_t)doc_count * 5) != 0) return -1;
+    
+    unsigned char* doc_block = mapped->bytes + position_bytes;
+    size_t doc_bytes = codec->encode(doc_ids, doc_count, doc_block);
+    unsigned char* tf_block = doc_block + doc_bytes;
+    size_t tf_bytes = 0;
+    for (unsigned int j = 0; j < doc_count; j++) {
+        tf_bytes += append_vbyte(tf_block + tf_bytes, tfs[j]);
+    }
+    
+    MappedTerm info;
+    memset(&info, 0, sizeof(MappedTerm));
+    info.doc_count = doc_count;
+    info.position_count = position_count;
+    info.codec = codec->id;
+    info.doc_bytes = (unsigned int)doc_bytes;
+    info.tf_bytes = (unsigned int)tf_bytes;
+    info.position_bytes = (unsigned int)position_bytes;
+    if (doc_bytes > UINT_MAX || position_bytes > UINT_MAX || add_mapped_term(mapped, term, &info) != 0) return -1;
+    
+    
+    int skip_count = skip_count_for(doc_count);
+    for (int b = 0; b < skip_count; b++) {
+        unsigned int last = (b + 1) * SKIP_INTERVAL - 1;
+        put_uint32(&mapped->writer, doc_ids[last < doc_count ? last : doc_count - 1]);
+    }
+    for (int b = 0; b < skip_count; b++) {
+        int max_tf = 1;
+        for (unsigned int j = b * SKIP_INTERVAL; j < doc_count && j < (unsigned int)(b + 1) * SKIP_INTERVAL; j++) {
+            if (tfs[j] > max_tf) max_tf = tfs[j];
+        }
+        put_uint32(&mapped->writer, max_tf);
+    }
+    
+    put_bytes(&mapped->writer, doc_block, doc_bytes + tf_bytes);
+    put_bytes(&mapped->writer, mapped->bytes, position_bytes);
+    
+    unsigned long long length = skip_count * 2ULL * sizeof(int) + doc_bytes + tf_bytes + position_bytes;
+    static const char padding[4] = {0};
+    put_bytes(&mapped->writer, padding, (4 - length % 4) % 4);
+    mapped->offset += (length + 3) & ~3ULL;
+    
+    mapped->bytes_length = 0;
+    return mapped->writer.error ? -1 : 1;
+}
+
+static int write_mapped_term(MappedIndexWriter* mapped, const char* term, IndexEntry** parts, int part_count) {
+    unsigned int doc_count = 0;
+    unsigned int position_count = 0;
+    
+    for (int p = 0; p < part_count; p++) {
+        doc_count += parts[p]->doc_count;
+    }
+    if (doc_count == 0) return 0;
+    if (reserve_postings(mapped, doc_count) != 0) return -1;
+    
+    
+    mapped->bytes_length = 0;
+    unsigned int k = 0;
+    for (int p = 0; p < part_count; p++) {
+        for (int j = 0; j < parts[p]->doc_count; j++, k++) {
+            PositionList* pos_list = &parts[p]->positions[j];
+            mapped->doc_ids[k] = parts[p]->doc_ids[j];
+            mapped->tfs[k] = pos_list->count;
+            position_count += pos_list->count;
+            
+            if (reserve_bytes(mapped, (size_t)pos_list->count * 5) != 0) return -1;
+            int prev_pos = 0;
+            for (int c = 0; c < pos_list->count; c++) {
+                mapped->bytes_length += append_vbyte(mapped->bytes + mapped->bytes_length, pos_list->positions[c] - prev_pos);
+                prev_pos = pos_list->positions[c];
+            }
+        }
+    }
+    
+    return write_mapped_postings(mapped, term, doc_count, position_count);
+}
+
+static int begin_mapped_term(MappedIndexWriter* mapped, const char* term) {
+    size_t size = strlen(term) + 1;
+    if (size > mapped->term_capacity) {
+        char* grown = (char*)realloc(mapped->term, size);
+        if (!grown) return -1;
+        mapped->term = grown;
+        mapped->term_capacity = size;
+    }
+    memcpy(mapped->term, term, size);
+    
+    mapped->doc_count = 0;
+    mapped->position_count = 0;
+    mapped->chunk_count = 0;
+    mapped->chunk_base = 0;
+    mapped->spooling = 0;
+    mapped->bytes_length = 0;
+    return reserve_postings(mapped, MERGE_CHUNK_POSTINGS);
+}
+
+static int spool_mapped_chunk(MappedIndexWriter* mapped, int flush_postings) {
+    mapped->spooling = 1;
+    spool_bytes(mapped, SPOOL_POSITIONS, mapped->bytes, mapped->bytes_length);
+    mapped->bytes_length = 0;
+    
+    int count = flush_postings ? mapped->chunk_count : 0;
+    int* doc_ids = mapped->doc_ids;
+    const int* tfs = mapped->tfs;
+    for (int b = 0; b < skip_count_for(count); b++) {
+        int last = std::min((b + 1) * SKIP_INTERVAL, count) - 1;
+        int max_tf = 1;
+        for (int j = b * SKIP_INTERVAL; j <= last; j++) {
+            if (tfs[j] > max_tf) max_tf = tfs[j];
+        }
+        spool_uint32(mapped, SPOOL_SKIP_IDS, doc_ids[last]);
+        spool_uint32(mapped, SPOOL_SKIP_TFS, max_tf);
+    }
+    
+    
+    if (count > 0) {
+        const PostingCodec* codec = get_posting_codec(CODEC_BP128);
+        int last_doc = doc_ids[count - 1];
+        if (reserve_bytes(mapped, codec->max_encoded_size(count, last_doc) + (size_t)count * 5) != 0) return -1;
+        
+        for (int j = 0; j < count; j++) {
+            doc_ids[j] -= mapped->chunk_base;
+        }
+        spool_bytes(mapped, SPOOL_DOCS, mapped->bytes, codec->encode(doc_ids, count, mapped->bytes));
+        
+        size_t tf_bytes = 0;
+        for (int j = 0; j < count; j++) {
+            tf_bytes += append_vbyte(mapped->bytes + tf_bytes, tfs[j]);
+        }
+        spool_bytes(mapped, SPOOL_TFS, mapped->bytes, tf_bytes);
+        
+        if (last_doc > mapped->max_doc_id) mapped->max_doc_id = last_doc;
+        mapped->chunk_base = last_doc;
+        mapped->chunk_count = 0;
+    }
+    
+    for (int s = SPOOL_SKIP_IDS; s <= SPOOL_POSITIONS; s++) {
+        if (mapped->spools[s].error) return -1;
+    }
+    return 0;
+}
+
+static int add_mapped_posting(MappedIndexWriter* mapped, int doc_id, int tf) {
+    if (mapped->doc_count >= INT_MAX / 2) return -1;
+    
+    mapped->doc_ids[mapped->chunk_count] = doc_id;
+    mapped->tfs[mapped->chunk_count++] = tf;
+    mapped->doc_count++;
+    mapped->position_count += tf;
+    
+    int full = mapped->chunk_count == MERGE_CHUNK_POSTINGS;
+    if (full || mapped->bytes_length >= MERGE_CHUNK_BYTES) return spool_mapped_chunk(mapped, full);
+    return 0;
+}
+
+static int end_mapped_term(MappedIndexWriter* mapped) {
+    if (!mapped->spooling) return write_mapped_postings(mapped, mapped->term, mapped->doc_count, mapped->position_count);
+    if (spool_mapped_chunk(mapped, 1) != 0) return -1;
+    
+    MappedTerm info;
+    memset(&info, 0, sizeof(MappedTerm));
+    info.doc_count = mapped->doc_count;
+    info.position_count = mapped->position_count;
+    info.codec = CODEC_BP128;
+    info.doc_bytes = (unsigned int)mapped->spooled[SPOOL_DOCS];
+    info.tf_bytes = (unsigned int)mapped->spooled[SPOOL_TFS];
+    info.position_bytes = (unsigned int)mapped->spooled[SPOOL_POSITIONS];
+    if (mapped->spooled[SPOOL_DOCS] > UINT_MAX || mapped->spooled[SPOOL_TFS] > UINT_MAX || 
+        mapped->spooled[SPOOL_POSITIONS] > UINT_MAX || add_mapped_term(mapped, mapped->term, &info) != 0) {
+        return -1;
+    }
+    
+    
+    unsigned long long length = 0;
+    for (int s = SPOOL_SKIP_IDS; s <= SPOOL_POSITIONS; s++) {
+        length += mapped->spooled[s];
+        if (copy_spool(mapped, s) != 0) return -1;
+    }
+    
+    static const char padding[4] = {0};
+    put_bytes(&mapped->writer, padding, (4 - length % 4) % 4);
+    mapped->offset += (length + 3) & ~3ULL;
+    return mapped->writer.error ? -1 : 1;
+}
+
+typedef struct {
+    const DocumentInfo* documents;
+    FILE* file;
+    ByteReader reader;
+    int count;
+    int next;
+    DocumentInfo current;
+    size_t title_capacity;
+    size_t path_capacity;
+} DocumentRecords;
+
+static void init_document_records(DocumentRecords* records, const DocumentInfo* documents, int count) {
+    memset(records, 0, sizeof(DocumentRecords));
+    records->documents = documents;
+    records->count = documents ? count : 0;
+}
+
+static int open_document_records(DocumentRecords* records, const char* filename, int count) {
+    memset(records, 0, sizeof(DocumentRecords));
+    records->file = fopen(filename, "rb");
+    if (!records->file) return -1;
+    
+    if (init_byte_reader(&records->reader, records->file) != 0) {
+        fclose(records->file);
+        records->file = nullptr;
+        return -1;
+    }
+    records->count = count;
+    return 0;
+}
+
+static void close_document_records(DocumentRecords* records) {
+    if (records->file) {
+        free_byte_reader(&records->reader);
+        fclose(records->file);
+    }
+    free(records->current.title);
+    free(records->current.path);
+    records->file = nullptr;
+    records->current.title = nullptr;
+    records->current.path = nullptr;
+}
+
+static int rewind_document_records(DocumentRecords* records) {
+    records->next = 0;
+    if (!records->file) return 0;
+    
+    free_byte_reader(&records->reader);
+    if (fseek(records->file, 0, SEEK_SET) != 0) return -1;
+    return init_byte_reader(&records->reader, records->file);
+}
+
+static int read_record_string(ByteReader* reader, char** str, size_t* capacity) {
+    unsigned int length = 0;
+    if (!get_uint32(reader, &length)) return 0;
+    
+    if (length + 1 > *capacity) {
+        char* grown = (char*)realloc(*str, length + 1);
+        if (!grown) return 0;
+        *str = grown;
+        *capacity = length + 1;
+    }
+    
+    if (!get_bytes(reader, *str, length)) return 0;
+    (*str)[length] = '\0';
+    return 1;
+}
+
+static const DocumentInfo* next_document_record(DocumentRecords* records) {
+    if (records->next >= records->count) return nullptr;
+    if (records->documents) return &records->documents[records->next++];
+    
+    unsigned int doc_id = 0;
+    unsigned int word_count = 0;
+    if (!get_uint32(&records->reader, &doc_id) || !get_uint32(&records->reader, &word_count) ||
+        !read_record_string(&records->reader, &records->current.title, &records->title_capacity) ||
+        !read_record_string(&records->reader, &records->current.path, &records->path_capacity)) {
+        return nullptr;
+    }
+    
+    records->current.doc_id = (int)doc_id;
+    records->current.word_count = (int)word_count;
+    records->next++;
+    return &records->current;
+}
+
+void put_document_record(ByteWriter* writer, const DocumentInfo* info) {
+    size_t title_length = info->title ? strlen(info->title) : 0;
+    size_t path_length = info->path ? strlen(info->path) : 0;
+    
+    put_uint32(writer, info->doc_id);
+    put_uint32(writer, info->word_count);
+    put_uint32(writer, (unsigned int)title_length);
+    put_bytes(writer, info->title, title_length);
+    put_uint32(writer, (unsigned int)path_length);
+    put_bytes(writer, info->path, path_length);
+}
+
+static int close_mapped_writer(MappedIndexWriter* mapped, DocumentRecords* documents, int status) {
+    int document_count = 0;
+    unsigned long long document_strings = 0;
+    
+    unsigned long long strings_offset = mapped->offset;
+    if (copy_spool(mapped, SPOOL_STRINGS) != 0) status = -1;
+    
+    const DocumentInfo* info = nullptr;
+    while (documents && (info = next_document_record(documents)) != nullptr) {
+        size_t title_size = strlen(info->title) + 1;
+        size_t path_size = strlen(info->path) + 1;
+        put_bytes(&mapped->writer, info->title, title_size);
+        put_bytes(&mapped->writer, info->path, path_size);
+        document_strings += title_size + path_size;
+        if (info->doc_id > mapped->max_doc_id) mapped->max_doc_id = info->doc_id;
+        document_count++;
+    }
+    if (documents && document_count != documents->count) status = -1;
+    
+    unsigned long long strings_size = mapped->strings_length + document_strings;
+    if (strings_size > UINT_MAX) status = -1;
+    
+    
+    unsigned long long terms_offset = (strings_offset + strings_size + 7) & ~7ULL;
+    static const char padding[8] = {0};
+    put_bytes(&mapped->writer, padding, terms_offset - strings_offset - strings_size);
+    
+    if (copy_spool(mapped, SPOOL_TERMS) != 0) status = -1;
+    
+    unsigned long long documents_offset = terms_offset + (unsigned long long)mapped->count * sizeof(MappedTerm);
+    unsigned long long string_offset = mapped->strings_length;
+    if (documents && rewind_document_records(documents) != 0) status = -1;
+    for (int i = 0; i < document_count && status == 0; i++) {
+        info = next_document_record(documents);
+        if (!info) {
+            status = -1;
+            break;
+        }
+        
+        size_t title_size = strlen(info->title) + 1;
+        put_uint32(&mapped->writer, info->doc_id);
+        put_uint32(&mapped->writer, info->word_count);
+        put_uint32(&mapped->writer, (unsigned int)string_offset);
+        put_uint32(&mapped->writer, (unsigned int)(string_offset + title_size));
+        string_offset += title_size + strlen(info->path) + 1;
+    }
+    
+    if (flush_byte_writer(&mapped->writer) != 0) status = -1;
+    
+    
+    if (fseek(mapped->file, 0, SEEK_SET) != 0) status = -1;
+    write_mapped_header(&mapped->writer, mapped->count, mapped->max_doc_id, 
+                        terms_offset, strings_offset, strings_size, 
+                        document_count, documents_offset);
+    if (flush_byte_writer(&mapped->writer) != 0) status = -1;
+    
+    free_byte_writer(&mapped->writer);
+    if (fclose(mapped->file) != 0) status = -1;
+    
+    for (int s = 0; s < SPOOL_COUNT; s++) {
+        if (!mapped->spools[s].file && !mapped->spools[s].error) continue;
+        if (mapped->spools[s].file) fclose(mapped->spools[s].file);
+        free_byte_writer(&mapped->spools[s]);
+        
+        char* name = side_file_name(mapped->filename, ".spool", s);
+        if (name) remove(name);
+        free(name);
+    }
+    
+    
+    if (status == 0) {
+#ifdef _WIN32
+        remove(mapped->filename);
+#endif
+        if (rename(mapped->tmp_path, mapped->filename) != 0) status = -1;
+    }
+    if (status != 0) remove(mapped->tmp_path);
+    
+    free(mapped->tmp_path);
+    free(mapped->term);
+    free(mapped->doc_ids);
+    free(mapped->tfs);
+    free(mapped->bytes);
+    
+    return status == 0 ? mapped->count : -1;
+}
+
+static int* sorted_term_order(BooleanIndex* index) {
+    int* order = (int*)malloc((index->count + 1) * sizeof(int));
+    if (!order) return nullptr;
+    
+    for (int i = 0; i < index->count; i++) {
+        order[i] = i;
+    }
+    
+    
+    if (!index->mapped) {
+        IndexEntry* entries = index->entries;
+        auto term_less = [entries](int a, int b) { return strcmp(entries[a].term, entries[b].term) < 0; };
+        if (!std::is_sorted(order, order + index->count, term_less)) {
+            std::sort(order, order + index->count, term_less);
+        }
+    }
+    
+    return order;
+}
+
+int save_index(BooleanIndex* index, const char* filename) {
+    if (!index || !filename) return -1;
+    
+    int* order = sorted_term_order(index);
+    if (!order) return -1;
+    
+    MappedIndexWriter mapped;
+    if (open_mapped_writer(&mapped, filename) != 0) {
+        free(order);
+        return -1;
+    }
+    
+    int status = 0;
+    for (int i = 0; i < index->count && status == 0; i++) {
+        IndexEntry* entry = index_entry_at(index, order[i]);
+        if (entry && !decode_entry_positions(index, entry)) status = -1;
+        if (entry && status == 0 && write_mapped_term(&mapped, entry->term, &entry, 1) < 0) status = -1;
+    }
     
     
+    DocumentInfo* documents = index->documents;
+    int document_count = index->document_count;
+    if (index->mapped) {
+        document_count = 0;
+        documents = (DocumentInfo*)malloc((index->mapped->document_count + 1) * sizeof(DocumentInfo));
+        for (int i = 0; documents && i < index->mapped->document_count; i++) {
+            if (get_document_info(index, index->mapped->documents[i].doc_id, &documents[document_count])) {
+                document_count++;
+            }
+        }
+        if (!documents) status = -1;
+    }
     
-    *result_count = current_count;
-    return current_result;
+    DocumentRecords records;
+    init_document_records(&records, documents, document_count);
+    if (close_mapped_writer(&mapped, &records, status) < 0) status = -1;
+    if (documents != index->documents) free(documents);
+    free(order);
+    return status;
 }
 
-void save_index(BooleanIndex* index, const char* filename) {
-    if (!index || !filename) return;
+int save_index_sorted(BooleanIndex* index, const char* filename) {
+    if (!index || !filename || index->mapped) return -1;
     
-    FILE* file = fopen(filename, "wb");
-    if (!file) return;
+    int* order = sorted_term_order(index);
+    if (!order) return -1;
+    
+    int status = write_index_file(index->entries, index->count, order, filename);
+    free(order);
+    return status;
+}
+
+typedef struct {
+    IndexStream stream;
+    int run;
+    char* term;
+    size_t term_capacity;
+    int doc_count;
+} RunReader;
+
+static bool run_reader_less(const RunReader* a, const RunReader* b) {
+    int cmp = strcmp(a->term, b->term);
+    return cmp < 0 || (cmp == 0 && a->run < b->run);
+}
+
+static void sift_down(RunReader** heap, int size, int i) {
+    while (true) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = 2 * i + 2;
+        
+        if (left < size && run_reader_less(heap[left], heap[smallest])) smallest = left;
+        if (right < size && run_reader_less(heap[right], heap[smallest])) smallest = right;
+        if (smallest == i) return;
+        
+        RunReader* tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static int advance_run(RunReader* reader) {
+    if (reader->stream.remaining == 0) return 0;
+    reader->stream.remaining--;
+    
+    int term_len = 0;
+    int ok = read_int(&reader->stream, &term_len);
+    if (ok && (size_t)term_len + 1 > reader->term_capacity) {
+        char* grown = (char*)realloc(reader->term, term_len + 1);
+        if (grown) {
+            reader->term = grown;
+            reader->term_capacity = term_len + 1;
+        }
+        ok = grown != nullptr;
+    }
     
+    ok = ok && get_bytes(&reader->stream.reader, reader->term, term_len) && 
+         read_int(&reader->stream, &reader->doc_count);
+    if (!ok) {
+        reader->stream.remaining = 0;
+        return -1;
+    }
+    
+    reader->term[term_len] = '\0';
+    return 1;
+}
+
+static int copy_run_postings(RunReader* reader, ByteWriter* output) {
+    IndexStream* stream = &reader->stream;
+    if (reader->doc_count == 0) return 0;
+    
+    int codec_id, length;
+    if (!read_int(stream, &codec_id) || !read_int(stream, &length)) return -1;
+    
+    write_term_header(output, reader->term, reader->doc_count);
+    put_vbyte(output, codec_id);
+    put_vbyte(output, length);
+    
+    unsigned char buffer[4096];
+    while (length > 0) {
+        int chunk = std::min(length, (int)sizeof(buffer));
+        if (!get_bytes(&stream->reader, buffer, chunk)) return -1;
+        put_bytes(output, buffer, chunk);
+        length -= chunk;
+    }
     
-    fwrite(&index->count, sizeof(int), 1, file);
     
-    for (int i = 0; i < index->count; i++) {
-        IndexEntry* entry = &index->entries[i];
+    for (int j = 0; j < reader->doc_count; j++) {
+        int pos_count;
+        if (!read_int(stream, &pos_count)) return -1;
+        put_vbyte(output, pos_count);
+        
+        for (int k = 0; k < pos_count; k++) {
+            int delta;
+            if (!read_int(stream, &delta)) return -1;
+            put_vbyte(output, delta);
+        }
+    }
+    
+    return output->error ? -1 : 1;
+}
+
+static int read_run_postings(RunReader* reader, MappedIndexWriter* mapped, int** doc_ids, int* capacity) {
+    IndexStream* stream = &reader->stream;
+    int doc_count = reader->doc_count;
+    if (doc_count == 0) return 0;
+    
+    if (doc_count > *capacity) {
+        int* grown = (int*)realloc(*doc_ids, doc_count * sizeof(int));
+        if (!grown) return -1;
+        *doc_ids = grown;
+        *capacity = doc_count;
+    }
+    if (!read_doc_ids(stream, *doc_ids, doc_count)) return -1;
+    
+    
+    for (int j = 0; j < doc_count; j++) {
+        int pos_count;
+        if (!read_int(stream, &pos_count) || reserve_bytes(mapped, (size_t)pos_count * 5) != 0) return -1;
+        
+        for (int k = 0; k < pos_count; k++) {
+            int delta;
+            if (!read_int(stream, &delta)) return -1;
+            mapped->bytes_length += append_vbyte(mapped->bytes + mapped->bytes_length, delta);
+        }
+        if (add_mapped_posting(mapped, (*doc_ids)[j], pos_count) != 0) return -1;
+    }
+    
+    return 1;
+}
+
+static int merge_run_pass(const char** run_files, int run_count, size_t buffer_size, 
+                          MappedIndexWriter* mapped, ByteWriter* output) {
+    RunReader* readers = (RunReader*)calloc(run_count + 1, sizeof(RunReader));
+    RunReader** heap = (RunReader**)malloc((run_count + 1) * sizeof(RunReader*));
+    RunReader** group = (RunReader**)malloc((run_count + 1) * sizeof(RunReader*));
+    char* term = nullptr;
+    size_t term_capacity = 0;
+    int* doc_ids = nullptr;
+    int doc_capacity = 0;
+    int heap_size = 0;
+    int written = 0;
+    int status = readers && heap && group ? 0 : -1;
+    
+    for (int r = 0; r < run_count && status == 0; r++) {
+        readers[r].run = r;
+        if (!open_index_stream(run_files[r], &readers[r].stream, buffer_size)) {
+            status = -1;
+            break;
+        }
         
+        int advanced = readers[r].stream.version == INDEX_STREAM_VERSION ? advance_run(&readers[r]) : -1;
+        if (advanced > 0) {
+            heap[heap_size++] = &readers[r];
+        } else if (advanced < 0) {
+            status = -1;
+        }
+    }
+    
+    for (int i = heap_size / 2 - 1; i >= 0; i--) {
+        sift_down(heap, heap_size, i);
+    }
+    
+    while (status == 0 && heap_size > 0) {
+        size_t size = strlen(heap[0]->term) + 1;
+        if (size > term_capacity) {
+            char* grown = (char*)realloc(term, size);
+            if (!grown) {
+                status = -1;
+                break;
+            }
+            term = grown;
+            term_capacity = size;
+        }
+        memcpy(term, heap[0]->term, size);
         
-        int term_len = strlen(entry->term);
-        fwrite(&term_len, sizeof(int), 1, file);
-        fwrite(entry->term, sizeof(char), term_len, file);
         
+        int group_size = 0;
+        do {
+            group[group_size++] = heap[0];
+            heap[0] = heap[--heap_size];
+            sift_down(heap, heap_size, 0);
+        } while (heap_size > 0 && strcmp(heap[0]->term, term) == 0);
         
-        fwrite(&entry->doc_count, sizeof(int), 1, file);
+        if (mapped && begin_mapped_term(mapped, term) != 0) status = -1;
         
         
-        for (int j = 0; j < entry->doc_count; j++) {
-            fwrite(&entry->doc_ids[j], sizeof(int), 1, file);
-            
-            
-            fwrite(&entry->positions[j].count, sizeof(int), 1, file);
-            
+        for (int g = 0; g < group_size && status == 0; g++) {
+            int advanced = 1;
+            while (status == 0 && advanced > 0 && strcmp(group[g]->term, term) == 0) {
+                int copied = mapped ? read_run_postings(group[g], mapped, &doc_ids, &doc_capacity) 
+                                    : copy_run_postings(group[g], output);
+                if (copied < 0) {
+                    status = -1;
+                } else {
+                    written += copied;
+                    advanced = advance_run(group[g]);
+                }
+            }
             
-            if (entry->positions[j].count > 0) {
-                fwrite(entry->positions[j].positions, sizeof(int), 
-                       entry->positions[j].count, file);
+            if (advanced < 0) status = -1;
+            if (status == 0 && advanced > 0) {
+                heap[heap_size] = group[g];
+                int i = heap_size++;
+                while (i > 0 && run_reader_less(heap[i], heap[(i - 1) / 2])) {
+                    RunReader* tmp = heap[i];
+                    heap[i] = heap[(i - 1) / 2];
+                    heap[(i - 1) / 2] = tmp;
+                    i = (i - 1) / 2;
+                }
             }
         }
+        
+        if (status == 0 && mapped && end_mapped_term(mapped) < 0) status = -1;
+    }
+    
+    for (int r = 0; readers && r < run_count; r++) {
+        free(readers[r].term);
+        if (readers[r].stream.file) close_index_stream(&readers[r].stream);
     }
     
-    fclose(file);
+    free(readers);
+    free(heap);
+    free(group);
+    free(term);
+    free(doc_ids);
+    return status == 0 ? written : -1;
 }
 
-BooleanIndex* load_index(const char* filename) {
-    if (!filename) return nullptr;
-    
-    FILE* file = fopen(filename, "rb");
-    if (!file) return nullptr;
+static int write_merged_run(const char** run_files, int run_count, size_t buffer_size, const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) return -1;
     
-    BooleanIndex* index = (BooleanIndex*)malloc(sizeof(BooleanIndex));
-    if (!index) {
+    ByteWriter writer;
+    if (init_byte_writer(&writer, file) != 0) {
         fclose(file);
-        return nullptr;
+        return -1;
     }
     
+    write_index_header(&writer, 0);
+    int count = merge_run_pass(run_files, run_count, buffer_size, nullptr, &writer);
+    int status = count >= 0 && flush_byte_writer(&writer) == 0 ? 0 : -1;
     
-    int entry_count;
-    if (fread(&entry_count, sizeof(int), 1, file) != 1) {
-        free(index);
-        fclose(file);
-        return nullptr;
+    
+    if (fseek(file, 0, SEEK_SET) != 0) status = -1;
+    write_index_header(&writer, count);
+    if (flush_byte_writer(&writer) != 0) status = -1;
+    
+    free_byte_writer(&writer);
+    if (fclose(file) != 0) status = -1;
+    return status;
+}
+
+static void remove_run_files(char** run_files, int run_count) {
+    for (int r = 0; r < run_count; r++) {
+        if (run_files[r]) remove(run_files[r]);
+        free(run_files[r]);
     }
+    free(run_files);
+}
+
+int merge_index_runs(const char** run_files, int run_count, const char* documents_file, 
+                     int document_count, const char* filename, size_t memory_budget) {
+    if ((!run_files && run_count > 0) || run_count < 0 || !filename) return -1;
     
-    init_index(index, entry_count);
-    index->count = entry_count;
+    int fan_in = MERGE_MAX_FAN_IN;
+    if (memory_budget > 0 && memory_budget / 4 / MERGE_MIN_BUFFER < (size_t)fan_in) {
+        fan_in = std::max(2, (int)(memory_budget / 4 / MERGE_MIN_BUFFER));
+    }
     
-    for (int i = 0; i < entry_count; i++) {
-        IndexEntry* entry = &index->entries[i];
-        
+    int width = std::max(1, std::min(run_count, fan_in));
+    size_t buffer_size = memory_budget > 0 ? memory_budget / 4 / width : BYTE_IO_BUFFER_SIZE;
+    if (buffer_size > BYTE_IO_BUFFER_SIZE) buffer_size = BYTE_IO_BUFFER_SIZE;
+    if (buffer_size < MERGE_MIN_BUFFER) buffer_size = MERGE_MIN_BUFFER;
+    
+    
+    const char** inputs = run_files;
+    int input_count = run_count;
+    char** merged = nullptr;
+    int merged_count = 0;
+    int serial = 0;
+    int status = 0;
+    
+    while (status == 0 && input_count > fan_in) {
+        int output_count = (input_count + fan_in - 1) / fan_in;
+        char** outputs = (char**)calloc(output_count, sizeof(char*));
+        if (!outputs) status = -1;
         
-        int term_len;
-        if (fread(&term_len, sizeof(int), 1, file) != 1) {
-            free_index(index);
-            fclose(file);
-            return nullptr;
+        for (int g = 0; outputs && g < output_count && status == 0; g++) {
+            outputs[g] = side_file_name(filename, ".merge", serial++);
+            int group_count = std::min(fan_in, input_count - g * fan_in);
+            if (!outputs[g] || write_merged_run(inputs + g * fan_in, group_count, buffer_size, outputs[g]) != 0) {
+                status = -1;
+            }
         }
         
-        entry->term = (char*)malloc(term_len + 1);
-        if (!entry->term) {
-            free_index(index);
-            fclose(file);
-            return nullptr;
+        remove_run_files(merged, merged_count);
+        merged = outputs;
+        merged_count = outputs ? output_count : 0;
+        inputs = (const char**)merged;
+        input_count = merged_count;
+    }
+    
+    MappedIndexWriter mapped;
+    if (status != 0 || open_mapped_writer(&mapped, filename) != 0) {
+        remove_run_files(merged, merged_count);
+        return -1;
+    }
+    
+    if (merge_run_pass(inputs, input_count, buffer_size, &mapped, nullptr) < 0) status = -1;
+    remove_run_files(merged, merged_count);
+    
+    DocumentRecords records;
+    init_document_records(&records, nullptr, 0);
+    if (status == 0 && documents_file && open_document_records(&records, documents_file, document_count) != 0) status = -1;
+    int written = close_mapped_writer(&mapped, status == 0 ? &records : nullptr, status);
+    close_document_records(&records);
+    return written;
+}
+
+static size_t entry_bytes(const IndexEntry* entry) {
+    size_t bytes = sizeof(IndexEntry) + sizeof(int) + allocation_bytes(strlen(entry->term) + 1);
+    if (entry->doc_count == 0) return bytes;
+    
+    bytes += allocation_bytes(entry->doc_count * sizeof(int)) + allocation_bytes(entry->doc_count * sizeof(PositionList));
+    for (int j = 0; j < entry->doc_count; j++) {
+        if (entry->positions[j].count > 0) bytes += allocation_bytes(entry->positions[j].count * sizeof(int));
+    }
+    return bytes;
+}
+
+static int write_stream_run(IndexEntry* entries, int count, const char* filename, char*** run_files, int* run_count) {
+    int* order = (int*)malloc((count + 1) * sizeof(int));
+    char* name = side_file_name(filename, ".run", *run_count);
+    char** new_runs = (char**)realloc(*run_files, (*run_count + 1) * sizeof(char*));
+    if (new_runs) *run_files = new_runs;
+    if (!order || !name || !new_runs) {
+        free(order);
+        free(name);
+        return -1;
+    }
+    (*run_files)[(*run_count)++] = name;
+    
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::sort(order, order + count, [entries](int a, int b) { return strcmp(entries[a].term, entries[b].term) < 0; });
+    
+    int status = write_index_file(entries, count, order, name);
+    free(order);
+    return status;
+}
+
+int is_stream_index(const char* filename) {
+    IndexStream stream;
+    if (!filename || !open_index_stream(filename, &stream, MERGE_MIN_BUFFER)) return 0;
+    
+    close_index_stream(&stream);
+    return 1;
+}
+
+int convert_stream_index(const char* input, const char* filename, size_t memory_budget) {
+    if (!input || !filename || memory_budget == 0) return -1;
+    
+    IndexStream stream;
+    if (!open_index_stream(input, &stream, BYTE_IO_BUFFER_SIZE)) return -1;
+    
+    int capacity = 1024;
+    IndexEntry* entries = (IndexEntry*)malloc(capacity * sizeof(IndexEntry));
+    char** run_files = nullptr;
+    int run_count = 0;
+    int count = 0;
+    size_t bytes = BYTE_IO_BUFFER_SIZE;
+    int status = entries ? 0 : -1;
+    
+    
+    while (status == 0 && (stream.remaining > 0 || count > 0 || run_count == 0)) {
+        if (stream.remaining > 0 && (bytes < memory_budget || count == 0)) {
+            if (count == capacity) {
+                IndexEntry* grown = (IndexEntry*)realloc(entries, capacity * 2 * sizeof(IndexEntry));
+                if (!grown) {
+                    status = -1;
+                    break;
+                }
+                entries = grown;
+                capacity *= 2;
+            }
+            
+            stream.remaining--;
+            if (!read_entry(&stream, &entries[count])) {
+                free_entry(&entries[count]);
+                status = -1;
+                break;
+            }
+            bytes += entry_bytes(&entries[count++]);
+            continue;
         }
         
-        if (fread(entry->term, sizeof(char), term_len, file) != (size_t)term_len) {
-            free_index(index);
-            fclose(file);
-            return nullptr;
+        status = write_stream_run(entries, count, filename, &run_files, &run_count);
+        for (int i = 0; i < count; i++) {
+            free_entry(&entries[i]);
         }
-        entry->term[term_len] = '\0';
+        count = 0;
+        bytes = BYTE_IO_BUFFER_SIZE;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        free_entry(&entries[i]);
+    }
+    free(entries);
+    close_index_stream(&stream);
+    
+    
+    int term_count = -1;
+    if (status == 0) {
+        term_count = merge_index_runs((const char**)run_files, run_count, nullptr, 0, filename, memory_budget);
+    }
+    
+    for (int r = 0; r < run_count; r++) {
+        remove(run_files[r]);
+        free(run_files[r]);
+    }
+    free(run_files);
+    return term_count;
+}
+
+typedef struct {
+    int source;
+    int term;
+} MergeCursor;
+
+static bool merge_cursor_less(const MergeSource* sources, const MergeCursor* a, const MergeCursor* b) {
+    int cmp = strcmp(mapped_term_string(sources[a->source].index->mapped, a->term), 
+                     mapped_term_string(sources[b->source].index->mapped, b->term));
+    return cmp < 0 || (cmp == 0 && a->source < b->source);
+}
+
+static void sift_down_cursors(const MergeSource* sources, MergeCursor** heap, int size, int i) {
+    while (true) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = 2 * i + 2;
         
+        if (left < size && merge_cursor_less(sources, heap[left], heap[smallest])) smallest = left;
+        if (right < size && merge_cursor_less(sources, heap[right], heap[smallest])) smallest = right;
+        if (smallest == i) return;
         
-        if (fread(&entry->doc_count, sizeof(int), 1, file) != 1) {
-            free_index(index);
-            fclose(file);
-            return nullptr;
+        MergeCursor* tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static void push_cursor(const MergeSource* sources, MergeCursor** heap, int* size, MergeCursor* cursor) {
+    int i = (*size)++;
+    heap[i] = cursor;
+    
+    while (i > 0 && merge_cursor_less(sources, heap[i], heap[(i - 1) / 2])) {
+        MergeCursor* tmp = heap[i];
+        heap[i] = heap[(i - 1) / 2];
+        heap[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+}
+
+static int merged_doc_id(const MergeSource* source, unsigned int doc_id) {
+    return doc_id <= (unsigned int)source->index->max_doc_id ? source->doc_map[doc_id] : -1;
+}
+
+static const unsigned char* skip_mapped_positions(const unsigned char* in, const unsigned char* end, int count) {
+    for (int k = 0; k < count && in; k++) {
+        unsigned int delta = 0;
+        in = read_mapped_vbyte(in, end, &delta);
+    }
+    return in;
+}
+
+static int append_position_span(MappedIndexWriter* mapped, const unsigned char* from, const unsigned char* to) {
+    if (to == from) return 0;
+    if (reserve_bytes(mapped, to - from) != 0) return -1;
+    
+    memcpy(mapped->bytes + mapped->bytes_length, from, to - from);
+    mapped->bytes_length += to - from;
+    return 0;
+}
+
+static int write_merged_term(MappedIndexWriter* mapped, const char* term, const MergeSource* sources, 
+                             MergeCursor** group, int group_size) {
+    unsigned int doc_count = 0;
+    unsigned int position_count = 0;
+    
+    for (int g = 0; g < group_size; g++) {
+        doc_count += sources[group[g]->source].index->mapped->terms[group[g]->term].doc_count;
+    }
+    if (doc_count > INT_MAX / 2 || reserve_postings(mapped, doc_count) != 0) return -1;
+    
+    
+    mapped->bytes_length = 0;
+    doc_count = 0;
+    for (int g = 0; g < group_size; g++) {
+        const MergeSource* source = &sources[group[g]->source];
+        const MappedTerm* info = &source->index->mapped->terms[group[g]->term];
+        const unsigned char* in = mapped_postings(source->index->mapped, group[g]->term);
+        if (!in) return -1;
+        
+        in += skip_count_for(info->doc_count) * 2 * sizeof(int);
+        int* source_ids = mapped->doc_ids + doc_count;
+        if (get_posting_codec(info->codec)->decode(in, in + info->doc_bytes, info->doc_count, source_ids) != info->doc_bytes) {
+            return -1;
         }
         
-        entry->capacity = entry->doc_count;
+        const unsigned char* tf_in = in + info->doc_bytes;
+        const unsigned char* tf_end = tf_in + info->tf_bytes;
+        const unsigned char* positions = tf_end;
+        const unsigned char* end = positions + info->position_bytes;
+        const unsigned char* span = positions;
+        unsigned long long source_positions = 0;
         
-        if (entry->doc_count > 0) {
-            
-            entry->doc_ids = (int*)malloc(entry->doc_count * sizeof(int));
-            entry->positions = (PositionList*)malloc(entry->doc_count * sizeof(PositionList));
+        for (unsigned int j = 0; j < info->doc_count; j++) {
+            unsigned int tf = 0;
+            tf_in = read_mapped_vbyte(tf_in, tf_end, &tf);
+            const unsigned char* next = tf_in ? skip_mapped_positions(positions, end, tf) : nullptr;
+            if (!next) return -1;
+            source_positions += tf;
             
-            if (!entry->doc_ids || !entry->positions) {
-                free_index(index);
-                fclose(file);
-                return nullptr;
+            int doc_id = merged_doc_id(source, (unsigned int)source_ids[j]);
+            if (doc_id > 0) {
+                mapped->doc_ids[doc_count] = doc_id;
+                mapped->tfs[doc_count++] = (int)tf;
+                position_count += tf;
+            } else {
+                if (append_position_span(mapped, span, positions) != 0) return -1;
+                span = next;
             }
+            positions = next;
+        }
+        
+        if (tf_in != tf_end || source_positions != info->position_count || 
+            append_position_span(mapped, span, positions) != 0) {
+            return -1;
+        }
+    }
+    
+    return write_mapped_postings(mapped, term, doc_count, position_count);
+}
+
+static int write_merged_documents(const MergeSource* sources, int source_count, const char* filename, int* document_count) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) return -1;
+    
+    ByteWriter writer;
+    if (init_byte_writer(&writer, file) != 0) {
+        fclose(file);
+        return -1;
+    }
+    
+    *document_count = 0;
+    for (int s = 0; s < source_count; s++) {
+        MappedIndex* source = sources[s].index->mapped;
+        for (int i = 0; i < source->document_count; i++) {
+            DocumentInfo info;
+            int doc_id = merged_doc_id(&sources[s], source->documents[i].doc_id);
+            if (doc_id <= 0 || !get_document_info(sources[s].index, source->documents[i].doc_id, &info)) continue;
             
-            for (int j = 0; j < entry->doc_count; j++) {
-                
-                if (fread(&entry->doc_ids[j], sizeof(int), 1, file) != 1) {
-                    free_index(index);
-                    fclose(file);
-                    return nullptr;
-                }
-                
-                
-                int pos_count;
-                if (fread(&pos_count, sizeof(int), 1, file) != 1) {
-                    free_index(index);
-                    fclose(file);
-                    return nullptr;
-                }
-                
-                entry->positions[j].count = pos_count;
-                entry->positions[j].capacity = pos_count;
-                
-                if (pos_count > 0) {
-                    entry->positions[j].positions = (int*)malloc(pos_count * sizeof(int));
-                    if (!entry->positions[j].positions) {
-                        free_index(index);
-                        fclose(file);
-                        return nullptr;
-                    }
-                    
-                    if (fread(entry->positions[j].positions, sizeof(int), pos_count, file) != (size_t)pos_count) {
-                        free_index(index);
-                        fclose(file);
-                        return nullptr;
-                    }
-                } else {
-                    entry->positions[j].positions = nullptr;
-                }
+            info.doc_id = doc_id;
+            put_document_record(&writer, &info);
+            (*document_count)++;
+        }
+    }
+    
+    int status = flush_byte_writer(&writer);
+    free_byte_writer(&writer);
+    if (fclose(file) != 0) status = -1;
+    return status;
+}
+
+int merge_mapped_indexes(const MergeSource* sources, int source_count, const char* filename) {
+    if (!sources || source_count <= 0 || !filename) return -1;
+    
+    for (int s = 0; s < source_count; s++) {
+        if (!sources[s].index || !sources[s].index->mapped || !sources[s].doc_map) return -1;
+    }
+    
+    char* documents_path = side_file_name(filename, ".docinfo", -1);
+    int document_count = 0;
+    if (!documents_path || write_merged_documents(sources, source_count, documents_path, &document_count) != 0) {
+        if (documents_path) remove(documents_path);
+        free(documents_path);
+        return -1;
+    }
+    
+    MappedIndexWriter mapped;
+    if (open_mapped_writer(&mapped, filename) != 0) {
+        remove(documents_path);
+        free(documents_path);
+        return -1;
+    }
+    
+    MergeCursor* cursors = (MergeCursor*)calloc(source_count, sizeof(MergeCursor));
+    MergeCursor** heap = (MergeCursor**)malloc(source_count * sizeof(MergeCursor*));
+    MergeCursor** group = (MergeCursor**)malloc(source_count * sizeof(MergeCursor*));
+    int heap_size = 0;
+    int status = cursors && heap && group ? 0 : -1;
+    
+    
+    for (int s = 0; s < source_count && status == 0; s++) {
+        const char* previous = nullptr;
+        for (int i = 0; i < sources[s].index->count && status == 0; i++) {
+            const char* term = mapped_term_string(sources[s].index->mapped, i);
+            if (!term || (previous && strcmp(previous, term) >= 0)) status = -1;
+            previous = term;
+        }
+        
+        cursors[s].source = s;
+        if (sources[s].index->count > 0) push_cursor(sources, heap, &heap_size, &cursors[s]);
+    }
+    
+    while (status == 0 && heap_size > 0) {
+        int group_size = 0;
+        const char* term = mapped_term_string(sources[heap[0]->source].index->mapped, heap[0]->term);
+        
+        
+        do {
+            group[group_size++] = heap[0];
+            heap[0] = heap[--heap_size];
+            sift_down_cursors(sources, heap, heap_size, 0);
+        } while (heap_size > 0 && 
+                 strcmp(mapped_term_string(sources[heap[0]->source].index->mapped, heap[0]->term), term) == 0);
+        
+        if (write_merged_term(&mapped, term, sources, group, group_size) < 0) status = -1;
+        
+        for (int g = 0; g < group_size; g++) {
+            if (++group[g]->term < sources[group[g]->source].index->count) {
+                push_cursor(sources, heap, &heap_size, group[g]);
             }
-        } else {
-            entry->doc_ids = nullptr;
-            entry->positions = nullptr;
         }
     }
     
-    fclose(file);
+    free(cursors);
+    free(heap);
+    free(group);
+    
+    DocumentRecords records;
+    if (open_document_records(&records, documents_path, document_count) != 0) status = -1;
+    int written = close_mapped_writer(&mapped, status == 0 ? &records : nullptr, status);
+    close_document_records(&records);
+    remove(documents_path);
+    free(documents_path);
+    return written;
+}
+
+static BooleanIndex* load_mapped_index(unsigned char* data, size_t size) {
+    unsigned int term_count = read_le32(data + 8);
+    unsigned int max_doc_id = read_le32(data + 12);
+    unsigned long long terms_offset = read_le64(data + 16);
+    unsigned long long strings_offset = read_le64(data + 24);
+    unsigned long long strings_size = read_le64(data + 32);
+    unsigned int document_count = read_le32(data + 40);
+    unsigned long long documents_offset = read_le64(data + 48);
+    
+    
+    if (term_count > INT_MAX || max_doc_id > INT_MAX || terms_offset % 8 != 0 ||
+        terms_offset > size || (size - terms_offset) / sizeof(MappedTerm) < term_count ||
+        strings_offset > size || strings_size > size - strings_offset ||
+        (strings_size > 0 && data[strings_offset + strings_size - 1] != '\0') ||
+        document_count > INT_MAX || documents_offset % sizeof(int) != 0 || documents_offset > size || 
+        (size - documents_offset) / sizeof(MappedDocument) < document_count) {
+        return nullptr;
+    }
+    
+    BooleanIndex* index = (BooleanIndex*)malloc(sizeof(BooleanIndex));
+    MappedIndex* mapped = (MappedIndex*)calloc(1, sizeof(MappedIndex));
+    IndexEntry* entries = (IndexEntry*)calloc(term_count + 1, sizeof(IndexEntry));
+    if (!index || !mapped || !entries) {
+        free(index);
+        free(mapped);
+        free(entries);
+        return nullptr;
+    }
+    
+    
+    mapped->data = data;
+    mapped->size = size;
+    mapped->terms = (const MappedTerm*)(data + terms_offset);
+    mapped->strings = (const char*)(data + strings_offset);
+    mapped->strings_size = strings_size;
+    mapped->documents = (const MappedDocument*)(data + documents_offset);
+    mapped->document_count = (int)document_count;
+    
+    index->entries = entries;
+    index->count = (int)term_count;
+    index->capacity = (int)term_count;
+    index->slots = nullptr;
+    index->slot_capacity = 0;
+    index->memory_bytes = 0;
+    index->max_doc_id = (int)max_doc_id;
+    index->documents = nullptr;
+    index->document_count = 0;
+    index->document_capacity = 0;
+    index->mapped = mapped;
+    index->document_lengths = nullptr;
+    index->total_length = 0;
+    index->min_length = 0;
+    index->intersection_cache = nullptr;
+    index->dictionary = nullptr;
+    
     return index;
 }
 
-void free_index(BooleanIndex* index) {
-    if (!index) return;
+BooleanIndex* load_index(const char* filename) {
+    if (!filename) return nullptr;
     
-    for (int i = 0; i < index->count; i++) {
-        free(index->entries[i].term);
+    size_t size = 0;
+    unsigned char* data = map_file(filename, &size);
+    if (data && size >= INDEX_MAPPED_HEADER_SIZE && memcmp(data, INDEX_MAGIC, 4) == 0 &&
+        read_le32(data + 4) == INDEX_MAPPED_VERSION) {
+        BooleanIndex* index = load_mapped_index(data, size);
+        if (!index) unmap_file(data, size);
+        return index;
+    }
+    
+    unsigned int version = data && size >= 8 ? read_le32(data + 4) : 0;
+    if (data && size >= 8 && memcmp(data, INDEX_MAGIC, 4) == 0 && 
+        version >= INDEX_MAPPED_MIN_VERSION && version < INDEX_MAPPED_VERSION) {
+        printf("Index %s uses mapped format v%u; rebuild required for v%d\n", filename, version, INDEX_MAPPED_VERSION);
+        unmap_file(data, size);
+        return nullptr;
+    }
+    unmap_file(data, size);
+    
+    IndexStream stream;
+    if (!open_index_stream(filename, &stream, BYTE_IO_BUFFER_SIZE)) return nullptr;
+    
+    BooleanIndex* index = (BooleanIndex*)malloc(sizeof(BooleanIndex));
+    if (!index) {
+        close_index_stream(&stream);
+        return nullptr;
+    }
+    
+    int entry_count = stream.remaining;
+    init_index(index, entry_count);
+    
+    for (int i = 0; i < entry_count; i++) {
+        IndexEntry* entry = &index->entries[i];
         
-        if (index->entries[i].positions) {
-            for (int j = 0; j < index->entries[i].doc_count; j++) {
-                free(index->entries[i].positions[j].positions);
-            }
-            free(index->entries[i].positions);
+        int ok = read_entry(&stream, entry);
+        index->count = i + 1;
+        
+        if (!ok) {
+            free_index(index);
+            close_index_stream(&stream);
+            return nullptr;
         }
         
-        free(index->entries[i].doc_ids);
+        insert_slot(index, hash_string(entry->term), i);
+    }
+    
+    close_index_stream(&stream);
+    finalize_index(index);
+    return index;
+}
+
+static void clear_mapped_index(BooleanIndex* index) {
+    MappedIndex* mapped = index->mapped;
+    
+    for (int i = 0; i < mapped->arena_chunk_count; i++) {
+        free(mapped->arena_chunks[i]);
+    }
+    
+    free(mapped->arena_chunks);
+    unmap_file(mapped->data, mapped->size);
+    free(mapped);
+    index->mapped = nullptr;
+    index->count = 0;
+}
+
+void clear_index(BooleanIndex* index) {
+    if (!index) return;
+    
+    if (index->mapped) clear_mapped_index(index);
+    
+    for (int i = 0; i < index->count; i++) {
+        free_entry(&index->entries[i]);
+    }
+    
+    for (int i = 0; i < index->document_count; i++) {
+        free(index->documents[i].title);
+        free(index->documents[i].path);
     }
     
     free(index->entries);
+    free(index->slots);
+    free(index->documents);
+    free(index->document_lengths);
+    free_term_dictionary(index->dictionary);
+    index->entries = nullptr;
+    index->document_lengths = nullptr;
+    index->total_length = 0;
+    index->min_length = 0;
+    index->intersection_cache = nullptr;
+    index->dictionary = nullptr;
+    index->slots = nullptr;
+    index->documents = nullptr;
+    index->document_count = 0;
+    index->document_capacity = 0;
+    index->count = 0;
+    index->capacity = 0;
+    index->slot_capacity = 0;
+    index->memory_bytes = 0;
+}
+
+void free_index(BooleanIndex* index) {
+    if (!index) return;
+    
+    clear_index(index);
     free(index);
 }
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "../include/byte_io.h"
+#include <cstdlib>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+int init_byte_writer(ByteWriter* writer, FILE* file) {
+    return init_byte_writer_sized(writer, file, BYTE_IO_BUFFER_SIZE);
+}
+
+int init_byte_writer_sized(ByteWriter* writer, FILE* file, size_t capacity) {
+    if (capacity < 16) capacity = 16;
+    
+    writer->file = file;
+    writer->data = (unsigned char*)malloc(capacity);
+    writer->length = 0;
+    writer->capacity = writer->data ? capacity : 0;
+    writer->error = writer->data ? 0 : 1;
+    return writer->error ? -1 : 0;
+}
+
+int flush_byte_writer(ByteWriter* writer) {
+    if (writer->length > 0 && !writer->error) {
+        if (fwrite(writer->data, 1, writer->length, writer->file) != writer->length) {
+            writer->error = 1;
+        }
+    }
+    writer->length = 0;
+    return writer->error ? -1 : 0;
+}
+
+void put_bytes(ByteWriter* writer, const void* bytes, size_t count) {
+    const unsigned char* src = (const unsigned char*)bytes;
+    
+    while (count > 0 && !writer->error) {
+        if (writer->length == writer->capacity) {
+            flush_byte_writer(writer);
+        }
+        
+        size_t chunk = writer->capacity - writer->length;
+        if (chunk > count) chunk = count;
+        
+        memcpy(writer->data + writer->length, src, chunk);
+        writer->length += chunk;
+        src += chunk;
+        count -= chunk;
+    }
+}
+
+void put_uint32(ByteWriter* writer, unsigned int value) {
+    unsigned char bytes[4] = {
+        (unsigned char)value, (unsigned char)(value >> 8),
+        (unsigned char)(value >> 16), (unsigned char)(value >> 24)
+    };
+    put_bytes(writer, bytes, 4);
+}
+
+void put_vbyte(ByteWriter* writer, unsigned int value) {
+    if (writer->error) return;
+    if (writer->capacity - writer->length < 5) {
+        if (flush_byte_writer(writer) != 0) return;
+    }
+    
+    unsigned char* out = writer->data + writer->length;
+    while (value >= 0x80) {
+        *out++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    writer->length = out - writer->data;
+}
+
+void free_byte_writer(ByteWriter* writer) {
+    free(writer->data);
+    writer->data = nullptr;
+    writer->length = 0;
+    writer->capacity = 0;
+}
+
+int init_byte_reader(ByteReader* reader, FILE* file) {
+    return init_byte_reader_sized(reader, file, BYTE_IO_BUFFER_SIZE);
+}
+
+int init_byte_reader_sized(ByteReader* reader, FILE* file, size_t capacity) {
+    if (capacity < 16) capacity = 16;
+    
+    reader->file = file;
+    reader->data = (unsigned char*)malloc(capacity);
+    reader->length = 0;
+    reader->offset = 0;
+    reader->capacity = reader->data ? capacity : 0;
+    reader->error = reader->data ? 0 : 1;
+    return reader->error ? -1 : 0;
+}
+
+static int refill(ByteReader* reader) {
+    size_t remaining = reader->length - reader->offset;
+    memmove(reader->data, reader->data + reader->offset, remaining);
+    
+    reader->length = remaining + fread(reader->data + remaining, 1, reader->capacity - remaining, reader->file);
+    reader->offset = 0;
+    return reader->length > remaining;
+}
+
+int get_bytes(ByteReader* reader, void* bytes, size_t count) {
+    unsigned char* dst = (unsigned char*)bytes;
+    
+    while (count > 0) {
+        if (reader->offset == reader->length && !refill(reader)) {
+            reader->error = 1;
+            return 0;
+        }
+        
+        size_t chunk = reader->length - reader->offset;
+        if (chunk > count) chunk = count;
+        
+        memcpy(dst, reader->data + reader->offset, chunk);
+        reader->offset += chunk;
+        dst += chunk;
+        count -= chunk;
+    }
+    
+    return 1;
+}
+
+int get_uint32(ByteReader* reader, unsigned int* value) {
+    unsigned char bytes[4];
+    if (!get_bytes(reader, bytes, 4)) return 0;
+    
+    *value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+    return 1;
+}
+
+int get_vbyte(ByteReader* reader, unsigned int* value) {
+    if (reader->length - reader->offset < 5) {
+        refill(reader);
+    }
+    
+    unsigned int result = 0;
+    int shift = 0;
+    
+    while (reader->offset < reader->length && shift < 35) {
+        unsigned char byte = reader->data[reader->offset++];
+        result |= (unsigned int)(byte & 0x7f) << shift;
+        
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 1;
+        }
+        shift += 7;
+    }
+    
+    reader->error = 1;
+    return 0;
+}
+
+void free_byte_reader(ByteReader* reader) {
+    free(reader->data);
+    reader->data = nullptr;
+    reader->length = 0;
+    reader->offset = 0;
+    reader->capacity = 0;
+}
+
+unsigned int read_le32(const unsigned char* bytes) {
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+unsigned long long read_le64(const unsigned char* bytes) {
+    return read_le32(bytes) | ((unsigned long long)read_le32(bytes + 4) << 32);
+}
+
+unsigned char* map_file(const char* filename, size_t* size) {
+#ifdef _WIN32
+    FILE* file = fopen(filename, "rb");
+    if (!file) return nullptr;
+    
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    unsigned char* data = length > 0 ? (unsigned char*)malloc(length) : nullptr;
+    if (data && fread(data, 1, length, file) != (size_t)length) {
+        free(data);
+        data = nullptr;
+    }
+    
+    fclose(file);
+    *size = data ? (size_t)length : 0;
+    return data;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return nullptr;
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+    
+    void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return nullptr;
+    
+    *size = info.st_size;
+    return (unsigned char*)data;
+#endif
+}
+
+void unmap_file(unsigned char* data, size_t size) {
+    if (!data) return;
+#ifdef _WIN32
+    (void)size;
+    free(data);
+#else
+    munmap(data, size);
+#endif
+}
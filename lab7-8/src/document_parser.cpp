@@ -7,6 +7,7 @@
 
 #ifdef _WIN32
     #include <direct.h>
+    #include <windows.h>
     #define mkdir _mkdir
 #else
     #include <sys/stat.h>
@@ -347,98 +348,109 @@ Document parse_html_document(const char* filepath, int doc_id) {
     return doc;
 }
 
-#ifndef _WIN32
+static int compare_paths(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
 
 DocumentCollection load_documents_from_dir(const char* dir_path) {
     DocumentCollection collection;
     init_document_collection(&collection, 10);
     
+    int file_count = 0;
+    char** files = list_html_files(dir_path, &file_count);
+    
+    for (int i = 0; i < file_count; i++) {
+        printf("Processing HTML file: %s\n", files[i]);
+        Document doc = parse_html_document(files[i], i + 1);
+        add_document(&collection, doc);
+    }
+    
+    free_string_array(files, file_count);
+    printf("Loaded %d HTML documents\n", collection.count);
+    return collection;
+}
+
+#ifndef _WIN32
+
+char** list_html_files(const char* dir_path, int* count) {
+    *count = 0;
+    
     DIR* dir = opendir(dir_path);
     if (!dir) {
         printf("Cannot open directory: %s\n", dir_path);
-        return collection;
+        return nullptr;
     }
     
-    struct dirent* entry;
-    int doc_id = 1;
+    int capacity = 16;
+    char** paths = (char**)malloc(capacity * sizeof(char*));
+    if (!paths) {
+        closedir(dir);
+        return nullptr;
+    }
     
+    struct dirent* entry;
     while ((entry = readdir(dir)) != nullptr) {
+        if (!is_html_file(entry->d_name)) continue;
         
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
+        if (*count >= capacity) {
+            capacity *= 2;
+            char** new_paths = (char**)realloc(paths, capacity * sizeof(char*));
+            if (!new_paths) break;
+            paths = new_paths;
         }
         
-        
         char full_path[1024];
         snprintf(full_path, sizeof(full_path), "%s/%s", dir_path, entry->d_name);
-        
-        
-        if (is_html_file(entry->d_name)) {
-            printf("Processing HTML file: %s\n", entry->d_name);
-            Document doc = parse_html_document(full_path, doc_id);
-            add_document(&collection, doc);
-            doc_id++;
-        }
+        paths[(*count)++] = strdup(full_path);
     }
     
     closedir(dir);
-    printf("Loaded %d HTML documents\n", collection.count);
-    return collection;
+    
+    
+    qsort(paths, *count, sizeof(char*), compare_paths);
+    return paths;
 }
 #else
 
-DocumentCollection load_documents_from_dir(const char* dir_path) {
-    DocumentCollection collection;
-    init_document_collection(&collection, 10);
+char** list_html_files(const char* dir_path, int* count) {
+    *count = 0;
+    
+    char pattern[1024];
+    snprintf(pattern, sizeof(pattern), "%s/*", dir_path);
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    if (find == INVALID_HANDLE_VALUE) {
+        printf("Cannot open directory: %s\n", dir_path);
+        return nullptr;
+    }
     
-    printf("Directory loading for HTML files...\n");
-    
-    
-    
-    printf("Creating test HTML documents...\n");
-    
-    
-    const char* html1 = "<!DOCTYPE html>\n"
-                       "<html>\n"
-                       "<head><title>Music Document 1</title></head>\n"
-                       "<body>\n"
-                       "<h1>Back in Black - AC/DC</h1>\n"
-                       "<div class=\"lyrics\">Back in black I hit the sack\n"
-                       "I've been too long I'm glad to be back</div>\n"
-                       "<p>Genre: Rock</p>\n"
-                       "</body>\n"
-                       "</html>";
-    
-    Document doc1;
-    doc1.id = 1;
-    doc1.filepath = strdup("test1.html");
-    doc1.original_html = strdup(html1);
-    doc1.title = extract_title_from_html(html1);
-    doc1.content = extract_text_from_html(html1);
-    doc1.word_count = count_words(doc1.content);
-    add_document(&collection, doc1);
-    
-    
-    const char* html2 = "<!DOCTYPE html>\n"
-                       "<html lang=\"ru\">\n"
-                       "<head><title>Музыкальный документ 2</title></head>\n"
-                       "<body>\n"
-                       "<h1>Bohemian Rhapsody - Queen</h1>\n"
-                       "<div>Легендарная песня группы Queen</div>\n"
-                       <p>Жанр: Рок, Прогрессив-рок</p>\n"
-                       "</body>\n"
-                       "</html>";
-    
-    Document doc2;
-    doc2.id = 2;
-    doc2.filepath = strdup("test2.html");
-    doc2.original_html = strdup(html2);
-    doc2.title = extract_title_from_html(html2);
-    doc2.content = extract_text_from_html(html2);
-    doc2.word_count = count_words(doc2.content);
-    add_document(&collection, doc2);
+    int capacity = 16;
+    char** paths = (char**)malloc(capacity * sizeof(char*));
+    if (!paths) {
+        FindClose(find);
+        return nullptr;
+    }
     
-    return collection;
+    do {
+        if ((entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) || !is_html_file(entry.cFileName)) continue;
+        
+        if (*count >= capacity) {
+            capacity *= 2;
+            char** new_paths = (char**)realloc(paths, capacity * sizeof(char*));
+            if (!new_paths) break;
+            paths = new_paths;
+        }
+        
+        char full_path[1024];
+        snprintf(full_path, sizeof(full_path), "%s/%s", dir_path, entry.cFileName);
+        paths[(*count)++] = strdup(full_path);
+    } while (FindNextFileA(find, &entry));
+    
+    FindClose(find);
+    
+    
+    qsort(paths, *count, sizeof(char*), compare_paths);
+    return paths;
 }
 #endif
 
@@ -0,0 +1,444 @@
+#include "../include/document_store.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#define DOC_STORE_MAGIC "BDOC"
+#define DOC_STORE_VERSION 1
+#define DOC_STORE_HEADER_SIZE 32
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+#define LZ_TAIL_LITERALS 5
+#define LZ_COPY_SLACK 16
+
+static std::mutex block_cache_lock;
+
+static unsigned int read_unaligned32(const unsigned char* bytes) {
+    unsigned int value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static unsigned char* put_length(unsigned char* out, size_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (unsigned char)length;
+    return out;
+}
+
+static unsigned char* put_sequence(unsigned char* out, const unsigned char* literals, size_t literal_length,
+                                   size_t offset, size_t match_length) {
+    unsigned char* token = out++;
+    *token = (unsigned char)((literal_length < 15 ? literal_length : 15) << 4);
+    if (literal_length >= 15) out = put_length(out, literal_length - 15);
+    
+    memcpy(out, literals, literal_length);
+    out += literal_length;
+    
+    if (match_length == 0) return out;
+    
+    
+    *out++ = (unsigned char)offset;
+    *out++ = (unsigned char)(offset >> 8);
+    
+    size_t extra = match_length - LZ_MIN_MATCH;
+    *token |= (unsigned char)(extra < 15 ? extra : 15);
+    if (extra >= 15) out = put_length(out, extra - 15);
+    
+    return out;
+}
+
+static size_t lz_compress(const unsigned char* src, size_t length, unsigned char* dst) {
+    int table[1 << LZ_HASH_BITS];
+    memset(table, -1, sizeof(table));
+    
+    unsigned char* out = dst;
+    size_t anchor = 0;
+    size_t i = 0;
+    size_t match_limit = length > LZ_TAIL_LITERALS ? length - LZ_TAIL_LITERALS : 0;
+    
+    
+    while (i + LZ_MIN_MATCH <= match_limit) {
+        unsigned int sequence = read_unaligned32(src + i);
+        unsigned int slot = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+        int ref = table[slot];
+        table[slot] = (int)i;
+        
+        if (ref < 0 || i - ref > 65535 || read_unaligned32(src + ref) != sequence) {
+            i++;
+            continue;
+        }
+        
+        size_t match_length = LZ_MIN_MATCH;
+        while (i + match_length < match_limit && src[ref + match_length] == src[i + match_length]) {
+            match_length++;
+        }
+        
+        out = put_sequence(out, src + anchor, i - anchor, i - ref, match_length);
+        i += match_length;
+        anchor = i;
+    }
+    
+    out = put_sequence(out, src + anchor, length - anchor, 0, 0);
+    return out - dst;
+}
+
+static void copy_words(unsigned char* dst, const unsigned char* src, size_t length) {
+    unsigned char* end = dst + length;
+    do {
+        memcpy(dst, src, 8);
+        dst += 8;
+        src += 8;
+    } while (dst < end);
+}
+
+static int get_length(const unsigned char** in, const unsigned char* end, size_t* length) {
+    unsigned char byte;
+    do {
+        if (*in >= end) return 0;
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+    return 1;
+}
+
+static int lz_decompress(const unsigned char* src, size_t length, unsigned char* dst, size_t raw_length) {
+    const unsigned char* in = src;
+    const unsigned char* end = src + length;
+    size_t out = 0;
+    
+    while (in < end) {
+        unsigned char token = *in++;
+        
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !get_length(&in, end, &literal_length)) return 0;
+        if (literal_length > (size_t)(end - in) || literal_length > raw_length - out) return 0;
+        
+        if ((size_t)(end - in) >= literal_length + LZ_COPY_SLACK) {
+            copy_words(dst + out, in, literal_length);
+        } else {
+            memcpy(dst + out, in, literal_length);
+        }
+        in += literal_length;
+        out += literal_length;
+        
+        if (in == end) break;
+        
+        
+        if (end - in < 2) return 0;
+        size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        
+        size_t match_length = token & 15;
+        if (match_length == 15 && !get_length(&in, end, &match_length)) return 0;
+        match_length += LZ_MIN_MATCH;
+        
+        if (offset == 0 || offset > out || match_length > raw_length - out) return 0;
+        
+        if (offset >= 8) {
+            copy_words(dst + out, dst + out - offset, match_length);
+        } else {
+            for (size_t k = 0; k < match_length; k++) {
+                dst[out + k] = dst[out - offset + k];
+            }
+        }
+        out += match_length;
+    }
+    
+    return out == raw_length;
+}
+
+char* document_store_path(const char* index_file) {
+    if (!index_file) return nullptr;
+    
+    size_t len = strlen(index_file) + 6;
+    char* path = (char*)malloc(len);
+    if (path) {
+        snprintf(path, len, "%s.docs", index_file);
+    }
+    return path;
+}
+
+static void write_store_header(ByteWriter* writer, int document_count, int block_count,
+                               unsigned long long blocks_offset, unsigned long long documents_offset) {
+    put_bytes(writer, DOC_STORE_MAGIC, 4);
+    put_uint32(writer, DOC_STORE_VERSION);
+    put_uint32(writer, document_count);
+    put_uint32(writer, block_count);
+    put_uint32(writer, (unsigned int)blocks_offset);
+    put_uint32(writer, (unsigned int)(blocks_offset >> 32));
+    put_uint32(writer, (unsigned int)documents_offset);
+    put_uint32(writer, (unsigned int)(documents_offset >> 32));
+}
+
+int open_document_store_writer(DocumentStoreWriter* writer, const char* filename) {
+    memset(writer, 0, sizeof(DocumentStoreWriter));
+    
+    writer->file = fopen(filename, "wb");
+    if (!writer->file) return -1;
+    
+    writer->block = (unsigned char*)malloc(DOC_STORE_BLOCK_SIZE);
+    if (!writer->block || init_byte_writer(&writer->writer, writer->file) != 0) {
+        free(writer->block);
+        fclose(writer->file);
+        return -1;
+    }
+    writer->block_capacity = DOC_STORE_BLOCK_SIZE;
+    
+    write_store_header(&writer->writer, 0, 0, 0, 0);
+    writer->offset = DOC_STORE_HEADER_SIZE;
+    return 0;
+}
+
+static void flush_store_block(DocumentStoreWriter* writer) {
+    if (writer->block_length == 0 || writer->error) return;
+    
+    if (writer->block_count == writer->block_table_capacity) {
+        int new_capacity = writer->block_table_capacity == 0 ? 64 : writer->block_table_capacity * 2;
+        StoredBlock* blocks = (StoredBlock*)realloc(writer->blocks, new_capacity * sizeof(StoredBlock));
+        if (!blocks) {
+            writer->error = 1;
+            return;
+        }
+        writer->blocks = blocks;
+        writer->block_table_capacity = new_capacity;
+    }
+    
+    unsigned char* compressed = (unsigned char*)malloc(writer->block_length + writer->block_length / 255 + 16);
+    if (!compressed) {
+        writer->error = 1;
+        return;
+    }
+    
+    
+    size_t compressed_size = lz_compress(writer->block, writer->block_length, compressed);
+    const unsigned char* payload = compressed;
+    if (compressed_size >= writer->block_length) {
+        compressed_size = writer->block_length;
+        payload = writer->block;
+    }
+    
+    StoredBlock* block = &writer->blocks[writer->block_count++];
+    block->offset = writer->offset;
+    block->compressed_size = (unsigned int)compressed_size;
+    block->raw_size = (unsigned int)writer->block_length;
+    
+    put_bytes(&writer->writer, payload, compressed_size);
+    writer->offset += compressed_size;
+    writer->block_length = 0;
+    free(compressed);
+}
+
+int add_stored_document(DocumentStoreWriter* writer, int doc_id, const char* text) {
+    if (!writer || writer->error) return -1;
+    if (!text) text = "";
+    
+    size_t length = strlen(text);
+    if (writer->block_length > 0 && writer->block_length + length > DOC_STORE_BLOCK_SIZE) {
+        flush_store_block(writer);
+    }
+    
+    if (length > writer->block_capacity) {
+        unsigned char* block = (unsigned char*)realloc(writer->block, length);
+        if (!block) {
+            writer->error = 1;
+            return -1;
+        }
+        writer->block = block;
+        writer->block_capacity = length;
+    }
+    
+    if (writer->document_count == writer->document_capacity) {
+        int new_capacity = writer->document_capacity == 0 ? 256 : writer->document_capacity * 2;
+        StoredDocument* documents = (StoredDocument*)realloc(writer->documents, new_capacity * sizeof(StoredDocument));
+        if (!documents) {
+            writer->error = 1;
+            return -1;
+        }
+        writer->documents = documents;
+        writer->document_capacity = new_capacity;
+    }
+    
+    StoredDocument* document = &writer->documents[writer->document_count++];
+    document->doc_id = doc_id;
+    document->block = writer->block_count;
+    document->offset = (unsigned int)writer->block_length;
+    document->length = (unsigned int)length;
+    
+    memcpy(writer->block + writer->block_length, text, length);
+    writer->block_length += length;
+    
+    if (writer->block_length >= DOC_STORE_BLOCK_SIZE) {
+        flush_store_block(writer);
+    }
+    
+    return writer->error ? -1 : 0;
+}
+
+int close_document_store_writer(DocumentStoreWriter* writer) {
+    if (!writer || !writer->file) return -1;
+    
+    flush_store_block(writer);
+    
+    
+    unsigned long long blocks_offset = (writer->offset + 7) & ~7ULL;
+    static const char padding[8] = {0};
+    put_bytes(&writer->writer, padding, blocks_offset - writer->offset);
+    
+    for (int i = 0; i < writer->block_count; i++) {
+        put_uint32(&writer->writer, (unsigned int)writer->blocks[i].offset);
+        put_uint32(&writer->writer, (unsigned int)(writer->blocks[i].offset >> 32));
+        put_uint32(&writer->writer, writer->blocks[i].compressed_size);
+        put_uint32(&writer->writer, writer->blocks[i].raw_size);
+    }
+    
+    unsigned long long documents_offset = blocks_offset + (unsigned long long)writer->block_count * sizeof(StoredBlock);
+    for (int i = 0; i < writer->document_count; i++) {
+        put_uint32(&writer->writer, writer->documents[i].doc_id);
+        put_uint32(&writer->writer, writer->documents[i].block);
+        put_uint32(&writer->writer, writer->documents[i].offset);
+        put_uint32(&writer->writer, writer->documents[i].length);
+    }
+    
+    if (flush_byte_writer(&writer->writer) != 0) writer->error = 1;
+    
+    if (fseek(writer->file, 0, SEEK_SET) != 0) writer->error = 1;
+    write_store_header(&writer->writer, writer->document_count, writer->block_count, blocks_offset, documents_offset);
+    if (flush_byte_writer(&writer->writer) != 0) writer->error = 1;
+    
+    free_byte_writer(&writer->writer);
+    if (fclose(writer->file) != 0) writer->error = 1;
+    free(writer->block);
+    free(writer->blocks);
+    free(writer->documents);
+    writer->file = nullptr;
+    
+    return writer->error ? -1 : 0;
+}
+
+DocumentStore* open_document_store(const char* filename) {
+    if (!filename) return nullptr;
+    
+    size_t size = 0;
+    unsigned char* data = map_file(filename, &size);
+    if (!data) return nullptr;
+    
+    int ok = size >= DOC_STORE_HEADER_SIZE && memcmp(data, DOC_STORE_MAGIC, 4) == 0 &&
+             read_le32(data + 4) == DOC_STORE_VERSION;
+    
+    unsigned int document_count = ok ? read_le32(data + 8) : 0;
+    unsigned int block_count = ok ? read_le32(data + 12) : 0;
+    unsigned long long blocks_offset = ok ? read_le64(data + 16) : 0;
+    unsigned long long documents_offset = ok ? read_le64(data + 24) : 0;
+    
+    
+    ok = ok && blocks_offset % 8 == 0 && blocks_offset <= size &&
+         (size - blocks_offset) / sizeof(StoredBlock) >= block_count &&
+         documents_offset % 4 == 0 && documents_offset <= size &&
+         (size - documents_offset) / sizeof(StoredDocument) >= document_count;
+    
+    DocumentStore* store = ok ? (DocumentStore*)calloc(1, sizeof(DocumentStore)) : nullptr;
+    if (!store) {
+        unmap_file(data, size);
+        return nullptr;
+    }
+    
+    store->data = data;
+    store->size = size;
+    store->blocks = (const StoredBlock*)(data + blocks_offset);
+    store->block_count = (int)block_count;
+    store->documents = (const StoredDocument*)(data + documents_offset);
+    store->document_count = (int)document_count;
+    store->cached_block = -1;
+    return store;
+}
+
+static const StoredDocument* find_stored_document(DocumentStore* store, int doc_id) {
+    if (doc_id >= 1 && doc_id <= store->document_count &&
+        store->documents[doc_id - 1].doc_id == (unsigned int)doc_id) {
+        return &store->documents[doc_id - 1];
+    }
+    
+    
+    int lo = 0;
+    int hi = store->document_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int id = (int)store->documents[mid].doc_id;
+        if (id == doc_id) return &store->documents[mid];
+        if (id < doc_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    
+    return nullptr;
+}
+
+static const unsigned char* load_block(DocumentStore* store, int b) {
+    if (store->cached_block == b) return store->cache;
+    
+    const StoredBlock* block = &store->blocks[b];
+    if (block->offset > store->size || block->compressed_size > store->size - block->offset ||
+        block->compressed_size > block->raw_size) {
+        return nullptr;
+    }
+    
+    const unsigned char* payload = store->data + block->offset;
+    if (block->compressed_size == block->raw_size) return payload;
+    
+    if (block->raw_size + LZ_COPY_SLACK > store->cache_capacity) {
+        unsigned char* cache = (unsigned char*)realloc(store->cache, block->raw_size + LZ_COPY_SLACK);
+        if (!cache) return nullptr;
+        store->cache = cache;
+        store->cache_capacity = block->raw_size + LZ_COPY_SLACK;
+    }
+    
+    
+    store->cached_block = -1;
+    if (!lz_decompress(payload, block->compressed_size, store->cache, block->raw_size)) return nullptr;
+    
+    store->cached_block = b;
+    store->blocks_decompressed++;
+    return store->cache;
+}
+
+char* fetch_document_text(DocumentStore* store, int doc_id) {
+    if (!store) return nullptr;
+    
+    const StoredDocument* document = find_stored_document(store, doc_id);
+    if (!document) return nullptr;
+    if (document->length == 0) return strdup("");
+    if (document->block >= (unsigned int)store->block_count) return nullptr;
+    
+    const StoredBlock* block = &store->blocks[document->block];
+    if (document->offset > block->raw_size || document->length > block->raw_size - document->offset) {
+        return nullptr;
+    }
+    
+    char* text = (char*)malloc(document->length + 1);
+    if (!text) return nullptr;
+    
+    std::lock_guard<std::mutex> guard(block_cache_lock);
+    const unsigned char* raw = load_block(store, document->block);
+    if (!raw) {
+        free(text);
+        return nullptr;
+    }
+    
+    memcpy(text, raw + document->offset, document->length);
+    text[document->length] = '\0';
+    return text;
+}
+
+void close_document_store(DocumentStore* store) {
+    if (!store) return;
+    
+    unmap_file(store->data, store->size);
+    free(store->cache);
+    free(store);
+}
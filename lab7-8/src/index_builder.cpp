@@ -0,0 +1,616 @@
+#include "../include/index_builder.h"
+#include "../include/boolean_index.h"
+#include "../include/document_parser.h"
+#include "../include/document_store.h"
+#include "../include/tokenizer.h"
+#include "../include/utils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+static char* run_file_name(const char* index_file, int run) {
+    int len = strlen(index_file) + 32;
+    char* name = (char*)malloc(len);
+    if (name) {
+        snprintf(name, len, "%s.run%d", index_file, run);
+    }
+    return name;
+}
+
+static void keep_document_info(DocumentInfo* info, Document* doc) {
+    info->doc_id = doc->id;
+    info->word_count = doc->word_count;
+    info->title = doc->title;
+    info->path = doc->filepath;
+    
+    free(doc->original_html);
+}
+
+static char* document_table_name(const char* index_file) {
+    int len = strlen(index_file) + 32;
+    char* name = (char*)malloc(len);
+    if (name) {
+        snprintf(name, len, "%s.docinfo", index_file);
+    }
+    return name;
+}
+
+static char* temporary_name(const char* path) {
+    int len = strlen(path) + 32;
+    char* name = (char*)malloc(len);
+    if (name) {
+        snprintf(name, len, "%s.tmp", path);
+    }
+    return name;
+}
+
+static int replace_file(const char* tmp_path, const char* path) {
+#ifdef _WIN32
+    remove(path);
+#endif
+    return rename(tmp_path, path) == 0 ? 0 : -1;
+}
+
+static char* document_part_name(const char* index_file, int part) {
+    int len = strlen(index_file) + 32;
+    char* name = (char*)malloc(len);
+    if (name) {
+        snprintf(name, len, "%s.docs.part%d", index_file, part);
+    }
+    return name;
+}
+
+static int replay_document_part(DocumentStoreWriter* store, const char* part_file, int count) {
+    FILE* file = fopen(part_file, "rb");
+    if (!file) return -1;
+    
+    ByteReader reader;
+    if (init_byte_reader(&reader, file) != 0) {
+        fclose(file);
+        return -1;
+    }
+    
+    int status = 0;
+    char* text = nullptr;
+    size_t capacity = 0;
+    for (int i = 0; i < count && status == 0; i++) {
+        unsigned int doc_id = 0;
+        unsigned int length = 0;
+        if (!get_uint32(&reader, &doc_id) || !get_uint32(&reader, &length)) {
+            status = -1;
+            break;
+        }
+        
+        if (length + 1 > capacity) {
+            char* grown = (char*)realloc(text, length + 1);
+            if (!grown) {
+                status = -1;
+                break;
+            }
+            text = grown;
+            capacity = length + 1;
+        }
+        
+        if (!get_bytes(&reader, text, length)) status = -1;
+        text[length] = '\0';
+        if (status == 0 && add_stored_document(store, doc_id, text) != 0) status = -1;
+    }
+    
+    free(text);
+    free_byte_reader(&reader);
+    fclose(file);
+    return status;
+}
+
+static size_t build_buffer_bytes(const BooleanIndex* index, const DocumentStoreWriter* store, const ByteWriter* documents) {
+    return store->writer.capacity + store->block_capacity + store->block_capacity / 255 + 16 +
+           store->block_table_capacity * sizeof(StoredBlock) + store->document_capacity * sizeof(StoredDocument) +
+           documents->capacity + BYTE_IO_BUFFER_SIZE + (index->count + 1) * sizeof(int);
+}
+
+static size_t document_bytes(const Document* doc, const TokenArray* tokens) {
+    size_t html_bytes = allocation_bytes(doc->original_html ? strlen(doc->original_html) + 1 : 1);
+    size_t text_bytes = allocation_bytes(doc->content ? strlen(doc->content) + 1 : 1);
+    size_t token_bytes = allocation_bytes(tokens->count * sizeof(char*));
+    for (int t = 0; t < tokens->count; t++) {
+        token_bytes += allocation_bytes(strlen(tokens->tokens[t]) + 1);
+    }
+    
+    
+    size_t parse_bytes = 4 * html_bytes;
+    size_t tokenize_bytes = 2 * html_bytes + text_bytes + 2 * token_bytes;
+    return std::max(parse_bytes, tokenize_bytes);
+}
+
+static int flush_run(BooleanIndex* index, const char* index_file, char*** run_files, int* run_count) {
+    char* name = run_file_name(index_file, *run_count);
+    if (!name) return -1;
+    
+    char** new_runs = (char**)realloc(*run_files, (*run_count + 1) * sizeof(char*));
+    if (!new_runs) {
+        free(name);
+        return -1;
+    }
+    *run_files = new_runs;
+    (*run_files)[(*run_count)++] = name;
+    
+    printf("  Writing run %s (%d terms, %.1f MB)\n", name, index->count, index->memory_bytes / (1024.0 * 1024.0));
+    int status = save_index_sorted(index, name);
+    
+    clear_index(index);
+    init_index(index, 1024);
+    return status;
+}
+
+int build_index_spimi_files(char** files, int file_count, const char* index_file, size_t memory_budget) {
+    if (file_count == 0) {
+        printf("No HTML documents found in directory.\n");
+        return -1;
+    }
+    
+    char* documents_path = document_table_name(index_file);
+    FILE* documents_file = documents_path ? fopen(documents_path, "wb") : nullptr;
+    ByteWriter documents;
+    if (!documents_file || init_byte_writer(&documents, documents_file) != 0) {
+        printf("Cannot create document table: %s\n", documents_path ? documents_path : index_file);
+        if (documents_file) fclose(documents_file);
+        free(documents_path);
+        return -1;
+    }
+    
+    char* store_path = document_store_path(index_file);
+    char* store_tmp = store_path ? temporary_name(store_path) : nullptr;
+    DocumentStoreWriter store;
+    if (!store_tmp || open_document_store_writer(&store, store_tmp) != 0) {
+        printf("Cannot create document store: %s\n", store_path ? store_path : index_file);
+        free(store_path);
+        free(store_tmp);
+        free_byte_writer(&documents);
+        fclose(documents_file);
+        remove(documents_path);
+        free(documents_path);
+        return -1;
+    }
+    
+    BooleanIndex index;
+    init_index(&index, 1024);
+    
+    char** run_files = nullptr;
+    int run_count = 0;
+    int status = 0;
+    size_t peak_document_bytes = 0;
+    
+    size_t fixed_bytes = index.memory_bytes + build_buffer_bytes(&index, &store, &documents);
+    if (fixed_bytes >= memory_budget) {
+        printf("Memory budget %.1f MB does not cover the %.1f MB of build buffers\n",
+               memory_budget / (1024.0 * 1024.0), fixed_bytes / (1024.0 * 1024.0));
+        status = -1;
+    }
+    
+    
+    if (status == 0) printf("\nIndexing documents...\n");
+    for (int i = 0; i < file_count && status == 0; i++) {
+        Document doc = parse_html_document(files[i], i + 1);
+        
+        TokenArray tokens = tokenize_text(doc.content);
+        peak_document_bytes = std::max(peak_document_bytes, document_bytes(&doc, &tokens));
+        add_document_to_index(&index, &tokens, doc.id);
+        free_tokens(&tokens);
+        if (add_stored_document(&store, doc.id, doc.content) != 0) status = -1;
+        free(doc.content);
+        
+        DocumentInfo info;
+        keep_document_info(&info, &doc);
+        put_document_record(&documents, &info);
+        free(info.title);
+        free(info.path);
+        
+        if (index.memory_bytes + peak_document_bytes + build_buffer_bytes(&index, &store, &documents) > memory_budget) {
+            status = flush_run(&index, index_file, &run_files, &run_count);
+        }
+        
+        if ((i + 1) % 1000 == 0 || i == file_count - 1) {
+            printf("  Indexed %d/%d documents...\n", i + 1, file_count);
+        }
+    }
+    
+    if (status == 0 && index.count > 0) {
+        status = flush_run(&index, index_file, &run_files, &run_count);
+    }
+    clear_index(&index);
+    if (close_document_store_writer(&store) != 0) status = -1;
+    if (flush_byte_writer(&documents) != 0) status = -1;
+    free_byte_writer(&documents);
+    if (fclose(documents_file) != 0) status = -1;
+    
+    int term_count = -1;
+    if (status == 0) {
+        printf("Merging %d runs...\n", run_count);
+        term_count = merge_index_runs((const char**)run_files, run_count, documents_path, file_count, index_file, memory_budget);
+    }
+    
+    for (int r = 0; r < run_count; r++) {
+        remove(run_files[r]);
+    }
+    free_string_array(run_files, run_count);
+    remove(documents_path);
+    free(documents_path);
+    
+    if (term_count >= 0 && replace_file(store_tmp, store_path) != 0) term_count = -1;
+    if (term_count < 0) remove(store_tmp);
+    free(store_path);
+    free(store_tmp);
+    
+    if (term_count < 0) {
+        printf("Index build failed.\n");
+        return -1;
+    }
+    
+    printf("Index built. Total unique terms: %d\n", term_count);
+    printf("Index saved to: %s\n", index_file);
+    return term_count;
+}
+
+typedef struct {
+    char** files;
+    int begin;
+    int end;
+    BooleanIndex* partial;
+    DocumentInfo* documents;
+    DocumentStoreWriter* store;
+    char* part_file;
+    int* order;
+    int* bounds;
+    int status;
+} IndexSlice;
+
+
+typedef struct {
+    IndexSlice* slices;
+    int slice_count;
+    int range;
+    IndexEntry* entries;
+    int count;
+    int status;
+} TermRange;
+
+static void index_slice(IndexSlice* slice) {
+    init_index(slice->partial, 1024);
+    
+    FILE* part = nullptr;
+    ByteWriter writer;
+    if (!slice->store) {
+        part = slice->part_file ? fopen(slice->part_file, "wb") : nullptr;
+        if (!part || init_byte_writer(&writer, part) != 0) {
+            if (part) fclose(part);
+            slice->status = -1;
+            return;
+        }
+    }
+    
+    for (int i = slice->begin; i < slice->end; i++) {
+        Document doc = parse_html_document(slice->files[i], i + 1);
+        
+        TokenArray tokens = tokenize_text(doc.content);
+        add_document_to_index(slice->partial, &tokens, doc.id);
+        free_tokens(&tokens);
+        
+        if (slice->store) {
+            if (add_stored_document(slice->store, doc.id, doc.content) != 0) slice->status = -1;
+        } else {
+            size_t length = doc.content ? strlen(doc.content) : 0;
+            put_uint32(&writer, doc.id);
+            put_uint32(&writer, (unsigned int)length);
+            put_bytes(&writer, doc.content, length);
+        }
+        free(doc.content);
+        keep_document_info(&slice->documents[i], &doc);
+    }
+    
+    if (part) {
+        if (flush_byte_writer(&writer) != 0) slice->status = -1;
+        free_byte_writer(&writer);
+        if (fclose(part) != 0) slice->status = -1;
+    }
+    
+    BooleanIndex* partial = slice->partial;
+    slice->order = (int*)malloc((partial->count + 1) * sizeof(int));
+    if (!slice->order) {
+        slice->status = -1;
+        return;
+    }
+    
+    for (int e = 0; e < partial->count; e++) {
+        slice->order[e] = e;
+    }
+    
+    IndexEntry* entries = partial->entries;
+    std::sort(slice->order, slice->order + partial->count, [entries](int a, int b) {
+        return strcmp(entries[a].term, entries[b].term) < 0;
+    });
+}
+
+static int find_range_bounds(IndexSlice* slices, int slice_count) {
+    int per_slice = slice_count * 16;
+    std::vector<const char*> samples;
+    
+    for (int p = 0; p < slice_count; p++) {
+        BooleanIndex* partial = slices[p].partial;
+        for (int k = 0; k < per_slice && partial->count > 0; k++) {
+            samples.push_back(partial->entries[slices[p].order[(long long)partial->count * k / per_slice]].term);
+        }
+    }
+    
+    std::sort(samples.begin(), samples.end(), [](const char* a, const char* b) { return strcmp(a, b) < 0; });
+    
+    
+    for (int p = 0; p < slice_count; p++) {
+        slices[p].bounds = (int*)malloc((slice_count + 1) * sizeof(int));
+        if (!slices[p].bounds) return -1;
+        
+        BooleanIndex* partial = slices[p].partial;
+        IndexEntry* entries = partial->entries;
+        slices[p].bounds[0] = 0;
+        slices[p].bounds[slice_count] = partial->count;
+        for (int k = 1; k < slice_count; k++) {
+            if (samples.empty()) {
+                slices[p].bounds[k] = partial->count;
+                continue;
+            }
+            
+            const char* split = samples[samples.size() * k / slice_count];
+            slices[p].bounds[k] = (int)(std::lower_bound(slices[p].order, slices[p].order + partial->count, split, 
+                                                         [entries](int e, const char* term) {
+                return strcmp(entries[e].term, term) < 0;
+            }) - slices[p].order);
+        }
+    }
+    
+    return 0;
+}
+
+static void take_postings(IndexEntry* dst, IndexEntry* src) {
+    free(src->term);
+    src->term = nullptr;
+    
+    memcpy(dst->doc_ids + dst->doc_count, src->doc_ids, src->doc_count * sizeof(int));
+    memcpy(dst->positions + dst->doc_count, src->positions, src->doc_count * sizeof(PositionList));
+    dst->doc_count += src->doc_count;
+    
+    free(src->doc_ids);
+    free(src->positions);
+    src->doc_ids = nullptr;
+    src->positions = nullptr;
+    src->doc_count = 0;
+    src->capacity = 0;
+}
+
+static void merge_term_range(TermRange* range) {
+    IndexSlice* slices = range->slices;
+    int k = range->range;
+    
+    int capacity = 0;
+    for (int p = 0; p < range->slice_count; p++) {
+        capacity += slices[p].bounds[k + 1] - slices[p].bounds[k];
+    }
+    
+    int* cursors = (int*)malloc(range->slice_count * sizeof(int));
+    IndexEntry** group = (IndexEntry**)malloc(range->slice_count * sizeof(IndexEntry*));
+    range->entries = (IndexEntry*)calloc(capacity + 1, sizeof(IndexEntry));
+    if (!cursors || !group || !range->entries) {
+        free(cursors);
+        free(group);
+        range->status = -1;
+        return;
+    }
+    
+    for (int p = 0; p < range->slice_count; p++) {
+        cursors[p] = slices[p].bounds[k];
+    }
+    
+    
+    while (range->status == 0) {
+        const char* term = nullptr;
+        for (int p = 0; p < range->slice_count; p++) {
+            if (cursors[p] == slices[p].bounds[k + 1]) continue;
+            const char* candidate = slices[p].partial->entries[slices[p].order[cursors[p]]].term;
+            if (!term || strcmp(candidate, term) < 0) term = candidate;
+        }
+        if (!term) break;
+        
+        int group_size = 0;
+        int doc_count = 0;
+        for (int p = 0; p < range->slice_count; p++) {
+            if (cursors[p] == slices[p].bounds[k + 1]) continue;
+            IndexEntry* src = &slices[p].partial->entries[slices[p].order[cursors[p]]];
+            if (strcmp(src->term, term) != 0) continue;
+            group[group_size++] = src;
+            doc_count += src->doc_count;
+            cursors[p]++;
+        }
+        
+        IndexEntry* dst = &range->entries[range->count++];
+        if (group_size == 1) {
+            *dst = *group[0];
+            group[0]->term = nullptr;
+            group[0]->doc_ids = nullptr;
+            group[0]->positions = nullptr;
+            group[0]->doc_count = 0;
+            group[0]->capacity = 0;
+            continue;
+        }
+        
+        dst->term = group[0]->term;
+        group[0]->term = nullptr;
+        dst->doc_ids = (int*)malloc(doc_count * sizeof(int));
+        dst->positions = (PositionList*)malloc(doc_count * sizeof(PositionList));
+        dst->capacity = doc_count;
+        if (!dst->doc_ids || !dst->positions) {
+            range->status = -1;
+            break;
+        }
+        
+        for (int g = 0; g < group_size; g++) {
+            take_postings(dst, group[g]);
+        }
+    }
+    
+    free(cursors);
+    free(group);
+}
+
+int build_index_parallel_files(char** files, int file_count, const char* index_file, int thread_count) {
+    if (file_count == 0) {
+        printf("No HTML documents found in directory.\n");
+        return -1;
+    }
+    
+    if (thread_count > file_count) thread_count = file_count;
+    
+    BooleanIndex* partials = (BooleanIndex*)malloc(thread_count * sizeof(BooleanIndex));
+    TermRange* ranges = (TermRange*)calloc(thread_count, sizeof(TermRange));
+    DocumentInfo* documents = (DocumentInfo*)calloc(file_count, sizeof(DocumentInfo));
+    IndexSlice* slices = (IndexSlice*)calloc(thread_count, sizeof(IndexSlice));
+    if (!partials || !ranges || !documents || !slices) {
+        free(partials);
+        free(ranges);
+        free(documents);
+        free(slices);
+        return -1;
+    }
+    
+    char* store_path = document_store_path(index_file);
+    char* store_tmp = store_path ? temporary_name(store_path) : nullptr;
+    DocumentStoreWriter store;
+    if (!store_tmp || open_document_store_writer(&store, store_tmp) != 0) {
+        printf("Cannot create document store: %s\n", store_path ? store_path : index_file);
+        free(store_path);
+        free(store_tmp);
+        free(partials);
+        free(ranges);
+        free(documents);
+        free(slices);
+        return -1;
+    }
+    
+    
+    printf("\nIndexing documents...\n");
+    std::vector<std::thread> workers;
+    for (int t = 0; t < thread_count; t++) {
+        slices[t].files = files;
+        slices[t].begin = (int)((long long)file_count * t / thread_count);
+        slices[t].end = (int)((long long)file_count * (t + 1) / thread_count);
+        slices[t].partial = &partials[t];
+        slices[t].documents = documents;
+        slices[t].store = t == 0 ? &store : nullptr;
+        slices[t].part_file = t == 0 ? nullptr : document_part_name(index_file, t);
+        workers.push_back(std::thread(index_slice, &slices[t]));
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    workers.clear();
+    printf("  Indexed %d/%d documents...\n", file_count, file_count);
+    
+    int status = 0;
+    for (int t = 0; t < thread_count; t++) {
+        if (slices[t].status != 0) status = -1;
+        if (t > 0 && status == 0 && 
+            replay_document_part(&store, slices[t].part_file, slices[t].end - slices[t].begin) != 0) {
+            status = -1;
+        }
+        if (slices[t].part_file) remove(slices[t].part_file);
+        free(slices[t].part_file);
+    }
+    if (close_document_store_writer(&store) != 0) status = -1;
+    
+    
+    if (status == 0 && find_range_bounds(slices, thread_count) != 0) status = -1;
+    
+    if (status == 0) {
+        printf("Merging %d partial indexes...\n", thread_count);
+        for (int t = 0; t < thread_count; t++) {
+            ranges[t].slices = slices;
+            ranges[t].slice_count = thread_count;
+            ranges[t].range = t;
+            workers.push_back(std::thread(merge_term_range, &ranges[t]));
+        }
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+    }
+    
+    int merged_count = 0;
+    for (int t = 0; t < thread_count; t++) {
+        if (ranges[t].status != 0) status = -1;
+        merged_count += ranges[t].count;
+    }
+    
+    
+    BooleanIndex merged;
+    init_index(&merged, merged_count + 1);
+    merged.documents = documents;
+    merged.document_count = file_count;
+    merged.document_capacity = file_count;
+    merged.max_doc_id = file_count;
+    
+    for (int t = 0; t < thread_count; t++) {
+        if (ranges[t].count > 0) {
+            memcpy(merged.entries + merged.count, ranges[t].entries, ranges[t].count * sizeof(IndexEntry));
+            merged.count += ranges[t].count;
+        }
+        free(ranges[t].entries);
+    }
+    
+    if (status == 0 && save_index(&merged, index_file) != 0) status = -1;
+    if (status == 0 && replace_file(store_tmp, store_path) != 0) status = -1;
+    
+    int term_count = -1;
+    if (status == 0) {
+        term_count = merged.count;
+        printf("Index built. Total unique terms: %d\n", term_count);
+        printf("Index saved to: %s\n", index_file);
+    } else {
+        printf("Index build failed.\n");
+        remove(store_tmp);
+    }
+    free(store_path);
+    free(store_tmp);
+    
+    for (int p = 0; p < thread_count; p++) {
+        clear_index(&partials[p]);
+        free(slices[p].order);
+        free(slices[p].bounds);
+    }
+    clear_index(&merged);
+    free(partials);
+    free(ranges);
+    free(slices);
+    
+    return term_count;
+}
+
+
+int build_index_spimi(const char* docs_dir, const char* index_file, size_t memory_budget) {
+    printf("Building index from HTML directory: %s (memory budget %.1f MB)\n", 
+           docs_dir, memory_budget / (1024.0 * 1024.0));
+    
+    int file_count = 0;
+    char** files = list_html_files(docs_dir, &file_count);
+    int term_count = build_index_spimi_files(files, file_count, index_file, memory_budget);
+    free_string_array(files, file_count);
+    return term_count;
+}
+
+int build_index_parallel(const char* docs_dir, const char* index_file, int thread_count) {
+    printf("Building index from HTML directory: %s (%d threads)\n", docs_dir, thread_count);
+    
+    int file_count = 0;
+    char** files = list_html_files(docs_dir, &file_count);
+    int term_count = build_index_parallel_files(files, file_count, index_file, thread_count);
+    free_string_array(files, file_count);
+    return term_count;
+}
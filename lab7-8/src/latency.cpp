@@ -0,0 +1,42 @@
+#include "../include/latency.h"
+#include <cstdio>
+#include <algorithm>
+
+double latency_percentile(const double* sorted, int count, double p) {
+    if (count == 0) return 0.0;
+    
+    int i = (int)(p * (count - 1) + 0.5);
+    return sorted[i];
+}
+
+void print_latency_report(double* latencies_us, int count, double elapsed_seconds) {
+    printf("Completed %d queries in %.2f s: %.0f QPS\n", count, elapsed_seconds, 
+           elapsed_seconds > 0 ? count / elapsed_seconds : 0.0);
+    if (count == 0) return;
+    
+    std::sort(latencies_us, latencies_us + count);
+    printf("Latency us: p50 %.1f, p90 %.1f, p99 %.1f, max %.1f\n", latency_percentile(latencies_us, count, 0.5),
+           latency_percentile(latencies_us, count, 0.9), latency_percentile(latencies_us, count, 0.99), 
+           latencies_us[count - 1]);
+    
+    
+    int buckets[LATENCY_BUCKETS] = {0};
+    for (int i = 0; i < count; i++) {
+        int b = 0;
+        while (b < LATENCY_BUCKETS - 1 && latencies_us[i] >= (double)(2LL << b)) b++;
+        buckets[b]++;
+    }
+    
+    int first = 0, last = LATENCY_BUCKETS - 1, peak = 0;
+    while (buckets[first] == 0) first++;
+    while (buckets[last] == 0) last--;
+    for (int b = first; b <= last; b++) {
+        peak = std::max(peak, buckets[b]);
+    }
+    
+    for (int b = first; b <= last; b++) {
+        int width = (int)((long long)buckets[b] * LATENCY_BAR_WIDTH / peak);
+        if (buckets[b] > 0 && width == 0) width = 1;
+        printf("  < %9lld us %8d |%.*s\n", 2LL << b, buckets[b], width, "########################################");
+    }
+}
@@ -1,5 +1,13 @@
+#include "../include/batch.h"
 #include "../include/boolean_index.h"
 #include "../include/document_parser.h"
+#include "../include/document_store.h"
+#include "../include/index_builder.h"
+#include "../include/query_parser.h"
+#include "../include/ranking.h"
+#include "../include/search.h"
+#include "../include/segments.h"
+#include "../include/server.h"
 #include "../include/tokenizer.h"
 #include "../include/utils.h"
 #include <cstdio>
@@ -9,12 +17,32 @@ void print_help() {
     printf("HTML Boolean Search System\n");
     printf("Usage:\n");
     printf("  build <html_documents_dir> <index_file>  - Build index from HTML documents\n");
+    printf("        [--memory-mb N]                    - Spill sorted runs to disk once postings and build buffers reach N MB\n");
+    printf("        [--threads N]                      - Index document slices on N threads\n");
+    printf("  add <index_file> <dir_or_html_file>...   - Add documents as a new segment, replacing same full paths\n");
+    printf("        [--memory-mb N] [--threads N]\n");
+    printf("  delete <index_file> <html_file>...       - Mark documents deleted in a segmented index\n");
+    printf("  merge <out_index> <index_file>...        - Merge indexes, renumbering docs and dropping deleted ones\n");
     printf("  search <index_file> <query>              - Search in index\n");
+    printf("        query: words, \"phrases\", AND, OR, NOT, NEAR/k, ( )\n");
+    printf("        [--explain]                        - Print the query plan with estimated and actual counts\n");
+    printf("        [--limit K]                        - Stop after the first K matching documents\n");
+    printf("        [--top K]                          - Rank matches by BM25 and show the best K\n");
+    printf("  batch <index_file> <queries_file> <out>  - Run one query per line, write JSON lines, report latency\n");
+    printf("        [--threads N]                      - Run queries on N threads (default 4)\n");
+    printf("        [--cache-mb N]                     - Cache results and term pair intersections in N MB (default 0)\n");
+    printf("  serve <index_file> <address>             - Load the index once and answer queries, one per line\n");
+    printf("        address: /path.sock, unix:path or [host:]port on localhost\n");
+    printf("        [--threads N]                      - Answer connections on N worker threads (default 4)\n");
+    printf("        [--cache-mb N]                     - Cache results and term pair intersections in N MB (default 64)\n");
+    printf("        a line reading STATS returns cache hit, miss and eviction counters\n");
+    printf("  loadgen <address> <queries_file>         - Replay queries against a server and report QPS\n");
+    printf("        [--connections N] [--seconds S]\n");
     printf("  demo                                     - Run demo with test HTML documents\n");
     printf("  stats                                    - Show document statistics\n");
 }
 
-void build_index(const char* docs_dir, const char* index_file) {
+int build_index(const char* docs_dir, const char* index_file) {
     printf("Building index from HTML directory: %s\n", docs_dir);
     
     
@@ -24,7 +52,7 @@ void build_index(const char* docs_dir, const char* index_file) {
     if (docs.count == 0) {
         printf("No HTML documents found in directory.\n");
         free_document_collection(&docs);
-        return;
+        return -1;
     }
     
     
@@ -47,13 +75,8 @@ void build_index(const char* docs_dir, const char* index_file) {
         
         
         TokenArray tokens = tokenize_text(doc->content);
-        
-        
-        for (int j = 0; j < tokens.count; j++) {
-            add_to_index(&index, tokens.tokens[j], doc->id, j);
-        }
-        
-        
+        add_document_to_index(&index, &tokens, doc->id);
+        add_document_info(&index, doc->id, doc->title, doc->filepath, doc->word_count);
         free_tokens(&tokens);
         
         if ((i + 1) % 5 == 0 || i == docs.count - 1) {
@@ -64,86 +87,147 @@ void build_index(const char* docs_dir, const char* index_file) {
     printf("Index built. Total unique terms: %d\n", index.count);
     
     
-    save_index(&index, index_file);
+    if (save_index(&index, index_file) != 0) {
+        printf("Cannot save index to: %s\n", index_file);
+        clear_index(&index);
+        free_document_collection(&docs);
+        return -1;
+    }
     printf("Index saved to: %s\n", index_file);
     
     
-    free_index(&index);
+    char* store_path = document_store_path(index_file);
+    DocumentStoreWriter store;
+    if (!store_path || open_document_store_writer(&store, store_path) != 0) {
+        printf("Cannot create document store: %s\n", store_path ? store_path : index_file);
+        free(store_path);
+        clear_index(&index);
+        free_document_collection(&docs);
+        return -1;
+    }
+    
+    int status = 0;
+    for (int i = 0; i < docs.count && status == 0; i++) {
+        if (add_stored_document(&store, docs.documents[i].id, docs.documents[i].content) != 0) status = -1;
+    }
+    if (close_document_store_writer(&store) != 0) status = -1;
+    
+    if (status == 0) {
+        printf("Document store saved to: %s\n", store_path);
+    } else {
+        printf("Cannot save document store to: %s\n", store_path);
+        remove(store_path);
+    }
+    free(store_path);
+    
+    
+    int term_count = index.count;
+    clear_index(&index);
     free_document_collection(&docs);
+    return status == 0 ? term_count : -1;
 }
 
-void search_index(const char* index_file, const char* query) {
-    printf("Searching for: '%s'\n", query);
+void print_documents(SegmentedIndex* segmented, const int* doc_ids, const float* scores, int count) {
+    printf("Document IDs: ");
+    for (int i = 0; i < count && i < 10; i++) {
+        printf("%d ", doc_ids[i]);
+    }
+    if (count > 10) printf("...");
+    printf("\n");
     
+    for (int i = 0; i < count && i < 10; i++) {
+        DocumentInfo info;
+        if (get_segment_document_info(segmented, doc_ids[i], &info) && scores) {
+            printf("  [%d] %s (%s, %d words) score %.3f\n", info.doc_id, info.title, info.path, info.word_count, scores[i]);
+        } else if (get_segment_document_info(segmented, doc_ids[i], &info)) {
+            printf("  [%d] %s (%s, %d words)\n", info.doc_id, info.title, info.path, info.word_count);
+        }
+        
+        char* text = fetch_segment_document_text(segmented, doc_ids[i]);
+        if (text) {
+            printf("      %.80s%s\n", text, strlen(text) > 80 ? "..." : "");
+            free(text);
+        }
+    }
+}
+
+void print_ranked_documents(SegmentedIndex* segmented, const ScoredDocument* ranked, int count) {
+    int* doc_ids = (int*)malloc(count * sizeof(int));
+    float* scores = (float*)malloc(count * sizeof(float));
     
-    BooleanIndex* index = load_index(index_file);
-    if (!index) {
-        printf("Cannot load index from: %s\n", index_file);
-        return;
+    for (int i = 0; doc_ids && scores && i < count; i++) {
+        doc_ids[i] = ranked[i].doc_id;
+        scores[i] = ranked[i].score;
     }
+    if (doc_ids && scores) print_documents(segmented, doc_ids, scores, count);
     
-    printf("Index loaded. Total terms: %d\n", index->count);
+    free(doc_ids);
+    free(scores);
+}
+
+void search_index(const char* index_file, const char* query, int explain, int limit, int top) {
+    printf("Searching for: '%s'\n", query);
     
     
-    TokenArray query_tokens = tokenize_text(query);
+    QueryNode* tree = parse_query(query);
+    if (!tree) return;
     
-    if (query_tokens.count == 0) {
-        printf("No valid search terms in query.\n");
-        free_index(index);
+    SegmentedIndex* segmented = open_segmented_index(index_file);
+    if (!segmented) {
+        printf("Cannot load index from: %s\n", index_file);
+        free_query(tree);
         return;
     }
     
-    
-    IndexEntry* entry = find_term(index, query_tokens.tokens[0]);
-    if (entry) {
-        printf("\nFound term: '%s'\n", entry->term);
-        printf("Documents containing this term: %d\n", entry->doc_count);
-        
-        printf("Document IDs: ");
-        for (int i = 0; i < entry->doc_count && i < 10; i++) {
-            printf("%d ", entry->doc_ids[i]);
-        }
-        if (entry->doc_count > 10) printf("...");
-        printf("\n");
-    } else {
-        printf("Term not found: '%s'\n", query_tokens.tokens[0]);
+    int term_count = 0;
+    for (int s = 0; s < segmented->count; s++) {
+        term_count += segmented->segments[s].index->count;
     }
+    printf("Index loaded. Segments: %d, terms: %d, live documents: %d\n", 
+           segmented->count, term_count, live_document_count(segmented));
     
     
-    if (query_tokens.count > 1) {
-        printf("\nBoolean AND search for all terms:\n");
-        
-        int result_count = 0;
-        int* results = nullptr;
-        
-        
-        results = boolean_and(index, query_tokens.tokens[0], query_tokens.tokens[1], &result_count);
-        
+    SearchContext context = {tree, explain, 0, limit, top};
+    if (top > 0) {
+        RankingSummary summary;
+        int ranked_count = 0;
+        ScoredDocument* ranked = search_top_documents(segmented, &context, &summary, &ranked_count);
         
-        for (int i = 2; i < query_tokens.count && results; i++) {
-            int* new_results = boolean_and(index, query_tokens.tokens[i], "", &result_count);
-            if (new_results) {
-                free(results);
-                results = new_results;
-            }
-        }
-        
-        if (results && result_count > 0) {
-            printf("Found %d documents with all terms\n", result_count);
-            printf("Document IDs: ");
-            for (int i = 0; i < result_count && i < 10; i++) {
-                printf("%d ", results[i]);
-            }
-            if (result_count > 10) printf("...");
-            printf("\n");
-            free(results);
+        if (ranked && summary.pruned) {
+            printf("\nTop %d by BM25, %d documents scored with block-max MaxScore pruning\n", ranked_count, summary.scored_count);
+            print_ranked_documents(segmented, ranked, ranked_count);
+            free(ranked);
+        } else if (ranked) {
+            printf("\nFound %d documents, top %d by BM25\n", summary.match_count, ranked_count);
+            print_ranked_documents(segmented, ranked, ranked_count);
+            free(ranked);
+        } else if (ranked_count < 0) {
+            printf("\nSearch failed\n");
         } else {
-            printf("No documents found with all terms\n");
+            printf("\nNo documents found\n");
         }
+        
+        free_query(tree);
+        close_segmented_index(segmented);
+        return;
+    }
+    
+    int result_count = 0;
+    int* results = limit > 0 ? search_first_documents(segmented, &context, &result_count)
+                             : search_segments(segmented, query_tree_query, &context, &result_count);
+    
+    if (results && result_count > 0) {
+        printf(limit > 0 ? "\nFirst %d documents\n" : "\nFound %d documents\n", result_count);
+        print_documents(segmented, results, nullptr, result_count);
+        free(results);
+    } else if (result_count < 0) {
+        printf("\nSearch failed\n");
+    } else {
+        printf("\nNo documents found\n");
     }
     
-    free_tokens(&query_tokens);
-    free_index(index);
+    free_query(tree);
+    close_segmented_index(segmented);
 }
 
 void show_stats() {
@@ -275,14 +359,12 @@ void run_demo() {
     for (int i = 0; i < docs.count; i++) {
         Document* doc = &docs.documents[i];
         TokenArray tokens = tokenize_text(doc->content);
-        
-        for (int j = 0; j < tokens.count; j++) {
-            add_to_index(&index, tokens.tokens[j], doc->id, j);
-        }
-        
+        add_document_to_index(&index, &tokens, doc->id);
+        add_document_info(&index, doc->id, doc->title, doc->filepath, doc->word_count);
         free_tokens(&tokens);
     }
     
+    finalize_index(&index);
     printf("Index created. Total unique terms: %d\n\n", index.count);
     
     
@@ -332,8 +414,34 @@ void run_demo() {
         free(phrase_results);
     }
     
+    printf("\n5. Boolean NOT search 'NOT rock':\n");
+    int not_count;
+    int* not_results = boolean_not(&index, "rock", nullptr, &not_count);
+    if (not_results) {
+        printf("   Found %d documents:\n", not_count);
+        for (int i = 0; i < not_count; i++) {
+            DocumentInfo info;
+            if (get_document_info(&index, not_results[i], &info)) {
+                printf("   %d. %s\n", info.doc_id, info.title);
+            }
+        }
+        free(not_results);
+    }
     
-    free_index(&index);
+    printf("\n6. Proximity search 'sack NEAR/3 black':\n");
+    int near_count;
+    int* near_results = near_search(&index, "sack black", 3, &near_count);
+    if (near_results) {
+        printf("   Found %d documents: ", near_count);
+        for (int i = 0; i < near_count; i++) {
+            printf("%d ", near_results[i]);
+        }
+        printf("\n");
+        free(near_results);
+    }
+    
+    
+    clear_index(&index);
     free_document_collection(&docs);
     
     printf("\n=== Demo completed ===\n");
@@ -345,10 +453,136 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    if (strcmp(argv[1], "build") == 0 && argc == 4) {
-        build_index(argv[2], argv[3]);
-    } else if (strcmp(argv[1], "search") == 0 && argc == 4) {
-        search_index(argv[2], argv[3]);
+    if (strcmp(argv[1], "build") == 0 && argc >= 4) {
+        size_t memory_mb = 0;
+        int threads = 1;
+        
+        for (int i = 4; i < argc; i++) {
+            if (strcmp(argv[i], "--memory-mb") == 0 && i + 1 < argc) {
+                memory_mb = strtoul(argv[++i], nullptr, 10);
+            } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                threads = atoi(argv[++i]);
+            } else {
+                print_help();
+                return 1;
+            }
+        }
+        
+        if (memory_mb > 0 && threads > 1) {
+            printf("--memory-mb and --threads cannot be combined\n");
+            return 1;
+        } else if (memory_mb > 0) {
+            if (build_index_spimi(argv[2], argv[3], memory_mb * 1024 * 1024) < 0) return 1;
+        } else if (threads > 1) {
+            if (build_index_parallel(argv[2], argv[3], threads) < 0) return 1;
+        } else {
+            if (build_index(argv[2], argv[3]) < 0) return 1;
+        }
+    } else if (strcmp(argv[1], "add") == 0 && argc >= 4) {
+        size_t memory_mb = 0;
+        int threads = 1;
+        const char** paths = (const char**)malloc(argc * sizeof(const char*));
+        int path_count = 0;
+        if (!paths) return 1;
+        
+        for (int i = 3; i < argc; i++) {
+            if (strcmp(argv[i], "--memory-mb") == 0 && i + 1 < argc) {
+                memory_mb = strtoul(argv[++i], nullptr, 10);
+            } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                threads = atoi(argv[++i]);
+            } else if (strncmp(argv[i], "--", 2) != 0) {
+                paths[path_count++] = argv[i];
+            } else {
+                free(paths);
+                print_help();
+                return 1;
+            }
+        }
+        
+        int status = path_count > 0 ? add_segment(argv[2], paths, path_count, threads, memory_mb * 1024 * 1024) : -1;
+        free(paths);
+        if (path_count == 0) print_help();
+        if (status != 0) return 1;
+    } else if (strcmp(argv[1], "delete") == 0 && argc >= 4) {
+        int deleted = delete_documents(argv[2], (const char**)(argv + 3), argc - 3);
+        if (deleted < 0) return 1;
+        printf("Deleted %d documents\n", deleted);
+    } else if (strcmp(argv[1], "merge") == 0 && argc >= 4) {
+        if (merge_indexes(argv[2], (const char**)(argv + 3), argc - 3) != 0) return 1;
+    } else if (strcmp(argv[1], "search") == 0 && argc >= 4) {
+        int explain = 0;
+        int limit = 0;
+        int top = 0;
+        
+        for (int i = 4; i < argc; i++) {
+            if (strcmp(argv[i], "--explain") == 0) {
+                explain = 1;
+            } else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                limit = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                top = atoi(argv[++i]);
+            } else {
+                print_help();
+                return 1;
+            }
+        }
+        
+        if (limit > 0 && top > 0) {
+            print_help();
+            return 1;
+        }
+        
+        search_index(argv[2], argv[3], explain, limit, top);
+    } else if (strcmp(argv[1], "batch") == 0 && argc >= 5) {
+        int threads = 4;
+        
+        size_t cache_mb = 0;
+        
+        for (int i = 5; i < argc; i++) {
+            if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                threads = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--cache-mb") == 0 && i + 1 < argc) {
+                cache_mb = strtoul(argv[++i], nullptr, 10);
+            } else {
+                print_help();
+                return 1;
+            }
+        }
+        
+        if (run_batch(argv[2], argv[3], argv[4], threads, cache_mb * 1024 * 1024) != 0) return 1;
+    } else if (strcmp(argv[1], "serve") == 0 && argc >= 4) {
+        int threads = 4;
+        
+        size_t cache_mb = 64;
+        
+        for (int i = 4; i < argc; i++) {
+            if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                threads = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--cache-mb") == 0 && i + 1 < argc) {
+                cache_mb = strtoul(argv[++i], nullptr, 10);
+            } else {
+                print_help();
+                return 1;
+            }
+        }
+        
+        if (run_server(argv[2], argv[3], threads, cache_mb * 1024 * 1024) != 0) return 1;
+    } else if (strcmp(argv[1], "loadgen") == 0 && argc >= 4) {
+        int connections = 4;
+        double seconds = 5.0;
+        
+        for (int i = 4; i < argc; i++) {
+            if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                connections = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0) {
+                seconds = atof(argv[++i]);
+            } else {
+                print_help();
+                return 1;
+            }
+        }
+        
+        if (run_load_generator(argv[2], argv[3], connections, seconds) != 0) return 1;
     } else if (strcmp(argv[1], "demo") == 0) {
         run_demo();
     } else if (strcmp(argv[1], "stats") == 0) {
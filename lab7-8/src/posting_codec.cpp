@@ -0,0 +1,435 @@
+#include "../include/posting_codec.h"
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static int bits_needed(unsigned int value) {
+    return value == 0 ? 0 : 32 - __builtin_clz(value);
+}
+
+static size_t write_vbyte(unsigned char* out, unsigned int value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+    return length;
+}
+
+static size_t vbyte_size(unsigned int value) {
+    return value < 0x80 ? 1 : (bits_needed(value) + 6) / 7;
+}
+
+static size_t read_vbyte(const unsigned char* in, unsigned int* value) {
+    unsigned int result = 0;
+    size_t length = 0;
+    int shift = 0;
+    
+    while (in[length] & 0x80) {
+        result |= (unsigned int)(in[length++] & 0x7f) << shift;
+        shift += 7;
+    }
+    result |= (unsigned int)in[length++] << shift;
+    
+    *value = result;
+    return length;
+}
+
+static size_t read_vbyte_bounded(const unsigned char* in, const unsigned char* end, unsigned int* value) {
+    unsigned int result = 0;
+    for (size_t length = 0; in + length < end && length < 5; length++) {
+        result |= (unsigned int)(in[length] & 0x7f) << (7 * length);
+        if (!(in[length] & 0x80)) {
+            *value = result;
+            return length + 1;
+        }
+    }
+    return 0;
+}
+
+
+static size_t vbyte_max_size(int count, int max_value) {
+    (void)max_value;
+    return (size_t)count * 5;
+}
+
+static size_t vbyte_encode(const int* doc_ids, int count, unsigned char* out) {
+    size_t length = 0;
+    int prev = 0;
+    
+    for (int i = 0; i < count; i++) {
+        length += write_vbyte(out + length, doc_ids[i] - prev);
+        prev = doc_ids[i];
+    }
+    
+    return length;
+}
+
+static size_t vbyte_decode(const unsigned char* in, const unsigned char* end, int count, int* doc_ids) {
+    size_t length = 0;
+    int prev = 0;
+    
+    for (int i = 0; i < count; i++) {
+        unsigned int gap;
+        size_t read = read_vbyte_bounded(in + length, end, &gap);
+        if (read == 0) return 0;
+        length += read;
+        prev += gap;
+        doc_ids[i] = prev;
+    }
+    
+    return length;
+}
+
+
+static int ef_low_bits(long count, long universe) {
+    int low_bits = 0;
+    while ((count << (low_bits + 1)) <= universe) {
+        low_bits++;
+    }
+    return low_bits;
+}
+
+static size_t ef_low_bytes(long count, int low_bits) {
+    return (size_t)((count * low_bits + 63) / 64) * 8;
+}
+
+static size_t ef_high_bytes(long count, long universe, int low_bits) {
+    return (size_t)((count + (universe >> low_bits) + 1 + 63) / 64) * 8;
+}
+
+static size_t ef_max_size(int count, int max_value) {
+    long universe = (long)max_value + 1;
+    int low_bits = ef_low_bits(count, universe);
+    return 1 + 5 + ef_low_bytes(count, low_bits) + ef_high_bytes(count, universe, low_bits);
+}
+
+static size_t ef_encode(const int* doc_ids, int count, unsigned char* out) {
+    if (count == 0) return 0;
+    
+    long universe = (long)doc_ids[count - 1] + 1;
+    int low_bits = ef_low_bits(count, universe);
+    
+    size_t header = 0;
+    out[header++] = (unsigned char)low_bits;
+    header += write_vbyte(out + header, (unsigned int)universe);
+    
+    unsigned char* low = out + header;
+    size_t low_bytes = ef_low_bytes(count, low_bits);
+    unsigned char* high = low + low_bytes;
+    size_t high_bytes = ef_high_bytes(count, universe, low_bits);
+    memset(low, 0, low_bytes + high_bytes);
+    
+    uint64_t low_mask = low_bits == 0 ? 0 : ((uint64_t)1 << low_bits) - 1;
+    
+    for (int i = 0; i < count; i++) {
+        uint64_t value = (uint64_t)doc_ids[i];
+        
+        if (low_bits > 0) {
+            long bit = (long)i * low_bits;
+            uint64_t word;
+            memcpy(&word, low + (bit >> 3), 8);
+            word |= (value & low_mask) << (bit & 7);
+            memcpy(low + (bit >> 3), &word, 8);
+        }
+        
+        long high_bit = (long)(value >> low_bits) + i;
+        high[high_bit >> 3] |= (unsigned char)(1 << (high_bit & 7));
+    }
+    
+    return header + low_bytes + high_bytes;
+}
+
+static inline uint64_t load_word(const unsigned char* data, long word) {
+    uint64_t value;
+    memcpy(&value, data + word * 8, 8);
+    return value;
+}
+
+static inline int ef_low_value(const EliasFanoCursor* cursor, int index) {
+    if (cursor->low_bits == 0) return 0;
+    
+    long bit = (long)index * cursor->low_bits;
+    uint64_t word;
+    memcpy(&word, cursor->low + (bit >> 3), 8);
+    return (int)((word >> (bit & 7)) & (((uint64_t)1 << cursor->low_bits) - 1));
+}
+
+void elias_fano_init(EliasFanoCursor* cursor, const unsigned char* data, int count) {
+    unsigned int universe = 0;
+    size_t header = 1;
+    
+    cursor->low_bits = data[0];
+    header += read_vbyte(data + header, &universe);
+    
+    cursor->low = data + header;
+    cursor->high = cursor->low + ef_low_bytes(count, cursor->low_bits);
+    cursor->count = count;
+    cursor->index = -1;
+    cursor->high_pos = -1;
+    cursor->value = -1;
+}
+
+int elias_fano_next_geq(EliasFanoCursor* cursor, int target) {
+    if (cursor->index >= cursor->count) return -1;
+    if (cursor->index >= 0 && cursor->value >= target) return cursor->value;
+    
+    long bucket = target < 0 ? 0 : (long)target >> cursor->low_bits;
+    long pos = cursor->high_pos + 1;
+    int index = cursor->index + 1;
+    
+    while (index < cursor->count) {
+        long word_index = pos >> 6;
+        uint64_t word = load_word(cursor->high, word_index) >> (pos & 63);
+        int remaining = 64 - (int)(pos & 63);
+        int ones = __builtin_popcountll(word);
+        
+        
+        if (pos + remaining - (index + ones) < bucket) {
+            index += ones;
+            pos += remaining;
+            continue;
+        }
+        
+        while (word != 0) {
+            int skip = __builtin_ctzll(word);
+            pos += skip;
+            word >>= skip;
+            
+            long high = pos - index;
+            if (high >= bucket) {
+                int value = (int)((high << cursor->low_bits) | ef_low_value(cursor, index));
+                if (value >= target) {
+                    cursor->index = index;
+                    cursor->high_pos = pos;
+                    cursor->value = value;
+                    return value;
+                }
+            }
+            
+            index++;
+            pos++;
+            word >>= 1;
+            if (index >= cursor->count) break;
+        }
+        
+        pos = (word_index + 1) * 64;
+    }
+    
+    cursor->index = cursor->count;
+    return -1;
+}
+
+static size_t ef_decode(const unsigned char* in, const unsigned char* end, int count, int* doc_ids) {
+    if (count == 0 || in >= end) return 0;
+    
+    unsigned int universe_bound = 0;
+    size_t header = read_vbyte_bounded(in + 1, end, &universe_bound);
+    if (header == 0 || in[0] > 31) return 0;
+    
+    
+    EliasFanoCursor cursor;
+    elias_fano_init(&cursor, in, count);
+    size_t high_bytes = ef_high_bytes(count, universe_bound, cursor.low_bits);
+    if ((size_t)(end - cursor.high) < high_bytes) return 0;
+    long high_words = (long)(high_bytes / 8);
+    
+    long word_index = 0;
+    uint64_t word = load_word(cursor.high, 0);
+    
+    for (int i = 0; i < count; i++) {
+        while (word == 0) {
+            if (++word_index >= high_words) return 0;
+            word = load_word(cursor.high, word_index);
+        }
+        
+        long pos = word_index * 64 + __builtin_ctzll(word);
+        word &= word - 1;
+        doc_ids[i] = (int)(((pos - i) << cursor.low_bits) | ef_low_value(&cursor, i));
+    }
+    
+    long universe = (long)doc_ids[count - 1] + 1;
+    return (cursor.high - in) + ef_high_bytes(count, universe, cursor.low_bits);
+}
+
+
+static size_t bp128_max_size(int count, int max_value) {
+    (void)max_value;
+    return (size_t)(count / BP128_BLOCK_SIZE) * (1 + BP128_BLOCK_SIZE * 4) + (size_t)(count % BP128_BLOCK_SIZE) * 5;
+}
+
+static void bp128_pack(const unsigned int* gaps, int bit_width, unsigned char* out) {
+    unsigned int words[BP128_BLOCK_SIZE];
+    memset(words, 0, sizeof(words));
+    
+    
+    for (int lane = 0; lane < 4; lane++) {
+        for (int j = 0; j < BP128_BLOCK_SIZE / 4; j++) {
+            unsigned int value = gaps[j * 4 + lane];
+            int bit = j * bit_width;
+            int word = bit >> 5;
+            int shift = bit & 31;
+            
+            words[word * 4 + lane] |= value << shift;
+            if (shift + bit_width > 32) {
+                words[(word + 1) * 4 + lane] |= value >> (32 - shift);
+            }
+        }
+    }
+    
+    memcpy(out, words, bit_width * 4 * sizeof(unsigned int));
+}
+
+static void bp128_unpack(const unsigned char* in, int bit_width, unsigned int* gaps) {
+    if (bit_width == 0) {
+        memset(gaps, 0, BP128_BLOCK_SIZE * sizeof(unsigned int));
+        return;
+    }
+    
+#ifdef __SSE2__
+    const __m128i mask = _mm_set1_epi32(bit_width == 32 ? -1 : (int)((1u << bit_width) - 1));
+    const __m128i* src = (const __m128i*)in;
+    __m128i current = _mm_loadu_si128(src++);
+    int shift = 0;
+    
+    for (int j = 0; j < BP128_BLOCK_SIZE / 4; j++) {
+        __m128i value = _mm_srl_epi32(current, _mm_cvtsi32_si128(shift));
+        shift += bit_width;
+        
+        if (shift >= 32 && j + 1 < BP128_BLOCK_SIZE / 4) {
+            shift -= 32;
+            current = _mm_loadu_si128(src++);
+            if (shift > 0) {
+                value = _mm_or_si128(value, _mm_sll_epi32(current, _mm_cvtsi32_si128(bit_width - shift)));
+            }
+        }
+        
+        _mm_storeu_si128((__m128i*)(gaps + j * 4), _mm_and_si128(value, mask));
+    }
+#else
+    unsigned int words[BP128_BLOCK_SIZE];
+    memcpy(words, in, bit_width * 4 * sizeof(unsigned int));
+    unsigned int mask = bit_width == 32 ? 0xffffffffu : (1u << bit_width) - 1;
+    
+    for (int lane = 0; lane < 4; lane++) {
+        for (int j = 0; j < BP128_BLOCK_SIZE / 4; j++) {
+            int bit = j * bit_width;
+            int word = bit >> 5;
+            int shift = bit & 31;
+            
+            unsigned int value = words[word * 4 + lane] >> shift;
+            if (shift + bit_width > 32) {
+                value |= words[(word + 1) * 4 + lane] << (32 - shift);
+            }
+            gaps[j * 4 + lane] = value & mask;
+        }
+    }
+#endif
+}
+
+static size_t bp128_encode(const int* doc_ids, int count, unsigned char* out) {
+    unsigned int gaps[BP128_BLOCK_SIZE];
+    size_t length = 0;
+    int prev = 0;
+    int i = 0;
+    
+    for (; i + BP128_BLOCK_SIZE <= count; i += BP128_BLOCK_SIZE) {
+        unsigned int max_gap = 0;
+        for (int j = 0; j < BP128_BLOCK_SIZE; j++) {
+            gaps[j] = doc_ids[i + j] - prev;
+            prev = doc_ids[i + j];
+            max_gap |= gaps[j];
+        }
+        
+        int bit_width = bits_needed(max_gap);
+        out[length++] = (unsigned char)bit_width;
+        bp128_pack(gaps, bit_width, out + length);
+        length += bit_width * 16;
+    }
+    
+    
+    for (; i < count; i++) {
+        length += write_vbyte(out + length, doc_ids[i] - prev);
+        prev = doc_ids[i];
+    }
+    
+    return length;
+}
+
+static size_t bp128_decode(const unsigned char* in, const unsigned char* end, int count, int* doc_ids) {
+    unsigned int gaps[BP128_BLOCK_SIZE];
+    size_t length = 0;
+    int prev = 0;
+    int i = 0;
+    
+    for (; i + BP128_BLOCK_SIZE <= count; i += BP128_BLOCK_SIZE) {
+        if (in + length >= end) return 0;
+        int bit_width = in[length++];
+        if (bit_width > 32 || (size_t)(end - in - length) < (size_t)bit_width * 16) return 0;
+        bp128_unpack(in + length, bit_width, gaps);
+        length += bit_width * 16;
+        
+        for (int j = 0; j < BP128_BLOCK_SIZE; j++) {
+            prev += gaps[j];
+            doc_ids[i + j] = prev;
+        }
+    }
+    
+    for (; i < count; i++) {
+        unsigned int gap;
+        size_t read = read_vbyte_bounded(in + length, end, &gap);
+        if (read == 0) return 0;
+        length += read;
+        prev += gap;
+        doc_ids[i] = prev;
+    }
+    
+    return length;
+}
+
+
+static const PostingCodec CODECS[CODEC_COUNT] = {
+    {CODEC_VBYTE, "vbyte", vbyte_max_size, vbyte_encode, vbyte_decode},
+    {CODEC_ELIAS_FANO, "elias-fano", ef_max_size, ef_encode, ef_decode},
+    {CODEC_BP128, "bp128", bp128_max_size, bp128_encode, bp128_decode}
+};
+
+const PostingCodec* get_posting_codec(int id) {
+    if (id < 0 || id >= CODEC_COUNT) return nullptr;
+    return &CODECS[id];
+}
+
+const PostingCodec* choose_posting_codec(const int* doc_ids, int count) {
+    if (count < BP128_BLOCK_SIZE / 4) return &CODECS[CODEC_VBYTE];
+    
+    
+    size_t bp128_size = 0;
+    int prev = 0;
+    int i = 0;
+    
+    for (; i + BP128_BLOCK_SIZE <= count; i += BP128_BLOCK_SIZE) {
+        unsigned int max_gap = 0;
+        for (int j = i; j < i + BP128_BLOCK_SIZE; j++) {
+            max_gap |= doc_ids[j] - prev;
+            prev = doc_ids[j];
+        }
+        bp128_size += 1 + bits_needed(max_gap) * 16;
+    }
+    
+    for (; i < count; i++) {
+        bp128_size += vbyte_size(doc_ids[i] - prev);
+        prev = doc_ids[i];
+    }
+    
+    long universe = (long)doc_ids[count - 1] + 1;
+    int low_bits = ef_low_bits(count, universe);
+    size_t ef_size = 1 + vbyte_size((unsigned int)universe) +
+                     ef_low_bytes(count, low_bits) + ef_high_bytes(count, universe, low_bits);
+    
+    return ef_size < bp128_size ? &CODECS[CODEC_ELIAS_FANO] : &CODECS[CODEC_BP128];
+}
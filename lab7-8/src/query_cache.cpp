@@ -0,0 +1,283 @@
+#include "../include/query_cache.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+typedef struct CacheEntry {
+    char* key;
+    unsigned long long hash;
+    ResultSet result;
+    size_t bytes;
+    struct CacheEntry* newer;
+    struct CacheEntry* older;
+    struct CacheEntry* chain;
+} CacheEntry;
+
+
+typedef struct {
+    std::mutex lock;
+    CacheEntry** buckets;
+    int bucket_count;
+    CacheEntry* newest;
+    CacheEntry* oldest;
+    int entries;
+    size_t bytes;
+    size_t budget;
+    unsigned long long* seen;
+    int seen_count;
+    CacheStats stats;
+} CacheShard;
+
+
+struct QueryCache {
+    CacheShard shards[CACHE_SHARDS];
+    size_t budget;
+    int admit_on_second_miss;
+};
+
+static unsigned long long hash_key(const char* key) {
+    unsigned long long hash = 1469598103934665603ULL;
+    for (const unsigned char* p = (const unsigned char*)key; *p; p++) {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static int copy_result(const ResultSet* source, ResultSet* target) {
+    memset(target, 0, sizeof(ResultSet));
+    target->count = source->count;
+    target->match_count = source->match_count;
+    target->scored_count = source->scored_count;
+    target->pruned = source->pruned;
+    if (source->count == 0) return 0;
+    
+    target->doc_ids = (int*)malloc(source->count * sizeof(int));
+    target->scores = source->scores ? (float*)malloc(source->count * sizeof(float)) : nullptr;
+    if (!target->doc_ids || (source->scores && !target->scores)) {
+        free_result_set(target);
+        return -1;
+    }
+    
+    memcpy(target->doc_ids, source->doc_ids, source->count * sizeof(int));
+    if (source->scores) memcpy(target->scores, source->scores, source->count * sizeof(float));
+    return 0;
+}
+
+static void unlink_entry(CacheShard* shard, CacheEntry* entry) {
+    if (entry->newer) entry->newer->older = entry->older; else shard->newest = entry->older;
+    if (entry->older) entry->older->newer = entry->newer; else shard->oldest = entry->newer;
+    entry->newer = entry->older = nullptr;
+}
+
+static void push_newest(CacheShard* shard, CacheEntry* entry) {
+    entry->older = shard->newest;
+    entry->newer = nullptr;
+    if (shard->newest) shard->newest->newer = entry; else shard->oldest = entry;
+    shard->newest = entry;
+}
+
+static CacheShard* shard_for(QueryCache* cache, unsigned long long hash) {
+    return &cache->shards[(hash >> 32) % CACHE_SHARDS];
+}
+
+static CacheEntry** find_slot(CacheShard* shard, const char* key, unsigned long long hash) {
+    CacheEntry** slot = &shard->buckets[hash & (shard->bucket_count - 1)];
+    while (*slot && ((*slot)->hash != hash || strcmp((*slot)->key, key) != 0)) {
+        slot = &(*slot)->chain;
+    }
+    return slot;
+}
+
+static void free_entry(CacheEntry* entry) {
+    free(entry->key);
+    free_result_set(&entry->result);
+    free(entry);
+}
+
+static void evict_oldest(CacheShard* shard) {
+    CacheEntry* victim = shard->oldest;
+    CacheEntry** slot = find_slot(shard, victim->key, victim->hash);
+    *slot = victim->chain;
+    unlink_entry(shard, victim);
+    
+    shard->entries--;
+    shard->bytes -= victim->bytes;
+    shard->stats.evictions++;
+    free_entry(victim);
+}
+
+static void grow_buckets(CacheShard* shard) {
+    int bucket_count = shard->bucket_count * 2;
+    CacheEntry** buckets = (CacheEntry**)calloc(bucket_count, sizeof(CacheEntry*));
+    if (!buckets) return;
+    
+    for (int b = 0; b < shard->bucket_count; b++) {
+        CacheEntry* entry = shard->buckets[b];
+        while (entry) {
+            CacheEntry* next = entry->chain;
+            CacheEntry** slot = &buckets[entry->hash & (bucket_count - 1)];
+            entry->chain = *slot;
+            *slot = entry;
+            entry = next;
+        }
+    }
+    
+    free(shard->buckets);
+    shard->buckets = buckets;
+    shard->bucket_count = bucket_count;
+}
+
+static bool pass_doorkeeper(QueryCache* cache, CacheShard* shard, unsigned long long hash) {
+    if (!cache->admit_on_second_miss) return true;
+    
+    unsigned long long bit = (hash >> 8) % CACHE_DOORKEEPER_BITS;
+    unsigned long long mask = 1ULL << (bit % 64);
+    if (shard->seen[bit / 64] & mask) return true;
+    
+    
+    if (++shard->seen_count > CACHE_DOORKEEPER_BITS / 8) {
+        memset(shard->seen, 0, CACHE_DOORKEEPER_BITS / 8);
+        shard->seen_count = 1;
+    }
+    shard->seen[bit / 64] |= mask;
+    return false;
+}
+
+QueryCache* create_query_cache(size_t budget_bytes, int admit_on_second_miss) {
+    QueryCache* cache = new QueryCache();
+    cache->budget = budget_bytes;
+    cache->admit_on_second_miss = admit_on_second_miss;
+    
+    for (int s = 0; s < CACHE_SHARDS; s++) {
+        CacheShard* shard = &cache->shards[s];
+        shard->buckets = (CacheEntry**)calloc(CACHE_INITIAL_BUCKETS, sizeof(CacheEntry*));
+        shard->bucket_count = CACHE_INITIAL_BUCKETS;
+        shard->newest = shard->oldest = nullptr;
+        shard->entries = 0;
+        shard->bytes = 0;
+        shard->budget = budget_bytes / CACHE_SHARDS;
+        shard->seen = admit_on_second_miss ? (unsigned long long*)calloc(CACHE_DOORKEEPER_BITS / 64, sizeof(unsigned long long)) : nullptr;
+        shard->seen_count = 0;
+        memset(&shard->stats, 0, sizeof(CacheStats));
+        
+        if (!shard->buckets || (admit_on_second_miss && !shard->seen)) {
+            free_query_cache(cache);
+            return nullptr;
+        }
+    }
+    return cache;
+}
+
+void free_query_cache(QueryCache* cache) {
+    if (!cache) return;
+    
+    for (int s = 0; s < CACHE_SHARDS; s++) {
+        CacheShard* shard = &cache->shards[s];
+        CacheEntry* entry = shard->newest;
+        while (entry) {
+            CacheEntry* older = entry->older;
+            free_entry(entry);
+            entry = older;
+        }
+        free(shard->buckets);
+        free(shard->seen);
+    }
+    delete cache;
+}
+
+int cache_lookup(QueryCache* cache, const char* key, ResultSet* result) {
+    memset(result, 0, sizeof(ResultSet));
+    if (!cache) return 0;
+    
+    unsigned long long hash = hash_key(key);
+    CacheShard* shard = shard_for(cache, hash);
+    std::lock_guard<std::mutex> guard(shard->lock);
+    
+    CacheEntry* entry = *find_slot(shard, key, hash);
+    if (!entry || copy_result(&entry->result, result) != 0) {
+        shard->stats.misses++;
+        return 0;
+    }
+    
+    unlink_entry(shard, entry);
+    push_newest(shard, entry);
+    shard->stats.hits++;
+    return 1;
+}
+
+void cache_store(QueryCache* cache, const char* key, const ResultSet* result) {
+    if (!cache) return;
+    
+    unsigned long long hash = hash_key(key);
+    CacheShard* shard = shard_for(cache, hash);
+    size_t bytes = sizeof(CacheEntry) + strlen(key) + 1 + result->count * sizeof(int) + 
+                   (result->scores ? result->count * sizeof(float) : 0);
+    
+    std::lock_guard<std::mutex> guard(shard->lock);
+    if (*find_slot(shard, key, hash)) return;
+    if (bytes > shard->budget || !pass_doorkeeper(cache, shard, hash)) {
+        shard->stats.rejected++;
+        return;
+    }
+    
+    
+    CacheEntry* entry = (CacheEntry*)calloc(1, sizeof(CacheEntry));
+    if (!entry) return;
+    entry->key = strdup(key);
+    entry->hash = hash;
+    entry->bytes = bytes;
+    if (!entry->key || copy_result(result, &entry->result) != 0) {
+        free_entry(entry);
+        return;
+    }
+    
+    while (shard->bytes + bytes > shard->budget && shard->oldest) {
+        evict_oldest(shard);
+    }
+    if (shard->entries >= shard->bucket_count) grow_buckets(shard);
+    
+    CacheEntry** slot = &shard->buckets[hash & (shard->bucket_count - 1)];
+    entry->chain = *slot;
+    *slot = entry;
+    push_newest(shard, entry);
+    
+    shard->entries++;
+    shard->bytes += bytes;
+    shard->stats.inserts++;
+}
+
+void get_cache_stats(QueryCache* cache, CacheStats* stats) {
+    memset(stats, 0, sizeof(CacheStats));
+    if (!cache) return;
+    
+    stats->budget = cache->budget;
+    for (int s = 0; s < CACHE_SHARDS; s++) {
+        CacheShard* shard = &cache->shards[s];
+        std::lock_guard<std::mutex> guard(shard->lock);
+        stats->hits += shard->stats.hits;
+        stats->misses += shard->stats.misses;
+        stats->inserts += shard->stats.inserts;
+        stats->evictions += shard->stats.evictions;
+        stats->rejected += shard->stats.rejected;
+        stats->entries += shard->entries;
+        stats->bytes += shard->bytes;
+    }
+}
+
+int format_cache_stats(QueryCache* cache, const char* name, char* buffer, size_t capacity) {
+    CacheStats stats;
+    get_cache_stats(cache, &stats);
+    
+    unsigned long long lookups = stats.hits + stats.misses;
+    return snprintf(buffer, capacity, "%s cache: %llu hits, %llu misses (%.1f%% hit rate), %llu inserts, "
+                    "%llu evictions, %llu rejected, %d entries, %zu/%zu KB",
+                    name, stats.hits, stats.misses, lookups > 0 ? 100.0 * stats.hits / lookups : 0.0,
+                    stats.inserts, stats.evictions, stats.rejected, stats.entries, stats.bytes / 1024, stats.budget / 1024);
+}
+
+void free_result_set(ResultSet* result) {
+    free(result->doc_ids);
+    free(result->scores);
+    memset(result, 0, sizeof(ResultSet));
+}
@@ -0,0 +1,195 @@
+#include "../include/query_cursor.h"
+#include <cstdlib>
+#include <cstring>
+
+struct QueryCursor {
+    PlanOperator op;
+    QueryPlan* plan;
+    int doc_id;
+    int universe;
+    const int* doc_ids;
+    int* owned;
+    int count;
+    int position;
+    PositionalCursor* positional;
+    QueryCursor** children;
+    int child_count;
+    int positive_count;
+};
+
+QueryCursor* open_cursor(BooleanIndex* index, QueryPlan* plan) {
+    if (!index || !plan) return nullptr;
+    
+    QueryCursor* cursor = (QueryCursor*)calloc(1, sizeof(QueryCursor));
+    if (!cursor) return nullptr;
+    
+    cursor->op = plan->op;
+    cursor->plan = plan;
+    cursor->universe = index->max_doc_id;
+    plan->actual = 0;
+    
+    if (plan->op == PLAN_TERM) {
+        IndexEntry* entry = find_term(index, plan->node->text);
+        cursor->doc_ids = entry ? entry->doc_ids : nullptr;
+        cursor->count = entry ? entry->doc_count : 0;
+    } else if (plan->op == PLAN_PHRASE) {
+        cursor->positional = open_phrase_cursor(index, plan->node->text);
+    } else if (plan->op == PLAN_NEAR) {
+        cursor->positional = open_near_cursor(index, plan->node->text, plan->node->distance);
+    } else if (plan->op == PLAN_WILDCARD) {
+        cursor->owned = execute_plan(index, plan, &cursor->count);
+        cursor->doc_ids = cursor->owned;
+        plan->actual = 0;
+        if (cursor->count < 0) {
+            close_cursor(cursor);
+            return nullptr;
+        }
+    }
+    
+    if (plan->op == PLAN_COMPLEMENT || plan->op == PLAN_INTERSECT || plan->op == PLAN_UNION) {
+        cursor->children = (QueryCursor**)calloc(plan->child_count, sizeof(QueryCursor*));
+        if (!cursor->children) {
+            close_cursor(cursor);
+            return nullptr;
+        }
+        
+        for (int i = 0; i < plan->child_count; i++) {
+            cursor->children[i] = open_cursor(index, plan->children[i]);
+            if (!cursor->children[i]) {
+                close_cursor(cursor);
+                return nullptr;
+            }
+            cursor->child_count++;
+            if (!plan->children[i]->negated) cursor->positive_count++;
+        }
+    }
+    
+    return cursor;
+}
+
+static int advance_intersect(QueryCursor* cursor, int target) {
+    QueryCursor** children = cursor->children;
+    int candidate = target;
+    
+    while (candidate <= cursor->universe) {
+        if (cursor->positive_count > 0) candidate = cursor_advance(children[0], candidate);
+        if (candidate == CURSOR_END) return CURSOR_END;
+        
+        
+        bool matched = true;
+        for (int i = 1; i < cursor->positive_count && matched; i++) {
+            int doc_id = cursor_advance(children[i], candidate);
+            matched = doc_id == candidate;
+            candidate = doc_id;
+        }
+        if (!matched) continue;
+        
+        for (int i = cursor->positive_count; i < cursor->child_count && matched; i++) {
+            matched = cursor_advance(children[i], candidate) != candidate;
+        }
+        if (matched) return candidate;
+        candidate++;
+    }
+    
+    return CURSOR_END;
+}
+
+static int advance_union(QueryCursor* cursor, int target) {
+    int best = CURSOR_END;
+    for (int i = 0; i < cursor->child_count; i++) {
+        QueryCursor* child = cursor->children[i];
+        int doc_id = child->doc_id < target ? cursor_advance(child, target) : child->doc_id;
+        if (doc_id < best) best = doc_id;
+    }
+    return best;
+}
+
+static int advance_complement(QueryCursor* cursor, int target) {
+    for (int doc_id = target; doc_id <= cursor->universe; doc_id++) {
+        if (cursor_advance(cursor->children[0], doc_id) != doc_id) return doc_id;
+    }
+    return CURSOR_END;
+}
+
+int cursor_advance(QueryCursor* cursor, int target) {
+    if (target <= cursor->doc_id) return cursor->doc_id;
+    
+    int doc_id = CURSOR_END;
+    switch (cursor->op) {
+        case PLAN_EMPTY:
+            break;
+        case PLAN_TERM:
+        case PLAN_WILDCARD:
+            cursor->position = gallop_to(cursor->doc_ids, cursor->position, cursor->count, target);
+            if (cursor->position < cursor->count) doc_id = cursor->doc_ids[cursor->position];
+            break;
+        case PLAN_PHRASE:
+        case PLAN_NEAR:
+            if (cursor->positional) doc_id = positional_cursor_advance(cursor->positional, target);
+            break;
+        case PLAN_COMPLEMENT:
+            doc_id = advance_complement(cursor, target);
+            break;
+        case PLAN_INTERSECT:
+            doc_id = advance_intersect(cursor, target);
+            break;
+        case PLAN_UNION:
+            doc_id = advance_union(cursor, target);
+            break;
+    }
+    
+    if (doc_id != CURSOR_END) cursor->plan->actual++;
+    cursor->doc_id = doc_id;
+    return doc_id;
+}
+
+int cursor_next(QueryCursor* cursor) {
+    if (cursor->doc_id == CURSOR_END) return CURSOR_END;
+    return cursor_advance(cursor, cursor->doc_id + 1);
+}
+
+int* collect_cursor(QueryCursor* cursor, int limit, int* result_count) {
+    *result_count = 0;
+    if (!cursor) return nullptr;
+    
+    int capacity = limit > 0 && limit < 64 ? limit : 64;
+    int* result = (int*)malloc(capacity * sizeof(int));
+    int k = 0;
+    
+    while (result && (limit <= 0 || k < limit)) {
+        int doc_id = cursor_next(cursor);
+        if (doc_id == CURSOR_END) break;
+        
+        if (k == capacity) {
+            capacity *= 2;
+            int* grown = (int*)realloc(result, capacity * sizeof(int));
+            if (!grown) {
+                free(result);
+                return nullptr;
+            }
+            result = grown;
+        }
+        result[k++] = doc_id;
+    }
+    
+    if (k == 0) {
+        free(result);
+        return nullptr;
+    }
+    
+    *result_count = k;
+    return result;
+}
+
+void close_cursor(QueryCursor* cursor) {
+    if (!cursor) return;
+    
+    for (int i = 0; i < cursor->child_count; i++) {
+        close_cursor(cursor->children[i]);
+    }
+    
+    close_positional_cursor(cursor->positional);
+    free(cursor->owned);
+    free(cursor->children);
+    free(cursor);
+}
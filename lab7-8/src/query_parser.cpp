@@ -0,0 +1,382 @@
+#include "../include/query_parser.h"
+#include "../include/tokenizer.h"
+#include "../include/utils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+typedef enum {
+    TOKEN_WORD,
+    TOKEN_PHRASE,
+    TOKEN_LPAREN,
+    TOKEN_RPAREN,
+    TOKEN_AND,
+    TOKEN_OR,
+    TOKEN_NOT,
+    TOKEN_NEAR,
+    TOKEN_END
+} QueryTokenType;
+
+
+typedef struct {
+    const char* pos;
+    QueryTokenType type;
+    char* text;
+    int distance;
+    int error;
+} QueryParser;
+
+static void query_error(QueryParser* parser, const char* message) {
+    if (!parser->error) {
+        printf("Query error: %s\n", message);
+    }
+    parser->error = 1;
+}
+
+static bool is_word_char(char c) {
+    return c != '\0' && c != ' ' && c != '\t' && c != '\n' && c != '(' && c != ')' && c != '"';
+}
+
+static void next_token(QueryParser* parser) {
+    free(parser->text);
+    parser->text = nullptr;
+    
+    const char* p = parser->pos;
+    while (*p == ' ' || *p == '\t' || *p == '\n') p++;
+    
+    if (*p == '\0') {
+        parser->type = TOKEN_END;
+        parser->pos = p;
+        return;
+    }
+    
+    if (*p == '(' || *p == ')') {
+        parser->type = *p == '(' ? TOKEN_LPAREN : TOKEN_RPAREN;
+        parser->pos = p + 1;
+        return;
+    }
+    
+    
+    const char* start = p;
+    if (*p == '"') {
+        start = ++p;
+        while (*p && *p != '"') p++;
+        if (*p != '"') query_error(parser, "unterminated phrase");
+        
+        parser->type = TOKEN_PHRASE;
+        parser->text = strndup(start, p - start);
+        parser->pos = *p ? p + 1 : p;
+        return;
+    }
+    
+    while (is_word_char(*p)) p++;
+    parser->text = strndup(start, p - start);
+    parser->pos = p;
+    parser->type = TOKEN_WORD;
+    
+    if (strcmp(parser->text, "AND") == 0) {
+        parser->type = TOKEN_AND;
+    } else if (strcmp(parser->text, "OR") == 0) {
+        parser->type = TOKEN_OR;
+    } else if (strcmp(parser->text, "NOT") == 0) {
+        parser->type = TOKEN_NOT;
+    } else if (strncmp(parser->text, "NEAR/", 5) == 0) {
+        char* end = nullptr;
+        long distance = strtol(parser->text + 5, &end, 10);
+        if (end != parser->text + 5 && *end == '\0' && distance >= 0 && distance < 1000000) {
+            parser->type = TOKEN_NEAR;
+            parser->distance = (int)distance;
+        }
+    }
+}
+
+static QueryNode* new_node(QueryNodeType type, const char* text) {
+    QueryNode* node = (QueryNode*)calloc(1, sizeof(QueryNode));
+    if (!node) return nullptr;
+    
+    node->type = type;
+    node->text = text ? strdup(text) : nullptr;
+    return node;
+}
+
+static int add_child(QueryNode* parent, QueryNode* child) {
+    if (parent->child_count == parent->child_capacity) {
+        int new_capacity = parent->child_capacity == 0 ? 2 : parent->child_capacity * 2;
+        QueryNode** children = (QueryNode**)realloc(parent->children, new_capacity * sizeof(QueryNode*));
+        if (!children) return -1;
+        parent->children = children;
+        parent->child_capacity = new_capacity;
+    }
+    
+    parent->children[parent->child_count++] = child;
+    return 0;
+}
+
+static QueryNode* combine_nodes(QueryParser* parser, QueryNodeType type, QueryNode* left, QueryNode* right) {
+    if (!left) return right;
+    if (!right) return left;
+    
+    
+    QueryNode* node = left->type == type ? left : new_node(type, nullptr);
+    if (!node || (node != left && add_child(node, left) != 0)) {
+        query_error(parser, "out of memory");
+        free_query(left);
+        free_query(right);
+        return nullptr;
+    }
+    
+    if (right->type == type) {
+        for (int i = 0; i < right->child_count; i++) {
+            if (add_child(node, right->children[i]) != 0) query_error(parser, "out of memory");
+        }
+        right->child_count = 0;
+        free_query(right);
+    } else if (add_child(node, right) != 0) {
+        query_error(parser, "out of memory");
+        free_query(right);
+    }
+    
+    return node;
+}
+
+static QueryNode* text_node(const char* text) {
+    TokenArray tokens = tokenize_text(text);
+    if (tokens.count == 0) return nullptr;
+    
+    if (tokens.count == 1) {
+        QueryNode* node = new_node(QUERY_TERM, tokens.tokens[0]);
+        free_tokens(&tokens);
+        return node;
+    }
+    
+    
+    size_t length = 0;
+    for (int i = 0; i < tokens.count; i++) {
+        length += strlen(tokens.tokens[i]) + 1;
+    }
+    
+    char* joined = (char*)malloc(length);
+    size_t used = 0;
+    for (int i = 0; joined && i < tokens.count; i++) {
+        used += snprintf(joined + used, length - used, i == 0 ? "%s" : " %s", tokens.tokens[i]);
+    }
+    
+    QueryNode* node = joined ? new_node(QUERY_PHRASE, joined) : nullptr;
+    free(joined);
+    free_tokens(&tokens);
+    return node;
+}
+
+static QueryNode* wildcard_node(QueryParser* parser, const char* text) {
+    if (strspn(text, "*") == strlen(text)) {
+        query_error(parser, "wildcard needs at least one letter");
+        return nullptr;
+    }
+    
+    QueryNode* node = new_node(QUERY_WILDCARD, text);
+    if (!node) return nullptr;
+    
+    to_lowercase(node->text);
+    char* out = node->text;
+    for (const char* p = node->text; *p; p++) {
+        if (*p != '*' || out == node->text || out[-1] != '*') *out++ = *p;
+    }
+    *out = '\0';
+    return node;
+}
+
+static QueryNode* parse_or(QueryParser* parser);
+
+static QueryNode* parse_primary(QueryParser* parser) {
+    if (parser->type == TOKEN_WORD && strchr(parser->text, '*')) {
+        QueryNode* node = wildcard_node(parser, parser->text);
+        next_token(parser);
+        return node;
+    }
+    
+    if (parser->type == TOKEN_WORD || parser->type == TOKEN_PHRASE) {
+        QueryNode* node = text_node(parser->text);
+        next_token(parser);
+        return node;
+    }
+    
+    if (parser->type == TOKEN_LPAREN) {
+        next_token(parser);
+        QueryNode* node = parse_or(parser);
+        if (parser->type != TOKEN_RPAREN) {
+            query_error(parser, "missing ')'");
+        } else {
+            next_token(parser);
+        }
+        return node;
+    }
+    
+    query_error(parser, parser->type == TOKEN_END ? "unexpected end of query" : "expected a word, phrase or '('");
+    return nullptr;
+}
+
+static QueryNode* parse_near(QueryParser* parser) {
+    QueryNode* left = parse_primary(parser);
+    
+    while (parser->type == TOKEN_NEAR && !parser->error) {
+        int distance = parser->distance;
+        next_token(parser);
+        QueryNode* right = parse_primary(parser);
+        
+        
+        bool words = left && right && right->type == QUERY_TERM &&
+                     (left->type == QUERY_TERM || (left->type == QUERY_NEAR && left->distance == distance));
+        if (!words) {
+            query_error(parser, "NEAR/k joins single words with one distance");
+            free_query(right);
+            break;
+        }
+        
+        size_t length = strlen(left->text) + strlen(right->text) + 2;
+        char* joined = (char*)malloc(length);
+        if (!joined) {
+            query_error(parser, "out of memory");
+            free_query(right);
+            break;
+        }
+        snprintf(joined, length, "%s %s", left->text, right->text);
+        
+        free(left->text);
+        left->text = joined;
+        left->type = QUERY_NEAR;
+        left->distance = distance;
+        free_query(right);
+    }
+    
+    return left;
+}
+
+static QueryNode* parse_unary(QueryParser* parser) {
+    if (parser->type != TOKEN_NOT) return parse_near(parser);
+    
+    next_token(parser);
+    QueryNode* child = parse_unary(parser);
+    if (!child) return nullptr;
+    
+    
+    if (child->type == QUERY_NOT) {
+        QueryNode* inner = child->children[0];
+        child->child_count = 0;
+        free_query(child);
+        return inner;
+    }
+    
+    QueryNode* node = new_node(QUERY_NOT, nullptr);
+    if (!node || add_child(node, child) != 0) {
+        query_error(parser, "out of memory");
+        free_query(node);
+        free_query(child);
+        return nullptr;
+    }
+    return node;
+}
+
+static QueryNode* parse_and(QueryParser* parser) {
+    QueryNode* left = parse_unary(parser);
+    
+    while (!parser->error) {
+        if (parser->type == TOKEN_AND) {
+            next_token(parser);
+        } else if (parser->type != TOKEN_WORD && parser->type != TOKEN_PHRASE &&
+                   parser->type != TOKEN_LPAREN && parser->type != TOKEN_NOT) {
+            break;
+        }
+        
+        left = combine_nodes(parser, QUERY_AND, left, parse_unary(parser));
+    }
+    
+    return left;
+}
+
+static QueryNode* parse_or(QueryParser* parser) {
+    QueryNode* left = parse_and(parser);
+    
+    while (parser->type == TOKEN_OR && !parser->error) {
+        next_token(parser);
+        left = combine_nodes(parser, QUERY_OR, left, parse_and(parser));
+    }
+    
+    return left;
+}
+
+QueryNode* parse_query(const char* query) {
+    if (!query) return nullptr;
+    
+    QueryParser parser;
+    memset(&parser, 0, sizeof(QueryParser));
+    parser.pos = query;
+    next_token(&parser);
+    
+    QueryNode* root = parse_or(&parser);
+    if (!parser.error && parser.type != TOKEN_END) {
+        query_error(&parser, parser.type == TOKEN_RPAREN ? "unbalanced ')'" : "unexpected operator");
+    }
+    if (!parser.error && !root) {
+        printf("No valid search terms in query.\n");
+    }
+    
+    free(parser.text);
+    if (parser.error) {
+        free_query(root);
+        return nullptr;
+    }
+    return root;
+}
+
+void free_query(QueryNode* node) {
+    if (!node) return;
+    
+    for (int i = 0; i < node->child_count; i++) {
+        free_query(node->children[i]);
+    }
+    
+    free(node->children);
+    free(node->text);
+    free(node);
+}
+
+char* normalize_query(const QueryNode* node) {
+    if (!node) return nullptr;
+    
+    if (node->type == QUERY_TERM || node->type == QUERY_PHRASE || node->type == QUERY_NEAR || node->type == QUERY_WILDCARD) {
+        size_t length = strlen(node->text) + 24;
+        char* text = (char*)malloc(length);
+        if (!text) return nullptr;
+        
+        if (node->type == QUERY_TERM) snprintf(text, length, "%s", node->text);
+        else if (node->type == QUERY_WILDCARD) snprintf(text, length, "WILDCARD(%s)", node->text);
+        else if (node->type == QUERY_PHRASE) snprintf(text, length, "\"%s\"", node->text);
+        else snprintf(text, length, "NEAR/%d(%s)", node->distance, node->text);
+        return text;
+    }
+    
+    
+    char** parts = (char**)calloc(node->child_count, sizeof(char*));
+    size_t length = 8;
+    bool failed = !parts;
+    for (int i = 0; !failed && i < node->child_count; i++) {
+        parts[i] = normalize_query(node->children[i]);
+        if (!parts[i]) failed = true; else length += strlen(parts[i]) + 1;
+    }
+    
+    char* text = failed ? nullptr : (char*)malloc(length);
+    if (text) {
+        std::sort(parts, parts + node->child_count, [](const char* a, const char* b) { return strcmp(a, b) < 0; });
+        
+        const char* name = node->type == QUERY_AND ? "AND" : node->type == QUERY_OR ? "OR" : "NOT";
+        size_t used = snprintf(text, length, "%s(", name);
+        for (int i = 0; i < node->child_count; i++) {
+            used += snprintf(text + used, length - used, i == 0 ? "%s" : ",%s", parts[i]);
+        }
+        snprintf(text + used, length - used, ")");
+    }
+    
+    free_string_array(parts, node->child_count);
+    return text;
+}
@@ -0,0 +1,708 @@
+#include "../include/query_planner.h"
+#include "../include/query_cache.h"
+#include "../include/term_dictionary.h"
+#include "../include/tokenizer.h"
+#include "../include/simd_kernels.h"
+#include "../include/roaring.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+typedef struct {
+    const int* doc_ids;
+    int count;
+    int* owned;
+    IndexEntry* entry;
+} DocList;
+
+
+typedef struct {
+    const int* doc_ids;
+    int position;
+    int count;
+} UnionCursor;
+
+static QueryPlan* new_plan(PlanOperator op, QueryNode* node, int child_capacity) {
+    QueryPlan* plan = (QueryPlan*)calloc(1, sizeof(QueryPlan));
+    if (!plan) return nullptr;
+    
+    plan->op = op;
+    plan->node = node;
+    plan->actual = -1;
+    if (child_capacity > 0) {
+        plan->children = (QueryPlan**)calloc(child_capacity, sizeof(QueryPlan*));
+        if (!plan->children) {
+            free(plan);
+            return nullptr;
+        }
+    }
+    return plan;
+}
+
+static int rarest_frequency(BooleanIndex* index, const char* text) {
+    TokenArray tokens = tokenize_text(text);
+    int rarest = 0;
+    for (int i = 0; i < tokens.count; i++) {
+        int frequency = document_frequency(index, tokens.tokens[i]);
+        if (i == 0 || frequency < rarest) rarest = frequency;
+    }
+    free_tokens(&tokens);
+    return rarest;
+}
+
+static QueryPlan* plan_node(BooleanIndex* index, QueryNode* node, double universe);
+
+static QueryPlan* plan_intersect(BooleanIndex* index, QueryNode* node, double universe) {
+    QueryPlan* plan = new_plan(PLAN_INTERSECT, node, node->child_count);
+    if (!plan) return nullptr;
+    
+    for (int i = 0; i < node->child_count; i++) {
+        QueryNode* child = node->children[i];
+        bool negated = child->type == QUERY_NOT;
+        QueryPlan* child_plan = plan_node(index, negated ? child->children[0] : child, universe);
+        if (!child_plan) {
+            free_plan(plan);
+            return nullptr;
+        }
+        child_plan->negated = negated;
+        plan->children[plan->child_count++] = child_plan;
+    }
+    
+    
+    std::stable_sort(plan->children, plan->children + plan->child_count, [](const QueryPlan* a, const QueryPlan* b) {
+        if (a->negated != b->negated) return !a->negated;
+        return a->negated ? a->estimate > b->estimate : a->estimate < b->estimate;
+    });
+    
+    double estimate = universe;
+    for (int i = 0; i < plan->child_count; i++) {
+        QueryPlan* child = plan->children[i];
+        double selectivity = universe > 0 ? child->estimate / universe : 0;
+        estimate *= child->negated ? 1 - selectivity : selectivity;
+        if (!child->negated && child->op == PLAN_EMPTY) plan->op = PLAN_EMPTY;
+    }
+    plan->estimate = plan->op == PLAN_EMPTY ? 0 : estimate;
+    return plan;
+}
+
+static QueryPlan* plan_union(BooleanIndex* index, QueryNode* node, double universe) {
+    QueryPlan* plan = new_plan(PLAN_UNION, node, node->child_count);
+    if (!plan) return nullptr;
+    
+    double missed = 1;
+    double total = 0;
+    int live = 0;
+    for (int i = 0; i < node->child_count; i++) {
+        QueryPlan* child_plan = plan_node(index, node->children[i], universe);
+        if (!child_plan) {
+            free_plan(plan);
+            return nullptr;
+        }
+        plan->children[plan->child_count++] = child_plan;
+        
+        if (child_plan->op == PLAN_EMPTY) continue;
+        missed *= universe > 0 ? 1 - child_plan->estimate / universe : 1;
+        total += child_plan->estimate;
+        live++;
+    }
+    
+    plan->estimate = universe * (1 - missed);
+    if (live == 0) {
+        plan->op = PLAN_EMPTY;
+        plan->estimate = 0;
+    } else if (live <= 2) {
+        plan->strategy = UNION_PAIR;
+    } else {
+        plan->strategy = total > universe / 16 ? UNION_BITMAP : UNION_HEAP;
+    }
+    return plan;
+}
+
+static QueryPlan* plan_wildcard(BooleanIndex* index, QueryNode* node, double universe) {
+    QueryPlan* plan = new_plan(PLAN_WILDCARD, node, 0);
+    if (!plan) return nullptr;
+    
+    plan->terms = expand_wildcard(get_term_dictionary(index), node->text, &plan->term_count);
+    double total = 0;
+    for (int i = 0; i < plan->term_count; i++) {
+        total += document_frequency_at(index, plan->terms[i]);
+    }
+    
+    plan->estimate = std::min(total, universe);
+    plan->strategy = total > universe / 16 ? UNION_BITMAP : UNION_HEAP;
+    return plan;
+}
+
+static QueryPlan* plan_node(BooleanIndex* index, QueryNode* node, double universe) {
+    QueryPlan* plan = nullptr;
+    
+    switch (node->type) {
+        case QUERY_TERM:
+            plan = new_plan(PLAN_TERM, node, 0);
+            if (plan) plan->estimate = document_frequency(index, node->text);
+            break;
+        case QUERY_PHRASE:
+        case QUERY_NEAR:
+            plan = new_plan(node->type == QUERY_PHRASE ? PLAN_PHRASE : PLAN_NEAR, node, 0);
+            if (plan) plan->estimate = rarest_frequency(index, node->text);
+            break;
+        case QUERY_NOT:
+            plan = new_plan(PLAN_COMPLEMENT, node, 1);
+            if (plan) {
+                plan->children[0] = plan_node(index, node->children[0], universe);
+                if (!plan->children[0]) {
+                    free_plan(plan);
+                    return nullptr;
+                }
+                plan->child_count = 1;
+                plan->estimate = universe - plan->children[0]->estimate;
+            }
+            return plan;
+        case QUERY_AND:
+            return plan_intersect(index, node, universe);
+        case QUERY_OR:
+            return plan_union(index, node, universe);
+        case QUERY_WILDCARD:
+            plan = plan_wildcard(index, node, universe);
+            break;
+    }
+    
+    if (plan && plan->estimate == 0) plan->op = PLAN_EMPTY;
+    return plan;
+}
+
+QueryPlan* plan_query(BooleanIndex* index, QueryNode* node) {
+    if (!index || !node) return nullptr;
+    return plan_node(index, node, index->max_doc_id);
+}
+
+void free_plan(QueryPlan* plan) {
+    if (!plan) return;
+    
+    for (int i = 0; i < plan->child_count; i++) {
+        free_plan(plan->children[i]);
+    }
+    
+    free(plan->children);
+    free(plan->terms);
+    free(plan);
+}
+
+static int execute_node(BooleanIndex* index, QueryPlan* plan, DocList* list);
+
+static void free_doc_list(DocList* list) {
+    free(list->owned);
+    memset(list, 0, sizeof(DocList));
+}
+
+static void own_result(DocList* list, int* result, int count) {
+    list->owned = result;
+    list->doc_ids = result;
+    list->count = result ? count : 0;
+}
+
+static int* universe_array(int universe) {
+    int* result = universe > 0 ? (int*)malloc(universe * sizeof(int)) : nullptr;
+    for (int i = 0; result && i < universe; i++) {
+        result[i] = i + 1;
+    }
+    return result;
+}
+
+static int complement_list(BooleanIndex* index, QueryPlan* child, DocList* list) {
+    if (child->op == PLAN_TERM) {
+        int count = 0;
+        int* result = boolean_not(index, child->node->text, nullptr, &count);
+        child->actual = (int)child->estimate;
+        own_result(list, result, count);
+        return 0;
+    }
+    
+    DocList inner;
+    if (execute_node(index, child, &inner) != 0) return -1;
+    
+    int universe = index->max_doc_id;
+    int* result = universe > 0 ? (int*)malloc(universe * sizeof(int)) : nullptr;
+    int k = 0;
+    int j = 0;
+    for (int doc_id = 1; result && doc_id <= universe; doc_id++) {
+        if (j < inner.count && inner.doc_ids[j] == doc_id) {
+            j++;
+        } else {
+            result[k++] = doc_id;
+        }
+    }
+    
+    free_doc_list(&inner);
+    own_result(list, result, k);
+    return universe > 0 && !result ? -1 : 0;
+}
+
+static int subtract_list(const int* doc_ids, int count, DocList* excluded, int* out) {
+    int k = 0;
+    int j = 0;
+    
+    if (excluded->entry && excluded->entry->bitmap) {
+        for (int i = 0; i < count; i++) {
+            if (!roaring_contains(excluded->entry->bitmap, doc_ids[i])) out[k++] = doc_ids[i];
+        }
+        return k;
+    }
+    
+    bool gallop = count * (long)GALLOP_RATIO <= excluded->count;
+    for (int i = 0; i < count; i++) {
+        int doc_id = doc_ids[i];
+        if (gallop) {
+            j = gallop_to(excluded->doc_ids, j, excluded->count, doc_id);
+        } else {
+            while (j < excluded->count && excluded->doc_ids[j] < doc_id) j++;
+        }
+        if (j == excluded->count || excluded->doc_ids[j] != doc_id) out[k++] = doc_id;
+    }
+    
+    return k;
+}
+
+static char* term_pair_key(BooleanIndex* index, QueryPlan* plan) {
+    if (!index->intersection_cache || plan->child_count < 2) return nullptr;
+    
+    QueryPlan* a = plan->children[0];
+    QueryPlan* b = plan->children[1];
+    if (a->op != PLAN_TERM || b->op != PLAN_TERM || a->negated || b->negated) return nullptr;
+    
+    const char* low = strcmp(a->node->text, b->node->text) < 0 ? a->node->text : b->node->text;
+    const char* high = low == a->node->text ? b->node->text : a->node->text;
+    size_t length = strlen(low) + strlen(high) + 24;
+    char* key = (char*)malloc(length);
+    if (key) snprintf(key, length, "%p %s %s", (void*)index, low, high);
+    return key;
+}
+
+static int execute_intersect(BooleanIndex* index, QueryPlan* plan, DocList* list) {
+    DocList first;
+    memset(&first, 0, sizeof(DocList));
+    int* universe = nullptr;
+    const int* current = nullptr;
+    int current_count = 0;
+    int status = 0;
+    int step = 0;
+    
+    char* pair_key = term_pair_key(index, plan);
+    ResultSet pair;
+    if (pair_key && cache_lookup(index->intersection_cache, pair_key, &pair)) {
+        own_result(&first, pair.doc_ids, pair.count);
+        current = first.doc_ids;
+        current_count = first.count;
+        step = 2;
+        free(pair_key);
+        pair_key = nullptr;
+    } else if (!plan->children[0]->negated) {
+        status = execute_node(index, plan->children[0], &first);
+        current = first.doc_ids;
+        current_count = first.count;
+        step = 1;
+    } else if (index->max_doc_id > 0) {
+        universe = universe_array(index->max_doc_id);
+        current = universe;
+        current_count = universe ? index->max_doc_id : 0;
+        if (!universe) status = -1;
+    }
+    
+    
+    int capacity = current_count + SIMD_OUTPUT_SLACK;
+    int* buffers[2] = {nullptr, nullptr};
+    int next = 0;
+    
+    for (; status == 0 && current_count > 0 && step < plan->child_count; step++) {
+        QueryPlan* child = plan->children[step];
+        if (child->op == PLAN_EMPTY) {
+            child->actual = 0;
+            continue;
+        }
+        
+        if (!buffers[next]) buffers[next] = (int*)malloc(capacity * sizeof(int));
+        int* out = buffers[next];
+        DocList other;
+        if (!out || execute_node(index, child, &other) != 0) {
+            status = -1;
+            break;
+        }
+        
+        if (child->negated) {
+            current_count = subtract_list(current, current_count, &other, out);
+        } else if (other.entry) {
+            current_count = intersect_list_with_entry(current, current_count, other.entry, out);
+        } else {
+            current_count = intersect_into(current, current_count, other.doc_ids, other.count, out);
+        }
+        free_doc_list(&other);
+        
+        current = out;
+        next ^= 1;
+        
+        if (pair_key && step == 1) {
+            ResultSet computed = {(int*)current, nullptr, current_count, current_count, current_count, 0};
+            cache_store(index->intersection_cache, pair_key, &computed);
+        }
+    }
+    
+    if (status == 0 && current_count > 0 && current != buffers[next ^ 1]) {
+        if (!buffers[next ^ 1]) buffers[next ^ 1] = (int*)malloc(capacity * sizeof(int));
+        if (buffers[next ^ 1]) {
+            memcpy(buffers[next ^ 1], current, current_count * sizeof(int));
+        } else {
+            status = -1;
+        }
+        current = buffers[next ^ 1];
+    }
+    
+    free_doc_list(&first);
+    free(universe);
+    free(pair_key);
+    
+    
+    int* result = current_count > 0 && current == buffers[next ^ 1] ? buffers[next ^ 1] : nullptr;
+    free(buffers[next]);
+    if (!result) free(buffers[next ^ 1]);
+    
+    if (status != 0) {
+        free(result);
+        return -1;
+    }
+    
+    own_result(list, result, result ? current_count : 0);
+    return 0;
+}
+
+static bool union_cursor_less(const UnionCursor* a, const UnionCursor* b) {
+    return a->doc_ids[a->position] < b->doc_ids[b->position];
+}
+
+static void sift_down_union(UnionCursor** heap, int size, int i) {
+    while (true) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = 2 * i + 2;
+        if (left < size && union_cursor_less(heap[left], heap[smallest])) smallest = left;
+        if (right < size && union_cursor_less(heap[right], heap[smallest])) smallest = right;
+        if (smallest == i) return;
+        
+        UnionCursor* tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static int* heap_union(DocList* lists, int list_count, long total, int* result_count) {
+    *result_count = 0;
+    
+    UnionCursor* cursors = (UnionCursor*)malloc(list_count * sizeof(UnionCursor));
+    UnionCursor** heap = (UnionCursor**)malloc(list_count * sizeof(UnionCursor*));
+    int* result = (int*)malloc(total * sizeof(int));
+    if (!cursors || !heap || !result) {
+        free(cursors);
+        free(heap);
+        free(result);
+        return nullptr;
+    }
+    
+    int heap_size = 0;
+    for (int i = 0; i < list_count; i++) {
+        if (lists[i].count == 0) continue;
+        cursors[i].doc_ids = lists[i].doc_ids;
+        cursors[i].position = 0;
+        cursors[i].count = lists[i].count;
+        heap[heap_size++] = &cursors[i];
+    }
+    for (int i = heap_size / 2 - 1; i >= 0; i--) {
+        sift_down_union(heap, heap_size, i);
+    }
+    
+    int k = 0;
+    while (heap_size > 0) {
+        UnionCursor* top = heap[0];
+        int doc_id = top->doc_ids[top->position++];
+        if (k == 0 || result[k - 1] != doc_id) result[k++] = doc_id;
+        
+        if (top->position == top->count) heap[0] = heap[--heap_size];
+        sift_down_union(heap, heap_size, 0);
+    }
+    
+    free(cursors);
+    free(heap);
+    *result_count = k;
+    return result;
+}
+
+static int* bitmap_union(DocList* lists, int list_count, int universe, int* result_count) {
+    *result_count = 0;
+    
+    int words = universe / 64 + 1;
+    unsigned long long* bits = (unsigned long long*)calloc(words, sizeof(unsigned long long));
+    int* result = bits ? (int*)malloc(universe * sizeof(int)) : nullptr;
+    if (!result) {
+        free(bits);
+        return nullptr;
+    }
+    
+    for (int i = 0; i < list_count; i++) {
+        for (int j = 0; j < lists[i].count; j++) {
+            int doc_id = lists[i].doc_ids[j];
+            if (doc_id > 0 && doc_id <= universe) bits[doc_id / 64] |= 1ULL << (doc_id % 64);
+        }
+    }
+    
+    int k = 0;
+    for (int w = 0; w < words; w++) {
+        unsigned long long word = bits[w];
+        while (word) {
+            result[k++] = w * 64 + __builtin_ctzll(word);
+            word &= word - 1;
+        }
+    }
+    
+    free(bits);
+    *result_count = k;
+    return result;
+}
+
+static int execute_union(BooleanIndex* index, QueryPlan* plan, DocList* list) {
+    DocList* lists = (DocList*)calloc(plan->child_count, sizeof(DocList));
+    if (!lists) return -1;
+    
+    int status = 0;
+    int live = 0;
+    long total = 0;
+    for (int i = 0; i < plan->child_count && status == 0; i++) {
+        QueryPlan* child = plan->children[i];
+        if (child->op == PLAN_EMPTY) {
+            child->actual = 0;
+            continue;
+        }
+        status = execute_node(index, child, &lists[live]);
+        total += lists[live++].count;
+    }
+    
+    if (status == 0 && live == 1) {
+        *list = lists[0];
+        free(lists);
+        return 0;
+    }
+    
+    
+    int universe = index->max_doc_id;
+    if (plan->strategy != UNION_PAIR) plan->strategy = total > universe / 16 ? UNION_BITMAP : UNION_HEAP;
+    
+    int* result = nullptr;
+    int k = 0;
+    if (status == 0 && total > 0) {
+        if (plan->strategy == UNION_PAIR) {
+            result = union_sorted_arrays((int*)lists[0].doc_ids, lists[0].count,
+                                         (int*)lists[1].doc_ids, lists[1].count, &k);
+        } else if (plan->strategy == UNION_BITMAP) {
+            result = bitmap_union(lists, live, universe, &k);
+        } else {
+            result = heap_union(lists, live, total, &k);
+        }
+        if (!result) status = -1;
+    }
+    
+    for (int i = 0; i < live; i++) {
+        free_doc_list(&lists[i]);
+    }
+    free(lists);
+    
+    if (status != 0) return -1;
+    own_result(list, result, k);
+    return 0;
+}
+
+static int execute_wildcard(BooleanIndex* index, QueryPlan* plan, DocList* list) {
+    DocList* lists = (DocList*)calloc(plan->term_count, sizeof(DocList));
+    if (!lists) return -1;
+    
+    long total = 0;
+    int live = 0;
+    for (int i = 0; i < plan->term_count; i++) {
+        IndexEntry* entry = index_entry_at(index, plan->terms[i]);
+        if (!entry || entry->doc_count == 0) continue;
+        lists[live].doc_ids = entry->doc_ids;
+        lists[live].count = entry->doc_count;
+        lists[live++].entry = entry;
+        total += entry->doc_count;
+    }
+    
+    if (live == 1) {
+        *list = lists[0];
+        free(lists);
+        return 0;
+    }
+    
+    
+    int universe = index->max_doc_id;
+    plan->strategy = total > universe / 16 ? UNION_BITMAP : UNION_HEAP;
+    
+    int k = 0;
+    int* result = nullptr;
+    if (total > 0) {
+        result = plan->strategy == UNION_BITMAP ? bitmap_union(lists, live, universe, &k) : heap_union(lists, live, total, &k);
+        if (!result) {
+            free(lists);
+            return -1;
+        }
+    }
+    
+    free(lists);
+    own_result(list, result, k);
+    return 0;
+}
+
+static int execute_node(BooleanIndex* index, QueryPlan* plan, DocList* list) {
+    memset(list, 0, sizeof(DocList));
+    int count = 0;
+    int* result = nullptr;
+    int status = 0;
+    
+    switch (plan->op) {
+        case PLAN_EMPTY:
+            break;
+        case PLAN_TERM:
+            list->entry = find_term(index, plan->node->text);
+            if (list->entry) {
+                list->doc_ids = list->entry->doc_ids;
+                list->count = list->entry->doc_count;
+            }
+            break;
+        case PLAN_PHRASE:
+            result = phrase_search(index, plan->node->text, &count);
+            own_result(list, result, count);
+            break;
+        case PLAN_NEAR:
+            result = near_search(index, plan->node->text, plan->node->distance, &count);
+            own_result(list, result, count);
+            break;
+        case PLAN_COMPLEMENT:
+            status = complement_list(index, plan->children[0], list);
+            break;
+        case PLAN_INTERSECT:
+            status = execute_intersect(index, plan, list);
+            break;
+        case PLAN_UNION:
+            status = execute_union(index, plan, list);
+            break;
+        case PLAN_WILDCARD:
+            status = execute_wildcard(index, plan, list);
+            break;
+    }
+    
+    plan->actual = list->count;
+    return status;
+}
+
+int* execute_plan(BooleanIndex* index, QueryPlan* plan, int* result_count) {
+    *result_count = 0;
+    if (!index || !plan) return nullptr;
+    
+    DocList list;
+    if (execute_node(index, plan, &list) != 0) {
+        *result_count = -1;
+        return nullptr;
+    }
+    
+    int* result = list.owned;
+    if (!result && list.count > 0) {
+        result = (int*)malloc(list.count * sizeof(int));
+        if (!result) {
+            *result_count = -1;
+            return nullptr;
+        }
+        memcpy(result, list.doc_ids, list.count * sizeof(int));
+    }
+    
+    if (!result || list.count == 0) {
+        free(result);
+        return nullptr;
+    }
+    
+    *result_count = list.count;
+    return result;
+}
+
+int* evaluate_query(BooleanIndex* index, QueryNode* node, int* result_count) {
+    *result_count = 0;
+    
+    QueryPlan* plan = plan_query(index, node);
+    if (!plan) {
+        *result_count = -1;
+        return nullptr;
+    }
+    
+    int* result = execute_plan(index, plan, result_count);
+    free_plan(plan);
+    return result;
+}
+
+static const char* plan_label(QueryPlan* plan) {
+    if (plan->op == PLAN_EMPTY && plan->node->type != QUERY_AND && plan->node->type != QUERY_OR) return "missing";
+    
+    switch (plan->op) {
+        case PLAN_INTERSECT:
+            return "intersect";
+        case PLAN_UNION:
+            if (plan->strategy == UNION_HEAP) return "union heap merge";
+            if (plan->strategy == UNION_BITMAP) return "union bitmap";
+            return "union";
+        case PLAN_COMPLEMENT:
+            return "complement";
+        case PLAN_TERM:
+            return "postings";
+        case PLAN_PHRASE:
+        case PLAN_NEAR:
+            return "positions";
+        case PLAN_WILDCARD:
+            return plan->strategy == UNION_BITMAP ? "wildcard bitmap" : "wildcard heap merge";
+        default:
+            return "empty";
+    }
+}
+
+void print_plan(QueryPlan* plan, int depth) {
+    if (!plan) return;
+    
+    printf("%*s%s", depth * 2, "", plan->negated ? "AND NOT " : "");
+    switch (plan->node->type) {
+        case QUERY_TERM:
+            printf("TERM %s", plan->node->text);
+            break;
+        case QUERY_PHRASE:
+            printf("PHRASE \"%s\"", plan->node->text);
+            break;
+        case QUERY_NEAR:
+            printf("NEAR/%d \"%s\"", plan->node->distance, plan->node->text);
+            break;
+        case QUERY_NOT:
+            printf("NOT");
+            break;
+        case QUERY_AND:
+            printf("AND");
+            break;
+        case QUERY_OR:
+            printf("OR");
+            break;
+        case QUERY_WILDCARD:
+            printf("WILDCARD %s (%d terms)", plan->node->text, plan->term_count);
+            break;
+    }
+    
+    if (plan->actual < 0) {
+        printf(" [%s] est=%.1f actual=skipped\n", plan_label(plan), plan->estimate);
+    } else {
+        printf(" [%s] est=%.1f actual=%d\n", plan_label(plan), plan->estimate, plan->actual);
+    }
+    
+    for (int i = 0; i < plan->child_count; i++) {
+        print_plan(plan->children[i], depth + 1);
+    }
+}
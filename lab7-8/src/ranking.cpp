@@ -0,0 +1,426 @@
+#include "../include/ranking.h"
+#include "../include/simd_kernels.h"
+#include "../include/term_dictionary.h"
+#include "../include/tokenizer.h"
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+static int add_ranking_term(RankingStats* stats, const char* term, int* capacity) {
+    for (int i = 0; i < stats->term_count; i++) {
+        if (strcmp(stats->terms[i], term) == 0) return 0;
+    }
+    
+    if (stats->term_count == *capacity) {
+        int new_capacity = *capacity == 0 ? 8 : *capacity * 2;
+        char** terms = (char**)realloc(stats->terms, new_capacity * sizeof(char*));
+        if (!terms) return -1;
+        stats->terms = terms;
+        *capacity = new_capacity;
+    }
+    
+    stats->terms[stats->term_count] = strdup(term);
+    if (!stats->terms[stats->term_count]) return -1;
+    stats->term_count++;
+    return 0;
+}
+
+static int collect_wildcard_terms(RankingStats* stats, QueryNode* node, BooleanIndex** indexes, int index_count, int* capacity) {
+    int added = 0;
+    for (int s = 0; s < index_count && added < WILDCARD_RANKED_TERMS; s++) {
+        int count = 0;
+        int* terms = expand_wildcard(get_term_dictionary(indexes[s]), node->text, &count);
+        
+        int status = 0;
+        for (int i = 0; i < count && added < WILDCARD_RANKED_TERMS && status == 0; i++) {
+            IndexEntry* entry = index_entry_at(indexes[s], terms[i]);
+            if (!entry) continue;
+            int before = stats->term_count;
+            status = add_ranking_term(stats, entry->term, capacity);
+            added += stats->term_count - before;
+        }
+        
+        free(terms);
+        if (status != 0) return -1;
+    }
+    return 0;
+}
+
+static int collect_ranking_terms(RankingStats* stats, QueryNode* node, BooleanIndex** indexes, int index_count, int* capacity) {
+    if (node->type == QUERY_NOT) return 0;
+    
+    if (node->type == QUERY_WILDCARD) return collect_wildcard_terms(stats, node, indexes, index_count, capacity);
+    
+    if (node->type == QUERY_TERM) return add_ranking_term(stats, node->text, capacity);
+    
+    if (node->type == QUERY_PHRASE || node->type == QUERY_NEAR) {
+        TokenArray tokens = tokenize_text(node->text);
+        int status = 0;
+        for (int i = 0; i < tokens.count && status == 0; i++) {
+            status = add_ranking_term(stats, tokens.tokens[i], capacity);
+        }
+        free_tokens(&tokens);
+        return status;
+    }
+    
+    for (int i = 0; i < node->child_count; i++) {
+        if (collect_ranking_terms(stats, node->children[i], indexes, index_count, capacity) != 0) return -1;
+    }
+    return 0;
+}
+
+static int indexed_document_count(BooleanIndex* index) {
+    int count = index->mapped ? index->mapped->document_count : index->document_count;
+    return count > 0 ? count : index->max_doc_id;
+}
+
+int init_ranking_stats(RankingStats* stats, QueryNode* tree, BooleanIndex** indexes, int index_count) {
+    memset(stats, 0, sizeof(RankingStats));
+    if (!tree) return -1;
+    
+    int capacity = 0;
+    if (collect_ranking_terms(stats, tree, indexes, index_count, &capacity) != 0) {
+        free_ranking_stats(stats);
+        return -1;
+    }
+    
+    
+    long long total_length = 0;
+    for (int s = 0; s < index_count; s++) {
+        if (!get_document_lengths(indexes[s])) {
+            free_ranking_stats(stats);
+            return -1;
+        }
+        stats->document_count += indexed_document_count(indexes[s]);
+        total_length += indexes[s]->total_length;
+    }
+    stats->average_length = stats->document_count > 0 ? (double)total_length / stats->document_count : 0.0;
+    
+    stats->idf = (float*)malloc((stats->term_count + 1) * sizeof(float));
+    if (!stats->idf) {
+        free_ranking_stats(stats);
+        return -1;
+    }
+    
+    for (int t = 0; t < stats->term_count; t++) {
+        long long frequency = 0;
+        for (int s = 0; s < index_count; s++) {
+            frequency += document_frequency(indexes[s], stats->terms[t]);
+        }
+        stats->idf[t] = (float)log(1.0 + (stats->document_count - frequency + 0.5) / (frequency + 0.5));
+    }
+    
+    return 0;
+}
+
+void free_ranking_stats(RankingStats* stats) {
+    for (int i = 0; i < stats->term_count; i++) {
+        free(stats->terms[i]);
+    }
+    
+    free(stats->terms);
+    free(stats->idf);
+    memset(stats, 0, sizeof(RankingStats));
+}
+
+void score_documents(BooleanIndex* index, const RankingStats* stats, const int* doc_ids, int count, float* scores) {
+    memset(scores, 0, count * sizeof(float));
+    
+    const int* lengths = get_document_lengths(index);
+    IndexEntry** entries = (IndexEntry**)malloc((stats->term_count + 1) * sizeof(IndexEntry*));
+    int* cursors = (int*)calloc(stats->term_count + 1, sizeof(int));
+    if (!lengths || !entries || !cursors) {
+        free(entries);
+        free(cursors);
+        return;
+    }
+    
+    for (int t = 0; t < stats->term_count; t++) {
+        entries[t] = find_term(index, stats->terms[t]);
+    }
+    
+    
+    float base = BM25_K1 * (1.0f - BM25_B);
+    float slope = stats->average_length > 0 ? (float)(BM25_K1 * BM25_B / stats->average_length) : 0.0f;
+    float norms[SCORE_BLOCK];
+    float tf[SCORE_BLOCK];
+    
+    for (int start = 0; start < count; start += SCORE_BLOCK) {
+        int block = count - start < SCORE_BLOCK ? count - start : SCORE_BLOCK;
+        const int* block_ids = doc_ids + start;
+        
+        for (int i = 0; i < block; i++) {
+            int doc_id = block_ids[i];
+            norms[i] = base + slope * (doc_id >= 1 && doc_id <= index->max_doc_id ? lengths[doc_id] : 0);
+        }
+        
+        for (int t = 0; t < stats->term_count; t++) {
+            IndexEntry* entry = entries[t];
+            if (!entry) continue;
+            
+            bool gallop = (long)count * GALLOP_RATIO <= entry->doc_count;
+            int j = cursors[t];
+            for (int i = 0; i < block; i++) {
+                if (gallop) {
+                    j = gallop_to(entry->doc_ids, j, entry->doc_count, block_ids[i]);
+                } else {
+                    while (j < entry->doc_count && entry->doc_ids[j] < block_ids[i]) j++;
+                }
+                bool present = j < entry->doc_count && entry->doc_ids[j] == block_ids[i];
+                tf[i] = present ? (float)entry->positions[j].count : 0.0f;
+            }
+            cursors[t] = j;
+            score_kernel(tf, norms, block, stats->idf[t] * (BM25_K1 + 1.0f), scores + start);
+        }
+    }
+    
+    free(entries);
+    free(cursors);
+}
+
+typedef struct {
+    IndexEntry* entry;
+    int term;
+    int position;
+    int doc_id;
+    int block;
+    float weight;
+    float max_score;
+} ScoreCursor;
+
+int is_term_disjunction(QueryNode* tree) {
+    if (!tree) return 0;
+    if (tree->type == QUERY_TERM) return 1;
+    if (tree->type != QUERY_OR) return 0;
+    
+    for (int i = 0; i < tree->child_count; i++) {
+        if (tree->children[i]->type != QUERY_TERM) return 0;
+    }
+    return 1;
+}
+
+static bool has_block_bounds(const IndexEntry* entry) {
+    return entry->skip_max_tf && entry->skip_count == (entry->doc_count + SKIP_INTERVAL - 1) / SKIP_INTERVAL;
+}
+
+int prefers_pruning(BooleanIndex* index, const RankingStats* stats, int k) {
+    int lists = 0;
+    long long postings = 0;
+    for (int t = 0; t < stats->term_count; t++) {
+        IndexEntry* entry = find_term(index, stats->terms[t]);
+        if (!entry || entry->doc_count == 0) continue;
+        if (!has_block_bounds(entry)) return 0;
+        lists++;
+        postings += entry->doc_count;
+    }
+    
+    return lists >= PRUNE_MIN_TERMS && postings >= (long long)k * PRUNE_MIN_POSTINGS_PER_RESULT;
+}
+
+static float term_bound(float weight, int tf, float norm) {
+    return weight * tf / (tf + norm) * SCORE_BOUND_SLACK;
+}
+
+static void seek_score_cursor(ScoreCursor* cursor, int target) {
+    IndexEntry* entry = cursor->entry;
+    cursor->position = gallop_to(entry->doc_ids, cursor->position, entry->doc_count, target);
+    cursor->doc_id = cursor->position < entry->doc_count ? entry->doc_ids[cursor->position] : CURSOR_END;
+}
+
+static float block_bound(ScoreCursor* cursor, int target, float norm) {
+    IndexEntry* entry = cursor->entry;
+    cursor->block = gallop_to(entry->skip_doc_ids, cursor->block, entry->skip_count, target);
+    if (cursor->block == entry->skip_count) return 0.0f;
+    return term_bound(cursor->weight, entry->skip_max_tf[cursor->block], norm);
+}
+
+static bool lower_max_score(const ScoreCursor& a, const ScoreCursor& b) {
+    return a.max_score < b.max_score;
+}
+
+static float heap_threshold(TopKHeap* heap) {
+    return heap->count < heap->capacity ? -1.0f : heap->items[0].score;
+}
+
+static bool beats_threshold(TopKHeap* heap, float score, int doc_id) {
+    if (heap->count < heap->capacity) return true;
+    return score > heap->items[0].score || (score == heap->items[0].score && doc_id < heap->items[0].doc_id);
+}
+
+int rank_term_disjunction(BooleanIndex* index, const RankingStats* stats, const unsigned long long* live, 
+                          int doc_base, TopKHeap* heap) {
+    const int* lengths = get_document_lengths(index);
+    ScoreCursor* cursors = (ScoreCursor*)malloc((stats->term_count + 1) * sizeof(ScoreCursor));
+    float* prefix_bounds = (float*)malloc((stats->term_count + 1) * sizeof(float));
+    float* contributions = (float*)calloc(stats->term_count + 1, sizeof(float));
+    if (!lengths || !cursors || !prefix_bounds || !contributions || heap->capacity == 0) {
+        free(cursors);
+        free(prefix_bounds);
+        free(contributions);
+        return -1;
+    }
+    
+    float base = BM25_K1 * (1.0f - BM25_B);
+    float slope = stats->average_length > 0 ? (float)(BM25_K1 * BM25_B / stats->average_length) : 0.0f;
+    float min_norm = base + slope * index->min_length;
+    
+    int count = 0;
+    for (int t = 0; t < stats->term_count; t++) {
+        IndexEntry* entry = find_term(index, stats->terms[t]);
+        if (!entry || entry->doc_count == 0) continue;
+        if (!has_block_bounds(entry)) {
+            free(cursors);
+            free(prefix_bounds);
+            free(contributions);
+            return -1;
+        }
+        
+        ScoreCursor* cursor = &cursors[count++];
+        cursor->entry = entry;
+        cursor->term = t;
+        cursor->position = 0;
+        cursor->doc_id = entry->doc_ids[0];
+        cursor->block = 0;
+        cursor->weight = stats->idf[t] * (BM25_K1 + 1.0f);
+        
+        int max_tf = 1;
+        for (int b = 0; b < entry->skip_count; b++) {
+            if (entry->skip_max_tf[b] > max_tf) max_tf = entry->skip_max_tf[b];
+        }
+        cursor->max_score = term_bound(cursor->weight, max_tf, min_norm);
+    }
+    
+    
+    std::stable_sort(cursors, cursors + count, lower_max_score);
+    float running = 0.0f;
+    for (int i = 0; i < count; i++) {
+        running += cursors[i].max_score;
+        prefix_bounds[i] = running;
+    }
+    
+    int essential = 0;
+    int scored = 0;
+    while (essential < count) {
+        float threshold = heap_threshold(heap);
+        while (essential < count && prefix_bounds[essential] <= threshold) essential++;
+        if (essential == count) break;
+        
+        int doc_id = CURSOR_END;
+        for (int i = essential; i < count; i++) {
+            if (cursors[i].doc_id < doc_id) doc_id = cursors[i].doc_id;
+        }
+        if (doc_id == CURSOR_END) break;
+        
+        
+        float norm = base + slope * (doc_id <= index->max_doc_id ? lengths[doc_id] : 0);
+        float partial = 0.0f;
+        for (int i = essential; i < count; i++) {
+            if (cursors[i].doc_id != doc_id) continue;
+            
+            float tf = (float)cursors[i].entry->positions[cursors[i].position].count;
+            contributions[cursors[i].term] = cursors[i].weight * tf / (tf + norm);
+            partial += contributions[cursors[i].term] * SCORE_BOUND_SLACK;
+            seek_score_cursor(&cursors[i], doc_id + 1);
+        }
+        
+        
+        bool pruned = false;
+        for (int i = essential - 1; i >= 0 && !pruned; i--) {
+            float rest = i > 0 ? prefix_bounds[i - 1] : 0.0f;
+            pruned = partial + prefix_bounds[i] <= threshold ||
+                     partial + block_bound(&cursors[i], doc_id, min_norm) + rest <= threshold;
+            if (pruned) break;
+            
+            seek_score_cursor(&cursors[i], doc_id);
+            if (cursors[i].doc_id != doc_id) continue;
+            
+            float tf = (float)cursors[i].entry->positions[cursors[i].position].count;
+            contributions[cursors[i].term] = cursors[i].weight * tf / (tf + norm);
+            partial += contributions[cursors[i].term] * SCORE_BOUND_SLACK;
+        }
+        
+        float score = 0.0f;
+        for (int t = 0; t < stats->term_count; t++) {
+            score += contributions[t];
+            contributions[t] = 0.0f;
+        }
+        if (pruned) continue;
+        
+        bool alive = !live || ((live[doc_id / 64] >> (doc_id % 64)) & 1);
+        if (!alive) continue;
+        scored++;
+        if (beats_threshold(heap, score, doc_base + doc_id)) offer_top_k(heap, doc_base + doc_id, score);
+    }
+    
+    free(cursors);
+    free(prefix_bounds);
+    free(contributions);
+    return scored;
+}
+
+int init_top_k(TopKHeap* heap, int k) {
+    heap->items = k > 0 ? (ScoredDocument*)malloc(k * sizeof(ScoredDocument)) : nullptr;
+    heap->count = 0;
+    heap->capacity = heap->items ? k : 0;
+    return heap->items ? 0 : -1;
+}
+
+static bool ranks_higher(const ScoredDocument& a, const ScoredDocument& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.doc_id < b.doc_id;
+}
+
+static void sift_down_top_k(ScoredDocument* items, int size, int i) {
+    while (true) {
+        int lowest = i;
+        int left = 2 * i + 1;
+        int right = 2 * i + 2;
+        if (left < size && ranks_higher(items[lowest], items[left])) lowest = left;
+        if (right < size && ranks_higher(items[lowest], items[right])) lowest = right;
+        if (lowest == i) return;
+        
+        ScoredDocument tmp = items[i];
+        items[i] = items[lowest];
+        items[lowest] = tmp;
+        i = lowest;
+    }
+}
+
+void offer_top_k(TopKHeap* heap, int doc_id, float score) {
+    ScoredDocument candidate = {doc_id, score};
+    
+    if (heap->count < heap->capacity) {
+        int i = heap->count++;
+        heap->items[i] = candidate;
+        while (i > 0 && ranks_higher(heap->items[(i - 1) / 2], heap->items[i])) {
+            ScoredDocument tmp = heap->items[i];
+            heap->items[i] = heap->items[(i - 1) / 2];
+            heap->items[(i - 1) / 2] = tmp;
+            i = (i - 1) / 2;
+        }
+        return;
+    }
+    
+    if (heap->count == 0 || !ranks_higher(candidate, heap->items[0])) return;
+    heap->items[0] = candidate;
+    sift_down_top_k(heap->items, heap->count, 0);
+}
+
+ScoredDocument* finish_top_k(TopKHeap* heap, int* count) {
+    ScoredDocument* items = heap->items;
+    *count = heap->count;
+    std::sort(items, items + heap->count, ranks_higher);
+    
+    heap->items = nullptr;
+    heap->count = 0;
+    heap->capacity = 0;
+    return items;
+}
+
+void free_top_k(TopKHeap* heap) {
+    free(heap->items);
+    heap->items = nullptr;
+    heap->count = 0;
+    heap->capacity = 0;
+}
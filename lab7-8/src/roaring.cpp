@@ -0,0 +1,362 @@
+#include "../include/roaring.h"
+#include <cstdlib>
+#include <cstring>
+
+static void free_container(RoaringContainer* container) {
+    free(container->values);
+    free(container->words);
+    container->values = nullptr;
+    container->words = nullptr;
+}
+
+static int count_containers(const int* ids, int count) {
+    int container_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (i == 0 || (ids[i] >> 16) != (ids[i - 1] >> 16)) container_count++;
+    }
+    return container_count;
+}
+
+static int container_end(const int* ids, int count, int start) {
+    int end = start;
+    while (end < count && (ids[end] >> 16) == (ids[start] >> 16)) end++;
+    return end;
+}
+
+static size_t container_bytes(int cardinality) {
+    if (cardinality > ROARING_ARRAY_LIMIT) return ROARING_BITMAP_WORDS * sizeof(unsigned long long);
+    return (cardinality * sizeof(unsigned short) + 7) & ~(size_t)7;
+}
+
+static void fill_container(RoaringContainer* container, const int* ids, int start, int end) {
+    if (container->type == CONTAINER_BITMAP) {
+        memset(container->words, 0, ROARING_BITMAP_WORDS * sizeof(unsigned long long));
+        for (int i = start; i < end; i++) {
+            int low = ids[i] & 0xffff;
+            container->words[low >> 6] |= 1ULL << (low & 63);
+        }
+        return;
+    }
+    
+    for (int i = start; i < end; i++) {
+        container->values[i - start] = (unsigned short)(ids[i] & 0xffff);
+    }
+}
+
+RoaringBitmap* roaring_from_sorted(const int* ids, int count) {
+    RoaringBitmap* bitmap = (RoaringBitmap*)malloc(sizeof(RoaringBitmap));
+    if (!bitmap) return nullptr;
+    
+    int container_count = count_containers(ids, count);
+    bitmap->containers = (RoaringContainer*)calloc(container_count + 1, sizeof(RoaringContainer));
+    bitmap->count = 0;
+    bitmap->cardinality = count;
+    if (!bitmap->containers) {
+        free(bitmap);
+        return nullptr;
+    }
+    
+    for (int start = 0; start < count; ) {
+        int end = container_end(ids, count, start);
+        RoaringContainer* container = &bitmap->containers[bitmap->count++];
+        container->key = ids[start] >> 16;
+        container->cardinality = end - start;
+        container->type = container->cardinality > ROARING_ARRAY_LIMIT ? CONTAINER_BITMAP : CONTAINER_ARRAY;
+        
+        void* storage = malloc(container_bytes(container->cardinality));
+        if (!storage) {
+            free_roaring(bitmap);
+            return nullptr;
+        }
+        if (container->type == CONTAINER_BITMAP) {
+            container->words = (unsigned long long*)storage;
+        } else {
+            container->values = (unsigned short*)storage;
+        }
+        
+        fill_container(container, ids, start, end);
+        start = end;
+    }
+    
+    return bitmap;
+}
+
+size_t roaring_size_for(const int* ids, int count) {
+    size_t size = (sizeof(RoaringBitmap) + 7) & ~(size_t)7;
+    size += count_containers(ids, count) * sizeof(RoaringContainer);
+    for (int start = 0; start < count; ) {
+        int end = container_end(ids, count, start);
+        size += container_bytes(end - start);
+        start = end;
+    }
+    return size;
+}
+
+RoaringBitmap* roaring_from_sorted_in(const int* ids, int count, void* memory) {
+    unsigned char* next = (unsigned char*)memory;
+    RoaringBitmap* bitmap = (RoaringBitmap*)next;
+    next += (sizeof(RoaringBitmap) + 7) & ~(size_t)7;
+    
+    bitmap->containers = (RoaringContainer*)next;
+    bitmap->count = 0;
+    bitmap->cardinality = count;
+    next += count_containers(ids, count) * sizeof(RoaringContainer);
+    
+    for (int start = 0; start < count; ) {
+        int end = container_end(ids, count, start);
+        RoaringContainer* container = &bitmap->containers[bitmap->count++];
+        container->key = ids[start] >> 16;
+        container->cardinality = end - start;
+        container->type = container->cardinality > ROARING_ARRAY_LIMIT ? CONTAINER_BITMAP : CONTAINER_ARRAY;
+        container->values = container->type == CONTAINER_ARRAY ? (unsigned short*)next : nullptr;
+        container->words = container->type == CONTAINER_BITMAP ? (unsigned long long*)next : nullptr;
+        next += container_bytes(container->cardinality);
+        
+        fill_container(container, ids, start, end);
+        start = end;
+    }
+    
+    return bitmap;
+}
+
+void free_roaring(RoaringBitmap* bitmap) {
+    if (!bitmap) return;
+    
+    for (int i = 0; i < bitmap->count; i++) {
+        free_container(&bitmap->containers[i]);
+    }
+    free(bitmap->containers);
+    free(bitmap);
+}
+
+static const RoaringContainer* find_container(const RoaringBitmap* bitmap, int key) {
+    int lo = 0, hi = bitmap->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (bitmap->containers[mid].key < key) lo = mid + 1; else hi = mid;
+    }
+    
+    return lo < bitmap->count && bitmap->containers[lo].key == key ? &bitmap->containers[lo] : nullptr;
+}
+
+static int container_contains(const RoaringContainer* container, int low) {
+    if (container->type == CONTAINER_BITMAP) {
+        return (container->words[low >> 6] >> (low & 63)) & 1;
+    }
+    
+    int lo = 0, hi = container->cardinality;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (container->values[mid] < low) lo = mid + 1; else hi = mid;
+    }
+    return lo < container->cardinality && container->values[lo] == low;
+}
+
+int roaring_contains(const RoaringBitmap* bitmap, int id) {
+    const RoaringContainer* container = find_container(bitmap, id >> 16);
+    return container ? container_contains(container, id & 0xffff) : 0;
+}
+
+static int emit_word(unsigned long long word, int base, int* out) {
+    int k = 0;
+    while (word) {
+        out[k++] = base + __builtin_ctzll(word);
+        word &= word - 1;
+    }
+    return k;
+}
+
+static int container_to_array(const RoaringContainer* container, int* out) {
+    int base = container->key << 16;
+    
+    if (container->type == CONTAINER_ARRAY) {
+        for (int i = 0; i < container->cardinality; i++) {
+            out[i] = base | container->values[i];
+        }
+        return container->cardinality;
+    }
+    
+    int k = 0;
+    for (int w = 0; w < ROARING_BITMAP_WORDS; w++) {
+        k += emit_word(container->words[w], base + w * 64, out + k);
+    }
+    return k;
+}
+
+int roaring_to_array(const RoaringBitmap* bitmap, int* out) {
+    int k = 0;
+    for (int i = 0; i < bitmap->count; i++) {
+        k += container_to_array(&bitmap->containers[i], out + k);
+    }
+    return k;
+}
+
+static int and_containers(const RoaringContainer* a, const RoaringContainer* b, int* out) {
+    int base = a->key << 16;
+    int k = 0;
+    
+    if (a->type == CONTAINER_BITMAP && b->type == CONTAINER_BITMAP) {
+        for (int w = 0; w < ROARING_BITMAP_WORDS; w++) {
+            k += emit_word(a->words[w] & b->words[w], base + w * 64, out + k);
+        }
+        return k;
+    }
+    
+    if (a->type == CONTAINER_BITMAP || b->type == CONTAINER_BITMAP) {
+        const RoaringContainer* array = a->type == CONTAINER_ARRAY ? a : b;
+        const RoaringContainer* bits = array == a ? b : a;
+        for (int i = 0; i < array->cardinality; i++) {
+            int low = array->values[i];
+            if ((bits->words[low >> 6] >> (low & 63)) & 1) out[k++] = base | low;
+        }
+        return k;
+    }
+    
+    int i = 0, j = 0;
+    while (i < a->cardinality && j < b->cardinality) {
+        if (a->values[i] < b->values[j]) {
+            i++;
+        } else if (a->values[i] > b->values[j]) {
+            j++;
+        } else {
+            out[k++] = base | a->values[i];
+            i++;
+            j++;
+        }
+    }
+    return k;
+}
+
+static int or_containers(const RoaringContainer* a, const RoaringContainer* b, int* out) {
+    int base = a->key << 16;
+    int k = 0;
+    
+    if (a->type == CONTAINER_BITMAP || b->type == CONTAINER_BITMAP) {
+        unsigned long long words[ROARING_BITMAP_WORDS];
+        memset(words, 0, sizeof(words));
+        
+        const RoaringContainer* pair[2] = {a, b};
+        for (int p = 0; p < 2; p++) {
+            if (pair[p]->type == CONTAINER_BITMAP) {
+                for (int w = 0; w < ROARING_BITMAP_WORDS; w++) words[w] |= pair[p]->words[w];
+            } else {
+                for (int i = 0; i < pair[p]->cardinality; i++) {
+                    int low = pair[p]->values[i];
+                    words[low >> 6] |= 1ULL << (low & 63);
+                }
+            }
+        }
+        
+        for (int w = 0; w < ROARING_BITMAP_WORDS; w++) {
+            k += emit_word(words[w], base + w * 64, out + k);
+        }
+        return k;
+    }
+    
+    int i = 0, j = 0;
+    while (i < a->cardinality || j < b->cardinality) {
+        if (j >= b->cardinality || (i < a->cardinality && a->values[i] < b->values[j])) {
+            out[k++] = base | a->values[i++];
+        } else if (i >= a->cardinality || a->values[i] > b->values[j]) {
+            out[k++] = base | b->values[j++];
+        } else {
+            out[k++] = base | a->values[i];
+            i++;
+            j++;
+        }
+    }
+    return k;
+}
+
+int roaring_and_to_array(const RoaringBitmap* a, const RoaringBitmap* b, int* out) {
+    int i = 0, j = 0, k = 0;
+    
+    while (i < a->count && j < b->count) {
+        if (a->containers[i].key < b->containers[j].key) {
+            i++;
+        } else if (a->containers[i].key > b->containers[j].key) {
+            j++;
+        } else {
+            k += and_containers(&a->containers[i++], &b->containers[j++], out + k);
+        }
+    }
+    
+    return k;
+}
+
+int roaring_or_to_array(const RoaringBitmap* a, const RoaringBitmap* b, int* out) {
+    int i = 0, j = 0, k = 0;
+    
+    while (i < a->count || j < b->count) {
+        if (j >= b->count || (i < a->count && a->containers[i].key < b->containers[j].key)) {
+            k += container_to_array(&a->containers[i++], out + k);
+        } else if (i >= a->count || a->containers[i].key > b->containers[j].key) {
+            k += container_to_array(&b->containers[j++], out + k);
+        } else {
+            k += or_containers(&a->containers[i++], &b->containers[j++], out + k);
+        }
+    }
+    
+    return k;
+}
+
+int roaring_filter_array(const RoaringBitmap* bitmap, const int* ids, int count, int* out) {
+    int k = 0;
+    const RoaringContainer* container = nullptr;
+    
+    for (int i = 0; i < count; i++) {
+        int key = ids[i] >> 16;
+        if (!container || container->key != key) {
+            container = find_container(bitmap, key);
+            if (!container) {
+                
+                while (i + 1 < count && (ids[i + 1] >> 16) == key) i++;
+                continue;
+            }
+        }
+        
+        if (container_contains(container, ids[i] & 0xffff)) out[k++] = ids[i];
+    }
+    
+    return k;
+}
+
+int roaring_complement_to_array(const RoaringBitmap* bitmap, int universe, int* out) {
+    int k = 0;
+    int c = 0;
+    
+    for (int key = 0; key <= (universe >> 16); key++) {
+        int base = key << 16;
+        unsigned long long words[ROARING_BITMAP_WORDS];
+        
+        while (c < bitmap->count && bitmap->containers[c].key < key) c++;
+        const RoaringContainer* container = c < bitmap->count && bitmap->containers[c].key == key ? &bitmap->containers[c] : nullptr;
+        
+        
+        if (!container) {
+            memset(words, 0xff, sizeof(words));
+        } else if (container->type == CONTAINER_BITMAP) {
+            for (int w = 0; w < ROARING_BITMAP_WORDS; w++) words[w] = ~container->words[w];
+        } else {
+            memset(words, 0xff, sizeof(words));
+            for (int i = 0; i < container->cardinality; i++) {
+                int low = container->values[i];
+                words[low >> 6] &= ~(1ULL << (low & 63));
+            }
+        }
+        
+        
+        int first = key == 0 ? 1 : 0;
+        int last = key == (universe >> 16) ? (universe & 0xffff) : 0xffff;
+        int last_word = last >> 6;
+        
+        words[0] &= ~((1ULL << first) - 1);
+        if ((last & 63) != 63) words[last_word] &= (1ULL << ((last & 63) + 1)) - 1;
+        
+        for (int w = 0; w <= last_word; w++) {
+            k += emit_word(words[w], base + w * 64, out + k);
+        }
+    }
+    
+    return k;
+}
@@ -0,0 +1,208 @@
+#include "../include/search.h"
+#include "../include/query_planner.h"
+#include "../include/query_cursor.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int* query_tree_query(BooleanIndex* index, void* context, int* result_count) {
+    SearchContext* search = (SearchContext*)context;
+    if (!search->explain) return evaluate_query(index, search->tree, result_count);
+    
+    *result_count = 0;
+    QueryPlan* plan = plan_query(index, search->tree);
+    if (!plan) {
+        *result_count = -1;
+        return nullptr;
+    }
+    
+    int* result = execute_plan(index, plan, result_count);
+    printf("\nPlan for segment %d (%d documents):\n", search->segment++, index->max_doc_id);
+    print_plan(plan, 1);
+    free_plan(plan);
+    return result;
+}
+
+int* search_first_documents(SegmentedIndex* segmented, SearchContext* search, int* result_count) {
+    *result_count = 0;
+    int* result = (int*)malloc(search->limit * sizeof(int));
+    if (!result) {
+        *result_count = -1;
+        return nullptr;
+    }
+    
+    int k = 0;
+    bool failed = false;
+    for (int s = 0; s < segmented->count && k < search->limit && !failed; s++) {
+        Segment* segment = &segmented->segments[s];
+        QueryPlan* plan = plan_query(segment->index, search->tree);
+        QueryCursor* cursor = open_cursor(segment->index, plan);
+        if (!cursor) failed = true;
+        
+        while (cursor && k < search->limit) {
+            int doc_id = cursor_next(cursor);
+            if (doc_id == CURSOR_END) break;
+            if (is_segment_doc_live(segment, doc_id)) result[k++] = segment->doc_base + doc_id;
+        }
+        
+        if (plan && search->explain) {
+            printf("\nPlan for segment %d (%d documents):\n", search->segment++, segment->index->max_doc_id);
+            print_plan(plan, 1);
+        }
+        close_cursor(cursor);
+        free_plan(plan);
+    }
+    
+    if (failed || k == 0) {
+        free(result);
+        if (failed) *result_count = -1;
+        return nullptr;
+    }
+    
+    *result_count = k;
+    return result;
+}
+
+ScoredDocument* search_top_documents(SegmentedIndex* segmented, SearchContext* search, RankingSummary* summary, int* result_count) {
+    memset(summary, 0, sizeof(RankingSummary));
+    *result_count = -1;
+    
+    BooleanIndex** indexes = (BooleanIndex**)malloc(segmented->count * sizeof(BooleanIndex*));
+    if (!indexes) return nullptr;
+    for (int s = 0; s < segmented->count; s++) {
+        indexes[s] = segmented->segments[s].index;
+    }
+    
+    RankingStats stats;
+    TopKHeap heap;
+    int status = init_ranking_stats(&stats, search->tree, indexes, segmented->count);
+    free(indexes);
+    if (status != 0) return nullptr;
+    if (init_top_k(&heap, search->top) != 0) {
+        free_ranking_stats(&stats);
+        return nullptr;
+    }
+    
+    
+    bool disjunction = is_term_disjunction(search->tree) && !search->explain;
+    for (int s = 0; s < segmented->count && status == 0; s++) {
+        Segment* segment = &segmented->segments[s];
+        if (disjunction && prefers_pruning(segment->index, &stats, search->top)) {
+            int scored = rank_term_disjunction(segment->index, &stats, segment->live, segment->doc_base, &heap);
+            if (scored < 0) status = -1; else summary->scored_count += scored;
+            summary->pruned = 1;
+            continue;
+        }
+        
+        int count = 0;
+        int* doc_ids = query_tree_query(segment->index, search, &count);
+        float* scores = doc_ids ? (float*)malloc(count * sizeof(float)) : nullptr;
+        if (count < 0 || (doc_ids && !scores)) status = -1;
+        
+        if (scores) {
+            score_documents(segment->index, &stats, doc_ids, count, scores);
+            for (int i = 0; i < count; i++) {
+                if (!is_segment_doc_live(segment, doc_ids[i])) continue;
+                offer_top_k(&heap, segment->doc_base + doc_ids[i], scores[i]);
+                summary->match_count++;
+                summary->scored_count++;
+            }
+        }
+        
+        free(scores);
+        free(doc_ids);
+    }
+    
+    free_ranking_stats(&stats);
+    if (summary->pruned) summary->match_count = 0;
+    ScoredDocument* result = finish_top_k(&heap, result_count);
+    if (status != 0 || *result_count == 0) {
+        free(result);
+        *result_count = status != 0 ? -1 : 0;
+        return nullptr;
+    }
+    return result;
+}
+
+const char* parse_search_options(const char* line, SearchContext* search) {
+    while (strncmp(line, "--top ", 6) == 0 || strncmp(line, "--limit ", 8) == 0) {
+        bool top = line[2] == 't';
+        char* end = nullptr;
+        long value = strtol(line + (top ? 6 : 8), &end, 10);
+        if (end == line + (top ? 6 : 8) || value <= 0 || value > 100000) return nullptr;
+        
+        if (top) search->top = (int)value; else search->limit = (int)value;
+        line = end;
+        while (*line == ' ') line++;
+    }
+    
+    return search->top > 0 && search->limit > 0 ? nullptr : line;
+}
+
+static char* search_cache_key(SearchContext* search) {
+    char* query = normalize_query(search->tree);
+    if (!query) return nullptr;
+    
+    size_t length = strlen(query) + 32;
+    char* key = (char*)malloc(length);
+    if (key) {
+        if (search->top > 0) snprintf(key, length, "top %d %s", search->top, query);
+        else if (search->limit > 0) snprintf(key, length, "limit %d %s", search->limit, query);
+        else snprintf(key, length, "all %s", query);
+    }
+    free(query);
+    return key;
+}
+
+int run_search(SegmentedIndex* segmented, SearchContext* search, QueryCache* cache, ResultSet* result) {
+    memset(result, 0, sizeof(ResultSet));
+    
+    char* key = cache ? search_cache_key(search) : nullptr;
+    if (key && cache_lookup(cache, key, result)) {
+        free(key);
+        return 1;
+    }
+    
+    
+    if (search->top > 0) {
+        RankingSummary summary;
+        ScoredDocument* ranked = search_top_documents(segmented, search, &summary, &result->count);
+        result->match_count = summary.match_count;
+        result->scored_count = summary.scored_count;
+        result->pruned = summary.pruned;
+        if (ranked) {
+            result->doc_ids = (int*)malloc(result->count * sizeof(int));
+            result->scores = (float*)malloc(result->count * sizeof(float));
+            for (int i = 0; result->doc_ids && result->scores && i < result->count; i++) {
+                result->doc_ids[i] = ranked[i].doc_id;
+                result->scores[i] = ranked[i].score;
+            }
+            free(ranked);
+        }
+        if (result->count > 0 && (!result->doc_ids || !result->scores)) {
+            free_result_set(result);
+            result->count = -1;
+        }
+    } else {
+        result->doc_ids = search->limit > 0 ? search_first_documents(segmented, search, &result->count)
+                                            : search_segments(segmented, query_tree_query, search, &result->count);
+        result->match_count = result->count;
+        result->scored_count = result->count;
+    }
+    
+    if (result->count < 0) {
+        free_result_set(result);
+        free(key);
+        return -1;
+    }
+    
+    if (key) cache_store(cache, key, result);
+    free(key);
+    return 0;
+}
+
+void attach_intersection_cache(SegmentedIndex* segmented, QueryCache* cache) {
+    for (int s = 0; s < segmented->count; s++) {
+        segmented->segments[s].index->intersection_cache = cache;
+    }
+}
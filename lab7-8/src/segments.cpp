@@ -0,0 +1,831 @@
+#include "../include/segments.h"
+#include "../include/index_builder.h"
+#include "../include/document_parser.h"
+#include "../include/byte_io.h"
+#include "../include/utils.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define MANIFEST_MAGIC "BSEG"
+#define MANIFEST_VERSION 1
+#define LIVE_MAGIC "BLIV"
+#define MERGE_CONVERT_BUDGET (64 * 1024 * 1024)
+
+static char* segment_file(const char* manifest, int number, const char* suffix) {
+    size_t len = strlen(manifest) + strlen(suffix) + 32;
+    char* path = (char*)malloc(len);
+    if (path) {
+        snprintf(path, len, "%s.seg%d%s", manifest, number, suffix);
+    }
+    return path;
+}
+
+static int live_words(int doc_count) {
+    return doc_count / 64 + 1;
+}
+
+static int read_live_file(const char* path, int doc_count, unsigned long long** live, int* live_count) {
+    size_t size = 0;
+    unsigned char* data = map_file(path, &size);
+    if (!data) {
+        FILE* file = fopen(path, "rb");
+        if (!file) return errno == ENOENT ? 0 : -1;
+        fclose(file);
+        return -1;
+    }
+    
+    int words = live_words(doc_count);
+    int count = size >= 12 ? (int)read_le32(data + 8) : -1;
+    int status = -1;
+    
+    
+    if (size == 12 + (size_t)words * 8 && memcmp(data, LIVE_MAGIC, 4) == 0 &&
+        read_le32(data + 4) == (unsigned int)doc_count && count >= 0 && count <= doc_count) {
+        *live = (unsigned long long*)malloc(words * sizeof(unsigned long long));
+        int ones = 0;
+        for (int w = 0; *live && w < words; w++) {
+            (*live)[w] = read_le64(data + 12 + w * 8);
+            unsigned long long mask = ~0ULL;
+            if (w == 0) mask &= ~1ULL;
+            if (w == words - 1 && doc_count % 64 != 63) mask &= (2ULL << (doc_count % 64)) - 1;
+            ones += __builtin_popcountll((*live)[w] & mask);
+        }
+        
+        if (*live && ones == count) {
+            *live_count = count;
+            status = 0;
+        } else {
+            free(*live);
+            *live = nullptr;
+        }
+    }
+    
+    unmap_file(data, size);
+    return status;
+}
+
+static int write_live_file(const char* path, Segment* segment) {
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    
+    FILE* file = fopen(tmp_path, "wb");
+    if (!file) return -1;
+    
+    ByteWriter writer;
+    if (init_byte_writer(&writer, file) != 0) {
+        fclose(file);
+        return -1;
+    }
+    
+    put_bytes(&writer, LIVE_MAGIC, 4);
+    put_uint32(&writer, segment->doc_count);
+    put_uint32(&writer, segment->live_count);
+    for (int w = 0; w < live_words(segment->doc_count); w++) {
+        put_uint32(&writer, (unsigned int)segment->live[w]);
+        put_uint32(&writer, (unsigned int)(segment->live[w] >> 32));
+    }
+    
+    int status = flush_byte_writer(&writer);
+    free_byte_writer(&writer);
+    if (fclose(file) != 0) status = -1;
+    
+    if (status == 0 && rename(tmp_path, path) != 0) status = -1;
+    return status;
+}
+
+static int load_segment(Segment* segment, const char* manifest) {
+    char* index_path = segment_file(manifest, segment->number, "");
+    char* store_path = segment_file(manifest, segment->number, ".docs");
+    char* live_path = segment_file(manifest, segment->number, ".live");
+    
+    if (index_path && store_path && live_path) {
+        segment->index = load_index(index_path);
+        segment->store = open_document_store(store_path);
+        segment->live_count = segment->doc_count;
+        if (read_live_file(live_path, segment->doc_count, &segment->live, &segment->live_count) != 0) {
+            printf("Invalid deleted document file: %s\n", live_path);
+            free_index(segment->index);
+            segment->index = nullptr;
+        }
+    }
+    
+    free(index_path);
+    free(store_path);
+    free(live_path);
+    return segment->index ? 0 : -1;
+}
+
+static void free_segment(Segment* segment) {
+    free_index(segment->index);
+    close_document_store(segment->store);
+    free(segment->live);
+    memset(segment, 0, sizeof(Segment));
+}
+
+static Segment* append_segment(SegmentedIndex* segmented) {
+    if (segmented->count == segmented->capacity) {
+        int new_capacity = segmented->capacity == 0 ? 8 : segmented->capacity * 2;
+        Segment* segments = (Segment*)realloc(segmented->segments, new_capacity * sizeof(Segment));
+        if (!segments) return nullptr;
+        segmented->segments = segments;
+        segmented->capacity = new_capacity;
+    }
+    
+    Segment* segment = &segmented->segments[segmented->count++];
+    memset(segment, 0, sizeof(Segment));
+    return segment;
+}
+
+static int read_manifest(SegmentedIndex* segmented, FILE* file) {
+    char magic[8];
+    int version;
+    if (fscanf(file, "%7s %d", magic, &version) != 2 || strcmp(magic, MANIFEST_MAGIC) != 0 ||
+        version != MANIFEST_VERSION) {
+        return -1;
+    }
+    
+    if (fscanf(file, " next %d", &segmented->next_segment) != 1) return -1;
+    
+    
+    int number, doc_base, doc_count;
+    while (fscanf(file, " segment %d %d %d", &number, &doc_base, &doc_count) == 3) {
+        Segment* segment = append_segment(segmented);
+        if (!segment) return -1;
+        
+        segment->number = number;
+        segment->doc_base = doc_base;
+        segment->doc_count = doc_count;
+        if (load_segment(segment, segmented->manifest) != 0) return -1;
+    }
+    
+    return feof(file) ? 0 : -1;
+}
+
+static SegmentedIndex* open_index_files(const char* path, int create) {
+    SegmentedIndex* segmented = (SegmentedIndex*)calloc(1, sizeof(SegmentedIndex));
+    if (!segmented) return nullptr;
+    
+    FILE* file = fopen(path, "rb");
+    char magic[4] = {0};
+    if (file && fread(magic, 1, 4, file) == 4 && memcmp(magic, MANIFEST_MAGIC, 4) == 0) {
+        segmented->manifest = strdup(path);
+        rewind(file);
+        int status = read_manifest(segmented, file);
+        fclose(file);
+        
+        if (status != 0) {
+            close_segmented_index(segmented);
+            return nullptr;
+        }
+        return segmented;
+    }
+    
+    
+    int exists = file != nullptr;
+    if (file) fclose(file);
+    if (create) {
+        if (exists) {
+            printf("Not a segmented index: %s\n", path);
+            free(segmented);
+            return nullptr;
+        }
+        segmented->manifest = strdup(path);
+        return segmented;
+    }
+    
+    
+    Segment* segment = append_segment(segmented);
+    BooleanIndex* index = segment ? load_index(path) : nullptr;
+    if (!index) {
+        close_segmented_index(segmented);
+        return nullptr;
+    }
+    
+    char* store_path = document_store_path(path);
+    segment->number = -1;
+    segment->index = index;
+    segment->store = open_document_store(store_path);
+    segment->doc_count = index->max_doc_id;
+    segment->live_count = index->max_doc_id;
+    free(store_path);
+    return segmented;
+}
+
+SegmentedIndex* open_segmented_index(const char* path) {
+    if (!path) return nullptr;
+    
+    return open_index_files(path, 0);
+}
+
+void close_segmented_index(SegmentedIndex* segmented) {
+    if (!segmented) return;
+    
+    for (int i = 0; i < segmented->count; i++) {
+        free_segment(&segmented->segments[i]);
+    }
+    
+    free(segmented->segments);
+    free(segmented->manifest);
+    free(segmented);
+}
+
+int is_segment_doc_live(Segment* segment, int local_id) {
+    if (!segment || local_id < 1 || local_id > segment->doc_count) return 0;
+    if (!segment->live) return 1;
+    
+    return (segment->live[local_id / 64] >> (local_id % 64)) & 1;
+}
+
+static int delete_segment_doc(Segment* segment, int local_id) {
+    if (!is_segment_doc_live(segment, local_id)) return 0;
+    
+    if (!segment->live) {
+        int words = live_words(segment->doc_count);
+        segment->live = (unsigned long long*)malloc(words * sizeof(unsigned long long));
+        if (!segment->live) return 0;
+        
+        for (int w = 0; w < words; w++) {
+            segment->live[w] = ~0ULL;
+        }
+    }
+    
+    segment->live[local_id / 64] &= ~(1ULL << (local_id % 64));
+    segment->live_count--;
+    segment->live_dirty = 1;
+    return 1;
+}
+
+Segment* find_segment(SegmentedIndex* segmented, int doc_id) {
+    if (!segmented) return nullptr;
+    
+    int lo = 0;
+    int hi = segmented->count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        Segment* segment = &segmented->segments[mid];
+        
+        if (doc_id <= segment->doc_base) {
+            hi = mid - 1;
+        } else if (doc_id > segment->doc_base + segment->doc_count) {
+            lo = mid + 1;
+        } else {
+            return segment;
+        }
+    }
+    
+    return nullptr;
+}
+
+int* search_segments(SegmentedIndex* segmented, SegmentQuery query, void* context, int* result_count) {
+    *result_count = 0;
+    if (!segmented || !query || segmented->count == 0) return nullptr;
+    
+    int** partials = (int**)calloc(segmented->count, sizeof(int*));
+    int* counts = (int*)calloc(segmented->count, sizeof(int));
+    if (!partials || !counts) {
+        free(partials);
+        free(counts);
+        *result_count = -1;
+        return nullptr;
+    }
+    
+    
+    int total = 0;
+    bool failed = false;
+    for (int s = 0; s < segmented->count; s++) {
+        partials[s] = query(segmented->segments[s].index, context, &counts[s]);
+        if (counts[s] < 0) failed = true;
+        if (!partials[s]) counts[s] = 0;
+        total += counts[s];
+    }
+    
+    int* result = total > 0 && !failed ? (int*)malloc(total * sizeof(int)) : nullptr;
+    if (total > 0 && !result) failed = true;
+    int k = 0;
+    
+    for (int s = 0; s < segmented->count; s++) {
+        Segment* segment = &segmented->segments[s];
+        for (int i = 0; result && i < counts[s]; i++) {
+            if (is_segment_doc_live(segment, partials[s][i])) {
+                result[k++] = segment->doc_base + partials[s][i];
+            }
+        }
+        free(partials[s]);
+    }
+    
+    free(partials);
+    free(counts);
+    
+    if (failed || k == 0) {
+        free(result);
+        if (failed) *result_count = -1;
+        return nullptr;
+    }
+    
+    *result_count = k;
+    return result;
+}
+
+int get_segment_document_info(SegmentedIndex* segmented, int doc_id, DocumentInfo* info) {
+    Segment* segment = find_segment(segmented, doc_id);
+    if (!segment || !is_segment_doc_live(segment, doc_id - segment->doc_base)) return 0;
+    
+    if (!get_document_info(segment->index, doc_id - segment->doc_base, info)) return 0;
+    info->doc_id = doc_id;
+    return 1;
+}
+
+char* fetch_segment_document_text(SegmentedIndex* segmented, int doc_id) {
+    Segment* segment = find_segment(segmented, doc_id);
+    if (!segment || !is_segment_doc_live(segment, doc_id - segment->doc_base)) return nullptr;
+    
+    return fetch_document_text(segment->store, doc_id - segment->doc_base);
+}
+
+int live_document_count(SegmentedIndex* segmented) {
+    if (!segmented) return 0;
+    
+    int total = 0;
+    for (int s = 0; s < segmented->count; s++) {
+        total += segmented->segments[s].live_count;
+    }
+    return total;
+}
+
+static void remove_segment_files(const char* manifest, int number) {
+    const char* suffixes[] = {"", ".docs", ".live"};
+    for (int i = 0; i < 3; i++) {
+        char* path = segment_file(manifest, number, suffixes[i]);
+        if (path) remove(path);
+        free(path);
+    }
+}
+
+static int commit_segments(SegmentedIndex* segmented) {
+    int status = 0;
+    
+    
+    for (int s = 0; s < segmented->count; s++) {
+        Segment* segment = &segmented->segments[s];
+        if (!segment->live_dirty || segment->live_count == 0) continue;
+        
+        char* live_path = segment_file(segmented->manifest, segment->number, ".live");
+        if (!live_path || write_live_file(live_path, segment) != 0) status = -1;
+        segment->live_dirty = 0;
+        free(live_path);
+    }
+    if (status != 0) return -1;
+    
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", segmented->manifest);
+    FILE* file = fopen(tmp_path, "wb");
+    if (!file) return -1;
+    
+    fprintf(file, "%s %d\n", MANIFEST_MAGIC, MANIFEST_VERSION);
+    fprintf(file, "next %d\n", segmented->next_segment);
+    for (int s = 0; s < segmented->count; s++) {
+        Segment* segment = &segmented->segments[s];
+        if (segment->live_count == 0) continue;
+        fprintf(file, "segment %d %d %d\n", segment->number, segment->doc_base, segment->doc_count);
+    }
+    
+    if (fclose(file) != 0 || rename(tmp_path, segmented->manifest) != 0) return -1;
+    
+    
+    int kept = 0;
+    for (int s = 0; s < segmented->count; s++) {
+        Segment* segment = &segmented->segments[s];
+        if (segment->live_count > 0) {
+            segmented->segments[kept++] = *segment;
+            continue;
+        }
+        
+        printf("Dropping segment %d (no live documents)\n", segment->number);
+        int number = segment->number;
+        free_segment(segment);
+        remove_segment_files(segmented->manifest, number);
+    }
+    segmented->count = kept;
+    
+    return 0;
+}
+
+typedef struct {
+    char* dir;
+    char* resolved;
+} DirectoryCache;
+
+
+static char* resolve_path(const char* path) {
+#ifdef _WIN32
+    return _fullpath(nullptr, path, 0);
+#else
+    return realpath(path, nullptr);
+#endif
+}
+
+static int is_directory(const char* path) {
+#ifdef _WIN32
+    struct _stat info;
+    if (_stat(path, &info) != 0) return -1;
+    return (info.st_mode & _S_IFDIR) != 0;
+#else
+    struct stat info;
+    if (stat(path, &info) != 0) return -1;
+    return S_ISDIR(info.st_mode) ? 1 : 0;
+#endif
+}
+
+static char* document_key(const char* path, DirectoryCache* cache) {
+    const char* slash = strrchr(path, '/');
+    size_t dir_length = slash ? (size_t)(slash - path) : 0;
+    const char* name = slash ? slash + 1 : path;
+    
+    if (!cache->dir || strlen(cache->dir) != dir_length || strncmp(cache->dir, path, dir_length) != 0) {
+        free(cache->dir);
+        free(cache->resolved);
+        cache->dir = (char*)malloc(dir_length + 1);
+        if (cache->dir) {
+            memcpy(cache->dir, path, dir_length);
+            cache->dir[dir_length] = '\0';
+        }
+        cache->resolved = cache->dir ? resolve_path(dir_length == 0 ? (slash ? "/" : ".") : cache->dir) : nullptr;
+    }
+    
+    
+    const char* dir = cache->resolved ? cache->resolved : cache->dir ? cache->dir : "";
+    size_t length = strlen(dir) + strlen(name) + 2;
+    char* key = (char*)malloc(length);
+    if (key) {
+        snprintf(key, length, "%s/%s", strcmp(dir, "/") == 0 ? "" : dir, name);
+    }
+    return key;
+}
+
+static void free_directory_cache(DirectoryCache* cache) {
+    free(cache->dir);
+    free(cache->resolved);
+    cache->dir = nullptr;
+    cache->resolved = nullptr;
+}
+
+static int compare_keys(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+static const char* path_name(const char* path) {
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static int delete_matching_paths(SegmentedIndex* segmented, int segment_limit, const char** paths, int path_count) {
+    char** keys = (char**)calloc(path_count, sizeof(char*));
+    const char** names = (const char**)calloc(path_count, sizeof(const char*));
+    if (!keys || !names) {
+        free(keys);
+        free(names);
+        return 0;
+    }
+    
+    DirectoryCache cache = {nullptr, nullptr};
+    int key_count = 0;
+    for (int i = 0; i < path_count; i++) {
+        char* key = document_key(paths[i], &cache);
+        if (key) {
+            names[key_count] = path_name(key);
+            keys[key_count++] = key;
+        }
+    }
+    free_directory_cache(&cache);
+    qsort(keys, key_count, sizeof(char*), compare_keys);
+    qsort(names, key_count, sizeof(const char*), compare_keys);
+    
+    
+    int deleted = 0;
+    for (int s = 0; s < segment_limit; s++) {
+        Segment* segment = &segmented->segments[s];
+        
+        for (int local_id = 1; local_id <= segment->doc_count; local_id++) {
+            DocumentInfo info;
+            if (!is_segment_doc_live(segment, local_id) || !get_document_info(segment->index, local_id, &info)) continue;
+            
+            const char* name = path_name(info.path);
+            if (!bsearch(&name, names, key_count, sizeof(const char*), compare_keys)) continue;
+            
+            char* key = document_key(info.path, &cache);
+            if (key && bsearch(&key, keys, key_count, sizeof(char*), compare_keys)) {
+                deleted += delete_segment_doc(segment, local_id);
+            }
+            free(key);
+        }
+    }
+    
+    free_directory_cache(&cache);
+    free_string_array(keys, key_count);
+    free(names);
+    return deleted;
+}
+
+static int append_files(char*** files, int* file_count, int* capacity, char** listed, int listed_count) {
+    if (*file_count + listed_count > *capacity) {
+        int new_capacity = *capacity;
+        while (new_capacity < *file_count + listed_count) new_capacity *= 2;
+        char** grown = (char**)realloc(*files, new_capacity * sizeof(char*));
+        if (!grown) {
+            free_string_array(listed, listed_count);
+            return -1;
+        }
+        *files = grown;
+        *capacity = new_capacity;
+    }
+    
+    for (int i = 0; i < listed_count; i++) {
+        (*files)[(*file_count)++] = listed[i];
+    }
+    free(listed);
+    return 0;
+}
+
+static char** collect_segment_files(const char** paths, int path_count, int* file_count) {
+    *file_count = 0;
+    int capacity = 16;
+    char** files = (char**)malloc(capacity * sizeof(char*));
+    if (!files) return nullptr;
+    
+    DirectoryCache cache = {nullptr, nullptr};
+    int status = 0;
+    for (int i = 0; i < path_count && status == 0; i++) {
+        char** listed = nullptr;
+        int listed_count = 0;
+        int directory = is_directory(paths[i]);
+        
+        if (directory < 0) {
+            printf("Cannot open: %s\n", paths[i]);
+            status = -1;
+        } else if (directory) {
+            char* full_dir = resolve_path(paths[i]);
+            listed = full_dir ? list_html_files(full_dir, &listed_count) : nullptr;
+            if (!listed) status = -1;
+            free(full_dir);
+        } else if (is_html_file(paths[i])) {
+            listed = (char**)malloc(sizeof(char*));
+            if (listed) listed[0] = document_key(paths[i], &cache);
+            if (listed && listed[0]) listed_count = 1; else status = -1;
+        } else {
+            printf("Not an HTML file: %s\n", paths[i]);
+            status = -1;
+        }
+        
+        if (status == 0) {
+            status = append_files(&files, file_count, &capacity, listed, listed_count);
+        } else {
+            free_string_array(listed, listed_count);
+        }
+    }
+    free_directory_cache(&cache);
+    
+    if (status != 0) {
+        free_string_array(files, *file_count);
+        *file_count = 0;
+        return nullptr;
+    }
+    
+    
+    qsort(files, *file_count, sizeof(char*), compare_keys);
+    int unique = 0;
+    for (int i = 0; i < *file_count; i++) {
+        if (unique > 0 && strcmp(files[unique - 1], files[i]) == 0) {
+            free(files[i]);
+        } else {
+            files[unique++] = files[i];
+        }
+    }
+    *file_count = unique;
+    return files;
+}
+
+int add_segment(const char* manifest, const char** paths, int path_count, int thread_count, size_t memory_budget) {
+    if (!manifest || !paths || path_count <= 0) return -1;
+    
+    SegmentedIndex* segmented = open_index_files(manifest, 1);
+    if (!segmented) return -1;
+    
+    int number = segmented->next_segment;
+    char* index_path = segment_file(manifest, number, "");
+    int file_count = 0;
+    char** files = collect_segment_files(paths, path_count, &file_count);
+    if (!index_path || !files) {
+        free(index_path);
+        close_segmented_index(segmented);
+        return -1;
+    }
+    
+    
+    printf("Building segment %d from %d HTML files\n", number, file_count);
+    int built = memory_budget > 0 ? build_index_spimi_files(files, file_count, index_path, memory_budget)
+                                  : build_index_parallel_files(files, file_count, index_path, thread_count > 1 ? thread_count : 1);
+    free(index_path);
+    
+    Segment* last = segmented->count > 0 ? &segmented->segments[segmented->count - 1] : nullptr;
+    int doc_base = last ? last->doc_base + last->doc_count : 0;
+    
+    Segment* segment = built >= 0 ? append_segment(segmented) : nullptr;
+    if (segment) {
+        segment->number = number;
+        segment->doc_base = doc_base;
+        if (load_segment(segment, manifest) != 0) {
+            segmented->count--;
+            segment = nullptr;
+        }
+    }
+    
+    if (!segment) {
+        printf("Cannot build segment %d\n", number);
+        remove_segment_files(manifest, number);
+        free_string_array(files, file_count);
+        close_segmented_index(segmented);
+        return -1;
+    }
+    
+    segment->doc_count = segment->index->max_doc_id;
+    segment->live_count = segment->doc_count;
+    segmented->next_segment = number + 1;
+    
+    
+    int replaced = delete_matching_paths(segmented, segmented->count - 1, (const char**)files, file_count);
+    free_string_array(files, file_count);
+    
+    int doc_count = segment->doc_count;
+    int status = commit_segments(segmented);
+    if (status == 0) {
+        printf("Segment %d: %d documents (ids %d-%d), %d replaced, %d live in %d segments\n",
+               number, doc_count, doc_base + 1, doc_base + doc_count, replaced,
+               live_document_count(segmented), segmented->count);
+    }
+    
+    close_segmented_index(segmented);
+    return status;
+}
+
+int delete_documents(const char* manifest, const char** paths, int path_count) {
+    if (!manifest || !paths || path_count <= 0) return -1;
+    
+    SegmentedIndex* segmented = open_index_files(manifest, 0);
+    if (!segmented || !segmented->manifest) {
+        printf("Not a segmented index: %s\n", manifest);
+        close_segmented_index(segmented);
+        return -1;
+    }
+    
+    int deleted = delete_matching_paths(segmented, segmented->count, paths, path_count);
+    
+    int status = deleted > 0 ? commit_segments(segmented) : 0;
+    close_segmented_index(segmented);
+    return status == 0 ? deleted : -1;
+}
+
+static int is_manifest_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    char magic[4] = {0};
+    int manifest = file && fread(magic, 1, 4, file) == 4 && memcmp(magic, MANIFEST_MAGIC, 4) == 0;
+    if (file) fclose(file);
+    return manifest;
+}
+
+static SegmentedIndex* open_merge_input(const char* input, const char* tmp_path, int* converted) {
+    if (is_manifest_file(input) || !is_stream_index(input)) return open_segmented_index(input);
+    
+    
+    (*converted)++;
+    if (convert_stream_index(input, tmp_path, MERGE_CONVERT_BUDGET) < 0) return nullptr;
+    
+    SegmentedIndex* segmented = open_segmented_index(tmp_path);
+    char* store_path = document_store_path(input);
+    if (segmented) {
+        close_document_store(segmented->segments[0].store);
+        segmented->segments[0].store = open_document_store(store_path);
+    }
+    free(store_path);
+    return segmented;
+}
+
+static int* build_doc_map(Segment* segment, int* next_doc_id) {
+    int max_doc_id = segment->index->max_doc_id;
+    int* doc_map = (int*)malloc((max_doc_id + 1) * sizeof(int));
+    if (!doc_map) return nullptr;
+    
+    doc_map[0] = -1;
+    for (int local_id = 1; local_id <= max_doc_id; local_id++) {
+        doc_map[local_id] = is_segment_doc_live(segment, local_id) ? ++(*next_doc_id) : -1;
+    }
+    return doc_map;
+}
+
+static int merge_document_stores(Segment** segments, MergeSource* sources, int count, const char* filename) {
+    int store_count = 0;
+    for (int s = 0; s < count; s++) {
+        if (segments[s]->store) store_count++;
+    }
+    if (store_count == 0) return 0;
+    
+    DocumentStoreWriter writer;
+    if (open_document_store_writer(&writer, filename) != 0) return -1;
+    
+    int status = 0;
+    for (int s = 0; s < count && status == 0; s++) {
+        for (int local_id = 1; segments[s]->store && local_id <= sources[s].index->max_doc_id && status == 0; local_id++) {
+            if (sources[s].doc_map[local_id] <= 0) continue;
+            
+            char* text = fetch_document_text(segments[s]->store, local_id);
+            if (text && add_stored_document(&writer, sources[s].doc_map[local_id], text) != 0) status = -1;
+            free(text);
+        }
+    }
+    
+    if (close_document_store_writer(&writer) != 0) status = -1;
+    if (status != 0) remove(filename);
+    return status;
+}
+
+int merge_indexes(const char* output, const char** inputs, int input_count) {
+    if (!output || !inputs || input_count <= 0) return -1;
+    
+    for (int i = 0; i < input_count; i++) {
+        if (strcmp(inputs[i], output) == 0) {
+            printf("Output must differ from the inputs: %s\n", output);
+            return -1;
+        }
+    }
+    
+    SegmentedIndex** opened = (SegmentedIndex**)calloc(input_count, sizeof(SegmentedIndex*));
+    if (!opened) return -1;
+    
+    int status = 0;
+    int segment_count = 0;
+    int converted = 0;
+    char tmp_path[4096];
+    for (int i = 0; i < input_count && status == 0; i++) {
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp%d", output, converted);
+        opened[i] = open_merge_input(inputs[i], tmp_path, &converted);
+        if (!opened[i]) {
+            printf("Cannot open index: %s\n", inputs[i]);
+            status = -1;
+        } else {
+            segment_count += opened[i]->count;
+        }
+    }
+    
+    Segment** segments = (Segment**)malloc((segment_count + 1) * sizeof(Segment*));
+    MergeSource* sources = (MergeSource*)calloc(segment_count + 1, sizeof(MergeSource));
+    if (!segments || !sources) status = -1;
+    
+    
+    int count = 0;
+    int doc_count = 0;
+    for (int i = 0; i < input_count && status == 0; i++) {
+        for (int s = 0; s < opened[i]->count && status == 0; s++) {
+            Segment* segment = &opened[i]->segments[s];
+            if (!segment->index->mapped) status = -1;
+            
+            segments[count] = segment;
+            sources[count].index = segment->index;
+            sources[count].doc_map = status == 0 ? build_doc_map(segment, &doc_count) : nullptr;
+            if (!sources[count++].doc_map) status = -1;
+        }
+    }
+    
+    
+    int term_count = status == 0 ? merge_mapped_indexes(sources, count, output) : -1;
+    char* store_path = document_store_path(output);
+    if (term_count < 0 || !store_path || merge_document_stores(segments, sources, count, store_path) != 0) {
+        status = -1;
+    }
+    
+    if (status == 0) {
+        printf("Merged %d segments from %d indexes into %s: %d terms, %d documents\n",
+               count, input_count, output, term_count, doc_count);
+    } else {
+        printf("Cannot merge indexes into %s\n", output);
+    }
+    
+    for (int s = 0; s < count; s++) {
+        free((int*)sources[s].doc_map);
+    }
+    for (int i = 0; i < input_count; i++) {
+        close_segmented_index(opened[i]);
+    }
+    for (int t = 0; t < converted; t++) {
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp%d", output, t);
+        remove(tmp_path);
+    }
+    
+    free(store_path);
+    free(sources);
+    free(segments);
+    free(opened);
+    return status;
+}
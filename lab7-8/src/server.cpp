@@ -0,0 +1,464 @@
+#include "../include/server.h"
+#include "../include/latency.h"
+#include "../include/search.h"
+#include "../include/utils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+
+typedef struct {
+    int fd;
+    char buffer[SERVER_MAX_LINE];
+    size_t length;
+} LineReader;
+
+
+typedef struct {
+    SegmentedIndex* segmented;
+    QueryCache* results;
+    QueryCache* intersections;
+    std::vector<LineReader*> ready;
+    std::vector<LineReader*> returned;
+    std::mutex lock;
+    std::condition_variable wake_worker;
+    int wake_poller[2];
+} ServerState;
+
+static bool is_unix_address(const char* address) {
+    return strncmp(address, "unix:", 5) == 0 || strchr(address, '/') != nullptr;
+}
+
+static int open_socket(const char* address, bool listening) {
+    if (is_unix_address(address)) {
+        const char* path = strncmp(address, "unix:", 5) == 0 ? address + 5 : address;
+        struct sockaddr_un local;
+        memset(&local, 0, sizeof(local));
+        local.sun_family = AF_UNIX;
+        if (strlen(path) >= sizeof(local.sun_path)) return -1;
+        strcpy(local.sun_path, path);
+        
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        if (listening) unlink(path);
+        
+        int status = listening ? bind(fd, (struct sockaddr*)&local, sizeof(local)) 
+                               : connect(fd, (struct sockaddr*)&local, sizeof(local));
+        if (status != 0 || (listening && listen(fd, SERVER_BACKLOG) != 0)) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    
+    
+    char host[64] = "127.0.0.1";
+    const char* port = strrchr(address, ':');
+    if (port) {
+        size_t length = port - address;
+        if (length == 0 || length >= sizeof(host)) return -1;
+        memcpy(host, address, length);
+        host[length] = '\0';
+        if (strcmp(host, "localhost") == 0) strcpy(host, "127.0.0.1");
+        port++;
+    } else {
+        port = address;
+    }
+    
+    struct sockaddr_in inet;
+    memset(&inet, 0, sizeof(inet));
+    inet.sin_family = AF_INET;
+    inet.sin_port = htons((unsigned short)atoi(port));
+    if (atoi(port) <= 0 || inet_pton(AF_INET, host, &inet.sin_addr) != 1) return -1;
+    
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    
+    int status = listening ? bind(fd, (struct sockaddr*)&inet, sizeof(inet)) 
+                           : connect(fd, (struct sockaddr*)&inet, sizeof(inet));
+    if (status != 0 || (listening && listen(fd, SERVER_BACKLOG) != 0)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int take_line(LineReader* reader, char* line) {
+    char* newline = (char*)memchr(reader->buffer, '\n', reader->length);
+    if (!newline) return reader->length == sizeof(reader->buffer) ? -1 : 0;
+    
+    size_t length = newline - reader->buffer;
+    memcpy(line, reader->buffer, length);
+    line[length] = '\0';
+    if (length > 0 && line[length - 1] == '\r') line[length - 1] = '\0';
+    
+    reader->length -= length + 1;
+    memmove(reader->buffer, newline + 1, reader->length);
+    return 1;
+}
+
+static int fill_reader(LineReader* reader) {
+    while (true) {
+        ssize_t received = recv(reader->fd, reader->buffer + reader->length, sizeof(reader->buffer) - reader->length, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return 0;
+        reader->length += received;
+        return 1;
+    }
+}
+
+static int read_line(LineReader* reader, char* line) {
+    bool truncated = false;
+    while (true) {
+        char* newline = (char*)memchr(reader->buffer, '\n', reader->length);
+        if (newline && !truncated) return take_line(reader, line);
+        if (newline) {
+            reader->length -= newline + 1 - reader->buffer;
+            memmove(reader->buffer, newline + 1, reader->length);
+            return 1;
+        }
+        
+        
+        if (reader->length == sizeof(reader->buffer)) {
+            if (!truncated) {
+                memcpy(line, reader->buffer, sizeof(reader->buffer) - 1);
+                line[sizeof(reader->buffer) - 1] = '\0';
+            }
+            truncated = true;
+            reader->length = 0;
+        }
+        if (fill_reader(reader) == 0) return 0;
+    }
+}
+
+static int send_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return -1;
+        data += sent;
+        length -= sent;
+    }
+    return 0;
+}
+
+static void answer_stats(ServerState* state, char* response, size_t capacity) {
+    size_t used = snprintf(response, capacity, "OK ");
+    used += format_cache_stats(state->results, "result", response + used, capacity - used);
+    if (used + 2 < capacity) used += snprintf(response + used, capacity - used, "; ");
+    if (used < capacity) used += format_cache_stats(state->intersections, "intersection", response + used, capacity - used);
+    if (used + 1 < capacity) snprintf(response + used, capacity - used, "\n");
+}
+
+static void answer_query(ServerState* state, const char* line, char** buffer, size_t* buffer_capacity) {
+    char* response = *buffer;
+    size_t capacity = *buffer_capacity;
+    if (strcmp(line, "STATS") == 0) {
+        answer_stats(state, response, capacity);
+        return;
+    }
+    
+    SearchContext context;
+    memset(&context, 0, sizeof(SearchContext));
+    
+    const char* query = parse_search_options(line, &context);
+    context.tree = query ? parse_query(query) : nullptr;
+    if (!context.tree) {
+        snprintf(response, capacity, "ERR invalid query\n");
+        return;
+    }
+    
+    ResultSet result;
+    if (run_search(state->segmented, &context, state->results, &result) < 0) {
+        snprintf(response, capacity, "ERR search failed\n");
+        free_query(context.tree);
+        return;
+    }
+    
+    int shown = context.top > 0 || context.limit > 0 ? result.count : std::min(result.count, SERVER_RESULT_IDS);
+    size_t needed = 32 + (size_t)shown * SERVER_RESULT_WIDTH;
+    if (needed > capacity) {
+        char* grown = (char*)realloc(response, needed);
+        if (grown) {
+            *buffer = response = grown;
+            *buffer_capacity = capacity = needed;
+        }
+    }
+    
+    size_t used = snprintf(response, capacity, "OK %d", result.count);
+    for (int i = 0; i < shown && used + 32 < capacity; i++) {
+        if (result.scores) {
+            used += snprintf(response + used, capacity - used, " %d:%.4f", result.doc_ids[i], result.scores[i]);
+        } else {
+            used += snprintf(response + used, capacity - used, " %d", result.doc_ids[i]);
+        }
+    }
+    
+    snprintf(response + used, capacity - used, "\n");
+    free_result_set(&result);
+    free_query(context.tree);
+}
+
+static int serve_ready_lines(ServerState* state, LineReader* reader, char* line, char** response, size_t* capacity) {
+    if (fill_reader(reader) == 0) return 0;
+    
+    int status;
+    while ((status = take_line(reader, line)) > 0) {
+        answer_query(state, line, response, capacity);
+        if (send_all(reader->fd, *response, strlen(*response)) != 0) return 0;
+    }
+    
+    if (status < 0) {
+        send_all(reader->fd, "ERR line too long\n", 18);
+        return 0;
+    }
+    return 1;
+}
+
+static void server_worker(ServerState* state) {
+    char* line = (char*)malloc(SERVER_MAX_LINE);
+    char* response = (char*)malloc(SERVER_MAX_LINE);
+    size_t capacity = SERVER_MAX_LINE;
+    
+    while (line && response) {
+        LineReader* reader;
+        {
+            std::unique_lock<std::mutex> guard(state->lock);
+            state->wake_worker.wait(guard, [state] { return !state->ready.empty(); });
+            reader = state->ready.back();
+            state->ready.pop_back();
+        }
+        
+        if (serve_ready_lines(state, reader, line, &response, &capacity)) {
+            std::lock_guard<std::mutex> guard(state->lock);
+            state->returned.push_back(reader);
+            write(state->wake_poller[1], "w", 1);
+        } else {
+            close(reader->fd);
+            free(reader);
+        }
+    }
+    
+    free(line);
+    free(response);
+}
+
+static void poll_connections(ServerState* state, int listener) {
+    std::vector<LineReader*> idle;
+    std::vector<struct pollfd> watched;
+    
+    while (true) {
+        {
+            std::lock_guard<std::mutex> guard(state->lock);
+            idle.insert(idle.end(), state->returned.begin(), state->returned.end());
+            state->returned.clear();
+        }
+        
+        watched.resize(idle.size() + 2);
+        watched[0].fd = listener;
+        watched[1].fd = state->wake_poller[0];
+        for (size_t i = 0; i < idle.size(); i++) {
+            watched[i + 2].fd = idle[i]->fd;
+        }
+        for (size_t i = 0; i < watched.size(); i++) {
+            watched[i].events = POLLIN;
+            watched[i].revents = 0;
+        }
+        
+        if (poll(watched.data(), watched.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        
+        
+        if (watched[1].revents) {
+            char drain[64];
+            read(state->wake_poller[0], drain, sizeof(drain));
+        }
+        
+        size_t kept = 0;
+        for (size_t i = 0; i < idle.size(); i++) {
+            if (watched[i + 2].revents == 0) {
+                idle[kept++] = idle[i];
+                continue;
+            }
+            
+            std::lock_guard<std::mutex> guard(state->lock);
+            state->ready.push_back(idle[i]);
+            state->wake_worker.notify_one();
+        }
+        idle.resize(kept);
+        
+        if (watched[0].revents) {
+            int fd = accept(listener, nullptr, nullptr);
+            LineReader* reader = fd >= 0 ? (LineReader*)malloc(sizeof(LineReader)) : nullptr;
+            if (reader) {
+                reader->fd = fd;
+                reader->length = 0;
+                idle.push_back(reader);
+            } else if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+}
+
+int run_server(const char* index_file, const char* address, int thread_count, size_t cache_bytes) {
+    if (thread_count < 1) thread_count = 1;
+    
+    SegmentedIndex* segmented = open_segmented_index(index_file);
+    if (!segmented) {
+        printf("Cannot load index from: %s\n", index_file);
+        return -1;
+    }
+    
+    ServerState state;
+    state.segmented = segmented;
+    state.results = cache_bytes > 0 ? create_query_cache(cache_bytes - cache_bytes / 4, 0) : nullptr;
+    state.intersections = cache_bytes > 0 ? create_query_cache(cache_bytes / 4, 1) : nullptr;
+    attach_intersection_cache(segmented, state.intersections);
+    int listener = open_socket(address, true);
+    if (listener < 0 || pipe(state.wake_poller) != 0) {
+        printf("Cannot listen on: %s (%s)\n", address, strerror(errno));
+        if (listener >= 0) close(listener);
+        free_query_cache(state.results);
+        free_query_cache(state.intersections);
+        close_segmented_index(segmented);
+        return -1;
+    }
+    
+    printf("Index loaded. Segments: %d, live documents: %d\n", segmented->count, live_document_count(segmented));
+    printf("Serving on %s with %d worker threads, %zu MB query cache\n", address, thread_count, cache_bytes >> 20);
+    fflush(stdout);
+    
+    
+    for (int t = 0; t < thread_count; t++) {
+        std::thread(server_worker, &state).detach();
+    }
+    
+    poll_connections(&state, listener);
+    
+    printf("Poll failed: %s\n", strerror(errno));
+    fflush(stdout);
+    _exit(1);
+}
+
+static void load_worker(const char* address, char** queries, int query_count, int offset, double seconds,
+                        std::vector<double>* latencies, int* errors) {
+    int fd = open_socket(address, false);
+    if (fd < 0) {
+        (*errors)++;
+        return;
+    }
+    
+    LineReader* reader = (LineReader*)malloc(sizeof(LineReader));
+    char* request = (char*)malloc(SERVER_MAX_LINE + 1);
+    char* response = (char*)malloc(SERVER_MAX_LINE);
+    if (!reader || !request || !response) {
+        (*errors)++;
+        free(reader);
+        free(request);
+        free(response);
+        close(fd);
+        return;
+    }
+    reader->fd = fd;
+    reader->length = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int q = offset; ; q++) {
+        auto sent = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(sent - start).count() >= seconds) break;
+        
+        int length = snprintf(request, SERVER_MAX_LINE + 1, "%s\n", queries[q % query_count]);
+        if (send_all(fd, request, length) != 0 || read_line(reader, response) <= 0) {
+            (*errors)++;
+            break;
+        }
+        if (strncmp(response, "OK", 2) != 0) (*errors)++;
+        
+        latencies->push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+    }
+    
+    free(reader);
+    free(request);
+    free(response);
+    close(fd);
+}
+
+static void print_server_stats(const char* address) {
+    int fd = open_socket(address, false);
+    LineReader* reader = fd >= 0 ? (LineReader*)malloc(sizeof(LineReader)) : nullptr;
+    char* response = reader ? (char*)malloc(SERVER_MAX_LINE) : nullptr;
+    
+    if (response) {
+        reader->fd = fd;
+        reader->length = 0;
+        if (send_all(fd, "STATS\n", 6) == 0 && read_line(reader, response) > 0 && strncmp(response, "OK ", 3) == 0) {
+            for (char* part = strtok(response + 3, ";"); part; part = strtok(nullptr, ";")) {
+                printf("Server %s\n", part + strspn(part, " "));
+            }
+        }
+    }
+    
+    free(reader);
+    free(response);
+    if (fd >= 0) close(fd);
+}
+
+int run_load_generator(const char* address, const char* queries_file, int connections, double seconds) {
+    int query_count = 0;
+    char** queries = read_lines(queries_file, &query_count);
+    if (query_count == 0) {
+        printf("No queries in: %s\n", queries_file);
+        free_string_array(queries, query_count);
+        return -1;
+    }
+    if (connections < 1) connections = 1;
+    
+    printf("Sending %d queries from %s over %d connections for %.1f s\n", query_count, queries_file, connections, seconds);
+    
+    std::vector<std::vector<double> > latencies(connections);
+    std::vector<int> errors(connections, 0);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < connections; c++) {
+        clients.push_back(std::thread(load_worker, address, queries, query_count, c * query_count / connections, 
+                                      seconds, &latencies[c], &errors[c]));
+    }
+    for (size_t c = 0; c < clients.size(); c++) {
+        clients[c].join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    
+    std::vector<double> all;
+    int error_count = 0;
+    for (int c = 0; c < connections; c++) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        error_count += errors[c];
+    }
+    print_latency_report(all.data(), (int)all.size(), elapsed);
+    if (error_count > 0) printf("Errors: %d\n", error_count);
+    print_server_stats(address);
+    
+    free_string_array(queries, query_count);
+    return error_count == 0 ? 0 : -1;
+}
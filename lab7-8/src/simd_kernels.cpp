@@ -0,0 +1,306 @@
+#include "../include/simd_kernels.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+static int intersect_scalar(const int* arr1, int count1, const int* arr2, int count2, int* out) {
+    int i = 0, j = 0, k = 0;
+    while (i < count1 && j < count2) {
+        if (arr1[i] < arr2[j]) {
+            i++;
+        } else if (arr1[i] > arr2[j]) {
+            j++;
+        } else {
+            out[k++] = arr1[i];
+            i++;
+            j++;
+        }
+    }
+    return k;
+}
+
+static int union_scalar(const int* arr1, int count1, const int* arr2, int count2, int* out) {
+    int i = 0, j = 0, k = 0;
+    while (i < count1 && j < count2) {
+        if (arr1[i] < arr2[j]) {
+            out[k++] = arr1[i++];
+        } else if (arr1[i] > arr2[j]) {
+            out[k++] = arr2[j++];
+        } else {
+            out[k++] = arr1[i];
+            i++;
+            j++;
+        }
+    }
+    
+    while (i < count1) {
+        out[k++] = arr1[i++];
+    }
+    
+    while (j < count2) {
+        out[k++] = arr2[j++];
+    }
+    
+    return k;
+}
+
+static void score_scalar(const float* tf, const float* norms, int count, float weight, float* scores) {
+    for (int i = 0; i < count; i++) {
+        scores[i] += weight * tf[i] / (tf[i] + norms[i]);
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+
+static unsigned char SSE_COMPRESS[16][16];
+static int AVX2_COMPRESS[256][8];
+
+static void init_compress_tables() {
+    for (int mask = 0; mask < 16; mask++) {
+        int k = 0;
+        memset(SSE_COMPRESS[mask], 0x80, 16);
+        for (int lane = 0; lane < 4; lane++) {
+            if (mask & (1 << lane)) {
+                for (int b = 0; b < 4; b++) {
+                    SSE_COMPRESS[mask][k * 4 + b] = (unsigned char)(lane * 4 + b);
+                }
+                k++;
+            }
+        }
+    }
+    
+    for (int mask = 0; mask < 256; mask++) {
+        int k = 0;
+        for (int lane = 0; lane < 8; lane++) {
+            if (mask & (1 << lane)) AVX2_COMPRESS[mask][k++] = lane;
+        }
+        while (k < 8) AVX2_COMPRESS[mask][k++] = 0;
+    }
+}
+
+__attribute__((target("sse4.2")))
+static int intersect_sse42(const int* arr1, int count1, const int* arr2, int count2, int* out) {
+    int i = 0, j = 0, k = 0;
+    
+    while (i + 4 <= count1 && j + 4 <= count2) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(arr1 + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(arr2 + j));
+        
+        
+        __m128i eq = _mm_cmpeq_epi32(a, b);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3))));
+        
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        __m128i matched = _mm_shuffle_epi8(a, _mm_loadu_si128((const __m128i*)SSE_COMPRESS[mask]));
+        _mm_storeu_si128((__m128i*)(out + k), matched);
+        k += __builtin_popcount(mask);
+        
+        int a_max = arr1[i + 3];
+        int b_max = arr2[j + 3];
+        if (a_max <= b_max) i += 4;
+        if (b_max <= a_max) j += 4;
+    }
+    
+    return k + intersect_scalar(arr1 + i, count1 - i, arr2 + j, count2 - j, out + k);
+}
+
+__attribute__((target("avx2")))
+static int intersect_avx2(const int* arr1, int count1, const int* arr2, int count2, int* out) {
+    int i = 0, j = 0, k = 0;
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    
+    while (i + 8 <= count1 && j + 8 <= count2) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(arr1 + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(arr2 + j));
+        
+        
+        __m256i eq = _mm256_cmpeq_epi32(a, b);
+        for (int r = 1; r < 8; r++) {
+            b = _mm256_permutevar8x32_epi32(b, rotate);
+            eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(a, b));
+        }
+        
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        __m256i order = _mm256_loadu_si256((const __m256i*)AVX2_COMPRESS[mask]);
+        _mm256_storeu_si256((__m256i*)(out + k), _mm256_permutevar8x32_epi32(a, order));
+        k += __builtin_popcount(mask);
+        
+        int a_max = arr1[i + 7];
+        int b_max = arr2[j + 7];
+        if (a_max <= b_max) i += 8;
+        if (b_max <= a_max) j += 8;
+    }
+    
+    return k + intersect_scalar(arr1 + i, count1 - i, arr2 + j, count2 - j, out + k);
+}
+
+__attribute__((target("sse4.2")))
+static void score_sse42(const float* tf, const float* norms, int count, float weight, float* scores) {
+    const __m128 w = _mm_set1_ps(weight);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 t = _mm_loadu_ps(tf + i);
+        __m128 s = _mm_div_ps(_mm_mul_ps(w, t), _mm_add_ps(t, _mm_loadu_ps(norms + i)));
+        _mm_storeu_ps(scores + i, _mm_add_ps(_mm_loadu_ps(scores + i), s));
+    }
+    score_scalar(tf + i, norms + i, count - i, weight, scores + i);
+}
+
+__attribute__((target("avx2")))
+static void score_avx2(const float* tf, const float* norms, int count, float weight, float* scores) {
+    const __m256 w = _mm256_set1_ps(weight);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 t = _mm256_loadu_ps(tf + i);
+        __m256 s = _mm256_div_ps(_mm256_mul_ps(w, t), _mm256_add_ps(t, _mm256_loadu_ps(norms + i)));
+        _mm256_storeu_ps(scores + i, _mm256_add_ps(_mm256_loadu_ps(scores + i), s));
+    }
+    score_scalar(tf + i, norms + i, count - i, weight, scores + i);
+}
+
+__attribute__((target("sse4.2")))
+static inline void sse_merge(__m128i* low, __m128i* high) {
+    __m128i min = _mm_min_epi32(*low, *high);
+    __m128i max = _mm_max_epi32(*low, *high);
+    
+    
+    for (int round = 0; round < 3; round++) {
+        min = _mm_alignr_epi8(min, min, 4);
+        __m128i next_min = _mm_min_epi32(min, max);
+        max = _mm_max_epi32(min, max);
+        min = next_min;
+    }
+    
+    *low = _mm_alignr_epi8(min, min, 4);
+    *high = max;
+}
+
+__attribute__((target("sse4.2")))
+static inline int emit_unique(__m128i values, __m128i* last, int* out) {
+    __m128i previous = _mm_alignr_epi8(values, *last, 12);
+    int mask = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(values, previous))) & 0xf;
+    
+    _mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(values, _mm_loadu_si128((const __m128i*)SSE_COMPRESS[mask])));
+    *last = values;
+    return __builtin_popcount(mask);
+}
+
+static int union_tail(int last, int has_last, const int* arr1, int count1, const int* arr2, int count2, int* out) {
+    int i = 0, j = 0, k = 0;
+    
+    while (i < count1 || j < count2) {
+        int value;
+        if (j >= count2 || (i < count1 && arr1[i] <= arr2[j])) {
+            value = arr1[i++];
+        } else {
+            value = arr2[j++];
+        }
+        
+        if (!has_last || value != last) {
+            out[k++] = value;
+            last = value;
+            has_last = 1;
+        }
+    }
+    
+    return k;
+}
+
+__attribute__((target("sse4.2")))
+static int union_sse42(const int* arr1, int count1, const int* arr2, int count2, int* out) {
+    if (count1 < 4 || count2 < 4) {
+        return union_scalar(arr1, count1, arr2, count2, out);
+    }
+    
+    int i = 4, j = 4, k = 0;
+    __m128i low = _mm_loadu_si128((const __m128i*)arr1);
+    __m128i high = _mm_loadu_si128((const __m128i*)arr2);
+    __m128i last = _mm_set1_epi32(arr1[0] < arr2[0] ? arr1[0] - 1 : arr2[0] - 1);
+    
+    sse_merge(&low, &high);
+    k += emit_unique(low, &last, out + k);
+    
+    
+    while (i + 4 <= count1 && j + 4 <= count2) {
+        if (arr1[i] <= arr2[j]) {
+            low = _mm_loadu_si128((const __m128i*)(arr1 + i));
+            i += 4;
+        } else {
+            low = _mm_loadu_si128((const __m128i*)(arr2 + j));
+            j += 4;
+        }
+        
+        sse_merge(&low, &high);
+        k += emit_unique(low, &last, out + k);
+    }
+    
+    
+    int pending[4];
+    int merged[12];
+    _mm_storeu_si128((__m128i*)pending, high);
+    int last_value = _mm_extract_epi32(last, 3);
+    
+    const int* rest1 = arr1 + i;
+    const int* rest2 = arr2 + j;
+    int rest1_count = count1 - i;
+    int rest2_count = count2 - j;
+    
+    if (rest1_count < 4) {
+        int merged_count = union_scalar(pending, 4, rest1, rest1_count, merged);
+        return k + union_tail(last_value, 1, merged, merged_count, rest2, rest2_count, out + k);
+    }
+    
+    int merged_count = union_scalar(pending, 4, rest2, rest2_count, merged);
+    return k + union_tail(last_value, 1, merged, merged_count, rest1, rest1_count, out + k);
+}
+
+#endif
+
+static const SimdKernels KERNELS[] = {
+    {SIMD_LEVEL_SCALAR, "scalar", intersect_scalar, union_scalar, score_scalar},
+#ifdef HAVE_X86_KERNELS
+    {SIMD_LEVEL_SSE42, "sse4.2", intersect_sse42, union_sse42, score_sse42},
+    {SIMD_LEVEL_AVX2, "avx2", intersect_avx2, union_sse42, score_avx2},
+#endif
+};
+
+static int detect_level() {
+#ifdef HAVE_X86_KERNELS
+    init_compress_tables();
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_LEVEL_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return SIMD_LEVEL_SSE42;
+#endif
+    return SIMD_LEVEL_SCALAR;
+}
+
+static int supported_level() {
+    static const int level = detect_level();
+    return level;
+}
+
+const SimdKernels* get_simd_kernels_for_level(int level) {
+    if (level < 0 || level > supported_level()) return nullptr;
+    return &KERNELS[level];
+}
+
+const SimdKernels* get_simd_kernels() {
+    return &KERNELS[supported_level()];
+}
+
+int intersect_kernel(const int* arr1, int count1, const int* arr2, int count2, int* out) {
+    return get_simd_kernels()->intersect(arr1, count1, arr2, count2, out);
+}
+
+int union_kernel(const int* arr1, int count1, const int* arr2, int count2, int* out) {
+    return get_simd_kernels()->merge(arr1, count1, arr2, count2, out);
+}
+
+void score_kernel(const float* tf, const float* norms, int count, float weight, float* scores) {
+    get_simd_kernels()->score(tf, norms, count, weight, scores);
+}
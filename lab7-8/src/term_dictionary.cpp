@@ -0,0 +1,442 @@
+#include "../include/term_dictionary.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+typedef struct {
+    TermDictionary* dictionary;
+    int block;
+    int ordinal;
+    size_t offset;
+    char* term;
+    int length;
+} DictionaryCursor;
+
+
+typedef struct {
+    const int* terms;
+    int count;
+} GramList;
+
+static size_t put_varint(unsigned char* out, unsigned int value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+static unsigned int get_varint(const unsigned char* data, size_t* offset) {
+    unsigned int value = 0;
+    int shift = 0;
+    while (data[*offset] & 0x80) {
+        value |= (unsigned int)(data[(*offset)++] & 0x7f) << shift;
+        shift += 7;
+    }
+    value |= (unsigned int)data[(*offset)++] << shift;
+    return value;
+}
+
+static unsigned int pack_gram(const char* text) {
+    return ((unsigned int)(unsigned char)text[0] << 16) | ((unsigned int)(unsigned char)text[1] << 8) | 
+           (unsigned int)(unsigned char)text[2];
+}
+
+static int compare_block_first(TermDictionary* dictionary, int block, const char* text, size_t length) {
+    size_t offset = dictionary->block_offsets[block];
+    unsigned int first_length = get_varint(dictionary->data, &offset);
+    int cmp = memcmp(dictionary->data + offset, text, std::min((size_t)first_length, length));
+    if (cmp != 0) return cmp;
+    return first_length < length ? -1 : first_length > length ? 1 : 0;
+}
+
+static void seek_block(DictionaryCursor* cursor, int block) {
+    TermDictionary* dictionary = cursor->dictionary;
+    cursor->block = block;
+    cursor->ordinal = block * DICTIONARY_BLOCK_SIZE;
+    cursor->offset = dictionary->block_offsets[block];
+    
+    unsigned int length = get_varint(dictionary->data, &cursor->offset);
+    memcpy(cursor->term, dictionary->data + cursor->offset, length);
+    cursor->term[length] = '\0';
+    cursor->length = (int)length;
+    cursor->offset += length;
+}
+
+static const char* seek_term(DictionaryCursor* cursor, int ordinal) {
+    int block = ordinal / DICTIONARY_BLOCK_SIZE;
+    if (block != cursor->block || ordinal < cursor->ordinal) seek_block(cursor, block);
+    
+    while (cursor->ordinal < ordinal) {
+        unsigned int shared = get_varint(cursor->dictionary->data, &cursor->offset);
+        unsigned int suffix = get_varint(cursor->dictionary->data, &cursor->offset);
+        memcpy(cursor->term + shared, cursor->dictionary->data + cursor->offset, suffix);
+        cursor->offset += suffix;
+        cursor->length = (int)(shared + suffix);
+        cursor->term[cursor->length] = '\0';
+        cursor->ordinal++;
+    }
+    return cursor->term;
+}
+
+static int radix_sort_grams(unsigned long long* pairs, size_t count) {
+    unsigned long long* scratch = (unsigned long long*)malloc((count + 1) * sizeof(unsigned long long));
+    if (!scratch) return -1;
+    
+    unsigned long long* from = pairs;
+    unsigned long long* to = scratch;
+    for (int shift = 32; shift < 32 + 8 * KGRAM_SIZE; shift += 8) {
+        size_t offsets[257] = {0};
+        for (size_t i = 0; i < count; i++) {
+            offsets[((from[i] >> shift) & 0xff) + 1]++;
+        }
+        for (int b = 0; b < 256; b++) {
+            offsets[b + 1] += offsets[b];
+        }
+        for (size_t i = 0; i < count; i++) {
+            to[offsets[(from[i] >> shift) & 0xff]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+    
+    if (from != pairs) memcpy(pairs, from, count * sizeof(unsigned long long));
+    free(scratch);
+    return 0;
+}
+
+static int build_kgrams(TermDictionary* dictionary, const char** sorted_terms) {
+    size_t pair_count = 0;
+    for (int t = 0; t < dictionary->term_count; t++) {
+        pair_count += strlen(sorted_terms[t]);
+    }
+    
+    unsigned long long* pairs = (unsigned long long*)malloc((pair_count + 1) * sizeof(unsigned long long));
+    char* padded = (char*)malloc(dictionary->max_length + 3);
+    if (!pairs || !padded) {
+        free(pairs);
+        free(padded);
+        return -1;
+    }
+    
+    
+    size_t n = 0;
+    for (int t = 0; t < dictionary->term_count; t++) {
+        size_t length = strlen(sorted_terms[t]);
+        padded[0] = KGRAM_BOUNDARY;
+        memcpy(padded + 1, sorted_terms[t], length);
+        padded[length + 1] = KGRAM_BOUNDARY;
+        
+        for (size_t i = 0; i + KGRAM_SIZE <= length + 2; i++) {
+            pairs[n++] = ((unsigned long long)pack_gram(padded + i) << 32) | (unsigned int)t;
+        }
+    }
+    free(padded);
+    
+    if (radix_sort_grams(pairs, n) != 0) {
+        free(pairs);
+        return -1;
+    }
+    n = std::unique(pairs, pairs + n) - pairs;
+    
+    int gram_count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i == 0 || (pairs[i] >> 32) != (pairs[i - 1] >> 32)) gram_count++;
+    }
+    
+    dictionary->grams = (unsigned int*)malloc((gram_count + 1) * sizeof(unsigned int));
+    dictionary->gram_offsets = (unsigned int*)malloc((gram_count + 1) * sizeof(unsigned int));
+    dictionary->gram_terms = (int*)malloc((n + 1) * sizeof(int));
+    if (!dictionary->grams || !dictionary->gram_offsets || !dictionary->gram_terms) {
+        free(pairs);
+        return -1;
+    }
+    
+    int g = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i == 0 || (pairs[i] >> 32) != (pairs[i - 1] >> 32)) {
+            dictionary->grams[g] = (unsigned int)(pairs[i] >> 32);
+            dictionary->gram_offsets[g++] = (unsigned int)i;
+        }
+        dictionary->gram_terms[i] = (int)(pairs[i] & 0xffffffffu);
+    }
+    dictionary->gram_offsets[g] = (unsigned int)n;
+    dictionary->gram_count = gram_count;
+    dictionary->memory_bytes += (2 * (gram_count + 1)) * sizeof(unsigned int) + n * sizeof(int);
+    
+    free(pairs);
+    return 0;
+}
+
+TermDictionary* build_term_dictionary(const char** sorted_terms, const int* entries, int count) {
+    TermDictionary* dictionary = (TermDictionary*)calloc(1, sizeof(TermDictionary));
+    if (!dictionary) return nullptr;
+    
+    dictionary->term_count = count;
+    dictionary->block_count = (count + DICTIONARY_BLOCK_SIZE - 1) / DICTIONARY_BLOCK_SIZE;
+    
+    size_t capacity = 0;
+    for (int t = 0; t < count; t++) {
+        int length = (int)strlen(sorted_terms[t]);
+        capacity += length + 10;
+        if (length > dictionary->max_length) dictionary->max_length = length;
+    }
+    
+    dictionary->data = (unsigned char*)malloc(capacity + 1);
+    dictionary->block_offsets = (unsigned int*)malloc((dictionary->block_count + 1) * sizeof(unsigned int));
+    if (entries) dictionary->entries = (int*)malloc((count + 1) * sizeof(int));
+    if (!dictionary->data || !dictionary->block_offsets || (entries && !dictionary->entries)) {
+        free_term_dictionary(dictionary);
+        return nullptr;
+    }
+    if (entries) memcpy(dictionary->entries, entries, count * sizeof(int));
+    
+    
+    size_t used = 0;
+    const char* previous = "";
+    for (int t = 0; t < count; t++) {
+        const char* term = sorted_terms[t];
+        unsigned int length = (unsigned int)strlen(term);
+        
+        if (t % DICTIONARY_BLOCK_SIZE == 0) {
+            dictionary->block_offsets[t / DICTIONARY_BLOCK_SIZE] = (unsigned int)used;
+            used += put_varint(dictionary->data + used, length);
+            memcpy(dictionary->data + used, term, length);
+            used += length;
+        } else {
+            unsigned int shared = 0;
+            while (previous[shared] && previous[shared] == term[shared]) shared++;
+            used += put_varint(dictionary->data + used, shared);
+            used += put_varint(dictionary->data + used, length - shared);
+            memcpy(dictionary->data + used, term + shared, length - shared);
+            used += length - shared;
+        }
+        previous = term;
+    }
+    dictionary->block_offsets[dictionary->block_count] = (unsigned int)used;
+    dictionary->data_size = used;
+    dictionary->memory_bytes = sizeof(TermDictionary) + used + (dictionary->block_count + 1) * sizeof(unsigned int) +
+                               (entries ? count * sizeof(int) : 0);
+    
+    if (build_kgrams(dictionary, sorted_terms) != 0) {
+        free_term_dictionary(dictionary);
+        return nullptr;
+    }
+    return dictionary;
+}
+
+void free_term_dictionary(TermDictionary* dictionary) {
+    if (!dictionary) return;
+    
+    free(dictionary->data);
+    free(dictionary->block_offsets);
+    free(dictionary->entries);
+    free(dictionary->grams);
+    free(dictionary->gram_offsets);
+    free(dictionary->gram_terms);
+    free(dictionary);
+}
+
+static int lower_bound_term(TermDictionary* dictionary, DictionaryCursor* cursor, const char* text, size_t length) {
+    int lo = 0;
+    int hi = dictionary->block_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (compare_block_first(dictionary, mid, text, length) < 0) lo = mid + 1; else hi = mid;
+    }
+    
+    
+    if (lo == 0) return 0;
+    int ordinal = (lo - 1) * DICTIONARY_BLOCK_SIZE;
+    int end = std::min(lo * DICTIONARY_BLOCK_SIZE, dictionary->term_count);
+    for (; ordinal < end; ordinal++) {
+        const char* term = seek_term(cursor, ordinal);
+        int cmp = strncmp(term, text, length);
+        if (cmp > 0 || (cmp == 0 && strlen(term) >= length)) break;
+    }
+    return ordinal;
+}
+
+static int open_dictionary_cursor(TermDictionary* dictionary, DictionaryCursor* cursor) {
+    cursor->dictionary = dictionary;
+    cursor->block = -1;
+    cursor->ordinal = 0;
+    cursor->offset = 0;
+    cursor->length = 0;
+    cursor->term = (char*)malloc(dictionary->max_length + 1);
+    return cursor->term ? 0 : -1;
+}
+
+int find_prefix_range(TermDictionary* dictionary, const char* prefix, int* first, int* last) {
+    *first = *last = 0;
+    if (!dictionary || dictionary->term_count == 0) return 0;
+    
+    DictionaryCursor cursor;
+    if (open_dictionary_cursor(dictionary, &cursor) != 0) return -1;
+    
+    size_t length = strlen(prefix);
+    *first = lower_bound_term(dictionary, &cursor, prefix, length);
+    
+    
+    char* upper = (char*)malloc(length + 1);
+    int trimmed = (int)length;
+    if (upper) memcpy(upper, prefix, length);
+    while (upper && trimmed > 0 && (unsigned char)upper[trimmed - 1] == 0xff) trimmed--;
+    
+    if (!upper) {
+        *last = *first;
+    } else if (trimmed == 0) {
+        *last = dictionary->term_count;
+    } else {
+        upper[trimmed - 1]++;
+        *last = lower_bound_term(dictionary, &cursor, upper, trimmed);
+    }
+    
+    free(upper);
+    free(cursor.term);
+    return upper ? *last - *first : -1;
+}
+
+int match_wildcard(const char* pattern, const char* term) {
+    const char* star = nullptr;
+    const char* resume = nullptr;
+    
+    while (*term) {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = term;
+        } else if (*pattern == *term) {
+            pattern++;
+            term++;
+        } else if (star) {
+            pattern = star + 1;
+            term = ++resume;
+        } else {
+            return 0;
+        }
+    }
+    
+    while (*pattern == '*') pattern++;
+    return *pattern == '\0';
+}
+
+static const int* gram_terms(TermDictionary* dictionary, const char* gram, int* count) {
+    unsigned int key = pack_gram(gram);
+    unsigned int* found = std::lower_bound(dictionary->grams, dictionary->grams + dictionary->gram_count, key);
+    if (found == dictionary->grams + dictionary->gram_count || *found != key) {
+        *count = 0;
+        return nullptr;
+    }
+    
+    int g = (int)(found - dictionary->grams);
+    *count = (int)(dictionary->gram_offsets[g + 1] - dictionary->gram_offsets[g]);
+    return dictionary->gram_terms + dictionary->gram_offsets[g];
+}
+
+static int intersect_in_place(int* target, int target_count, const int* other, int other_count) {
+    int k = 0;
+    int j = 0;
+    for (int i = 0; i < target_count && j < other_count; i++) {
+        while (j < other_count && other[j] < target[i]) j++;
+        if (j < other_count && other[j] == target[i]) target[k++] = target[i];
+    }
+    return k;
+}
+
+static int* gram_candidates(TermDictionary* dictionary, const char* pattern, int* candidate_count, bool* filtered) {
+    size_t length = strlen(pattern);
+    char* padded = (char*)malloc(length + 3);
+    GramList* lists = (GramList*)malloc((length + 1) * sizeof(GramList));
+    if (!padded || !lists) {
+        free(padded);
+        free(lists);
+        return nullptr;
+    }
+    padded[0] = KGRAM_BOUNDARY;
+    memcpy(padded + 1, pattern, length);
+    padded[length + 1] = KGRAM_BOUNDARY;
+    
+    int list_count = 0;
+    for (size_t i = 0; i + KGRAM_SIZE <= length + 2; i++) {
+        if (memchr(padded + i, '*', KGRAM_SIZE)) continue;
+        lists[list_count].terms = gram_terms(dictionary, padded + i, &lists[list_count].count);
+        list_count++;
+    }
+    free(padded);
+    
+    
+    std::sort(lists, lists + list_count, [](const GramList& a, const GramList& b) { return a.count < b.count; });
+    
+    int* candidates = list_count > 0 ? (int*)malloc((lists[0].count + 1) * sizeof(int)) : nullptr;
+    *filtered = list_count > 0;
+    *candidate_count = 0;
+    if (candidates) {
+        if (lists[0].count > 0) memcpy(candidates, lists[0].terms, lists[0].count * sizeof(int));
+        *candidate_count = lists[0].count;
+        for (int l = 1; l < list_count && *candidate_count > 0; l++) {
+            *candidate_count = intersect_in_place(candidates, *candidate_count, lists[l].terms, lists[l].count);
+        }
+    }
+    
+    free(lists);
+    return candidates;
+}
+
+int* expand_wildcard(TermDictionary* dictionary, const char* pattern, int* result_count) {
+    *result_count = 0;
+    if (!dictionary || !pattern || dictionary->term_count == 0) return nullptr;
+    
+    size_t literal = strcspn(pattern, "*");
+    bool prefix_only = pattern[literal] == '*' && pattern[literal + 1 + strspn(pattern + literal + 1, "*")] == '\0';
+    
+    char* prefix = (char*)malloc(literal + 1);
+    if (!prefix) return nullptr;
+    memcpy(prefix, pattern, literal);
+    prefix[literal] = '\0';
+    
+    int first = 0;
+    int last = dictionary->term_count;
+    if (literal > 0 && find_prefix_range(dictionary, prefix, &first, &last) < 0) {
+        free(prefix);
+        return nullptr;
+    }
+    free(prefix);
+    
+    
+    bool filtered = false;
+    int candidate_count = 0;
+    int* candidates = nullptr;
+    if (!prefix_only && first < last) {
+        candidates = gram_candidates(dictionary, pattern, &candidate_count, &filtered);
+        if (!candidates && filtered) return nullptr;
+    }
+    
+    int capacity = filtered ? candidate_count : last - first;
+    int* result = capacity > 0 ? (int*)malloc(capacity * sizeof(int)) : nullptr;
+    DictionaryCursor cursor;
+    if (!result || (!prefix_only && open_dictionary_cursor(dictionary, &cursor) != 0)) {
+        free(result);
+        free(candidates);
+        return nullptr;
+    }
+    
+    int k = 0;
+    for (int i = 0; i < capacity; i++) {
+        int ordinal = filtered ? candidates[i] : first + i;
+        if (ordinal < first || ordinal >= last) continue;
+        if (!prefix_only && !match_wildcard(pattern, seek_term(&cursor, ordinal))) continue;
+        result[k++] = dictionary->entries ? dictionary->entries[ordinal] : ordinal;
+    }
+    
+    if (!prefix_only) free(cursor.term);
+    free(candidates);
+    if (k == 0) {
+        free(result);
+        return nullptr;
+    }
+    
+    *result_count = k;
+    return result;
+}
@@ -1,4 +1,5 @@
 #include "../include/utils.h"
+#include <cstdio>
 #include <cstdlib>
 
 void to_lowercase(char* str) {
@@ -114,4 +115,29 @@ char* strdup(const char* src) {
     
     strcpy(dst, src);
     return dst;
-}
\ No newline at end of file
+}
+
+char** read_lines(const char* filename, int* count) {
+    *count = 0;
+    FILE* file = fopen(filename, "r");
+    if (!file) return nullptr;
+    
+    char** lines = nullptr;
+    int capacity = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        
+        if (*count == capacity) {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            char** grown = (char**)realloc(lines, capacity * sizeof(char*));
+            if (!grown) break;
+            lines = grown;
+        }
+        lines[(*count)++] = strdup(line);
+    }
+    
+    fclose(file);
+    return lines;
+}